@@ -1,64 +1,19 @@
 /// @file   text/unicodeHelper.cpp
 /// @brief  Unicodeのよく使うもろもろ
 #include "unicodeHelper.h"
+#include "unicodeHelperCodec.h"
+#include "unicodeHelperCodepage.h"
+#include "unicodeHelperInternal.h"
 #include "text/unicodeHelperConfig.h"
-
-#if         defined(UNICODE_HELPER_USE_CP932)
-typedef struct {
-    uint16_t                    source;
-    uint16_t                    destination;
-} s2d;
-
-#include "cp932.inc"
-
-//  テーブル内にあるsourceと一致するdestinationを返す
-static uint16_t unicodeHelper_search( s2d const*const   in_table,
-                                      uint32_t const    in_num,
-                                      uint16_t const    in_source,
-                                      uint16_t const    in_unHitDest)
-{
-    s2d const*                  pTableTop( in_table);
-    uint32_t                    numCur( in_num);
-    static uint32_t const       bsGran= 10UL;
-
-    for(;;)
-    {
-        if( numCur< bsGran)
-        {
-            s2d const*const             tableTerm( pTableTop+ bsGran);
-            for( s2d const* pCur= pTableTop; pCur!= tableTerm; pCur++)
-            {
-                uint16_t const              srcCur( pCur->source);
-
-                if( srcCur< in_source)  break;
-                if( srcCur> in_source)  continue;
-
-                return  pCur->destination;
-            }
-            break;
-        } else {
-            uint32_t                    idxMdl( static_cast<uint32_t>( numCur>> 1));
-            s2d const*const             pCur( static_cast<s2d const*>( pTableTop+ idxMdl));
-            uint16_t const              srcCur( pCur->source);
-
-            if( srcCur< in_source)
-            {
-                pTableTop                       = pCur+ 1;
-                numCur                          = static_cast<uint32_t>( numCur- static_cast<uint32_t>( idxMdl+ 1UL));
-            } else if( srcCur> in_source)
-            {
-                numCur                          = idxMdl;
-            } else {
-                return  pCur->destination;
-            }
-        }
-    }
-    return  in_unHitDest;
-}
-#endif  //  defined(UNICODE_HELPER_USE_CP932)
+#include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
 
 //  バッファリングする最大サイズ([byte])
-static int const                sizeBufferedMax= 6; //  現状最大はu32ギリギリ使ったUTF-8の6[byte]
+static int const                sizeBufferedMax= 6; //  一文字の最大はutf-8/utf-16の4[byte]。解析時の先読み分の余裕をもたせる
 
 //  読み込み処理用
 typedef struct {
@@ -67,8 +22,8 @@ typedef struct {
     void*                       _arg;
     //  0:_rStreamはまだ読めるかもしれない -1:既に読めなくなっている
     signed int                  _EOS;
-    //  現在のバッファの先頭にあたるデータ中のインデックス
-    uint32_t                    _indexStream;
+    //  現在のバッファの先頭にあたるデータ中のインデックス(4[GiB]を超える入力もあるので64[bit])
+    uint64_t                    _indexStream;
     //  バッファリングしてあるサイズ([byte])
     uint32_t                    _szBuffered;
     //  バッファの先頭位置
@@ -85,7 +40,7 @@ static readStream*  unicodeHelper_readStreamClear( readStream*const
     io_target->_rStream             = in_rStream;
     io_target->_arg                 = io_arg;
     io_target->_EOS                 = 0;
-    io_target->_indexStream         = 0UL;
+    io_target->_indexStream         = 0ULL;
     io_target->_szBuffered          = 0UL;
     io_target->_indexBuffers        = 0UL;
 
@@ -95,14 +50,20 @@ static readStream*  unicodeHelper_readStreamClear( readStream*const
 //  1[byte]指定のインデックスから読み込み
 static signed int   unicodeHelper_loadByte( uint8_t*const       out_dst,
                                             readStream*const    io_target,
-                                            uint32_t const      in_idx)
+                                            uint64_t const      in_idx)
 {
-    uint32_t const              idxInBuffered= (uint32_t)( in_idx- io_target->_indexStream);
     if( io_target->_indexStream<= in_idx
-        && sizeBufferedMax> idxInBuffered)
+        && (uint64_t)sizeBufferedMax> (uint64_t)( in_idx- io_target->_indexStream))
     {
+        uint32_t const              idxInBuffered= (uint32_t)( in_idx- io_target->_indexStream);
         while( io_target->_szBuffered<= idxInBuffered)
         {
+            if( io_target->_EOS!= 0)
+            {
+                *out_dst                        = 0U;
+                return  0;
+            }
+
             uint32_t const              idxRead= (uint32_t)( (uint32_t)( io_target->_indexBuffers
                                                                          + io_target->_szBuffered)
                                                              % sizeBufferedMax);
@@ -110,11 +71,15 @@ static signed int   unicodeHelper_loadByte( uint8_t*const       out_dst,
             {
                 io_target->_szBuffered          += 1UL;
             } else {
+                io_target->_EOS                 = -1;
+                *out_dst                        = 0U;
                 return  0;
             }
         }
 
-        *out_dst                        = io_target->_buffer[ idxInBuffered];
+        *out_dst                        = io_target->_buffer[ (uint32_t)( (uint32_t)( io_target->_indexBuffers
+                                                                                      + idxInBuffered)
+                                                                          % sizeBufferedMax)];
         return  -1;
     }
 
@@ -122,19 +87,35 @@ static signed int   unicodeHelper_loadByte( uint8_t*const       out_dst,
     return  0;
 }
 
+//  指定のインデックスから指定サイズ([byte])を読み込み
+static signed int   unicodeHelper_loadBytes( uint8_t*const      out_dst,
+                                             readStream*const   io_target,
+                                             uint64_t const     in_idx,
+                                             uint32_t const     in_size)
+{
+    for( uint32_t i= 0UL; i< in_size; i++)
+    {
+        if( unicodeHelper_loadByte( out_dst+ i, io_target, (uint64_t)( in_idx+ i))== 0)
+        {
+            return  0;
+        }
+    }
+    return  -1;
+}
+
 //  指定のインデックスより手前でバッファリングしているものを破棄
 static void unicodeHelper_releaseBuffer( readStream*const   io_target,
-                                         uint32_t const     in_idx)
+                                         uint64_t const     in_idx)
 {
     if( io_target->_indexStream<= in_idx)
     {
-        uint32_t const              szRelease= (uint32_t)( in_idx- io_target->_indexStream);
+        uint64_t const              szRelease= (uint64_t)( in_idx- io_target->_indexStream);
         io_target->_indexStream         = in_idx;
-        if( szRelease< io_target->_szBuffered)
+        if( szRelease< (uint64_t)io_target->_szBuffered)
         {
-            io_target->_szBuffered          = (uint32_t)( io_target->_szBuffered- szRelease);
+            io_target->_szBuffered          = (uint32_t)( io_target->_szBuffered- (uint32_t)szRelease);
             io_target->_indexBuffers        = (uint32_t)( (uint32_t)( io_target->_indexBuffers
-                                                                      + szRelease)
+                                                                      + (uint32_t)szRelease)
                                                           % sizeBufferedMax);
         } else {
             io_target->_szBuffered          = 0UL;
@@ -143,828 +124,2012 @@ static void unicodeHelper_releaseBuffer( readStream*const   io_target,
     }
 }
 
-//  アーキテクチャ依存のエンディアンでuint16_tを読み込む
-static signed int   unicodeHelper_loadWordArch( uint16_t*const      out_dst,
-                                                readStream*const    io_target,
-                                                uint32_t const      in_idx)
+//  utf-8形式で一文字分入力
+static signed int   unicodeHelper_loadUTF8( uint32_t*const      out_unicode,
+                                            readStream*const    io_target,
+                                            uint64_t*const      io_idx)
 {
-    uint16_t                    result;
-
-    if( unicodeHelper_loadByte( (uint8_t*)( (void*)( &result)), io_target, in_idx)!= 0)
+    uint8_t                     buf[ 4];
+    uint64_t const              idxTop= *io_idx;
+    if( unicodeHelper_loadByte( &buf[ 0], io_target, idxTop)!= 0)
     {
-        if( unicodeHelper_loadByte( (uint8_t*)( (uint8_t*)( (void*)( &result))+ 1), io_target, (uint32_t)( in_idx+ 1))!= 0)
+        uint32_t const              sz= unicodeHelper_sizeUTF8( buf[ 0]);
+        if( sz!= 0UL
+            && unicodeHelper_loadBytes( &buf[ 1], io_target, (uint64_t)( idxTop+ 1UL), (uint32_t)( sz- 1UL))!= 0
+            && unicodeHelper_decodeUTF8( out_unicode, &buf[ 0], sz)== (signed int)sz)
         {
-            *out_dst                        = result;
+            *io_idx                         = (uint64_t)( idxTop+ sz);
             return  -1;
         }
     }
-    *out_dst                        = 0;
+
+    *out_unicode                    = 0UL;
+
     return  0;
 }
 
-//  リトルエンディアンでuint16_tを読み込む
-static signed int   unicodeHelper_loadWordLE( uint16_t*const    out_dst,
-                                              readStream*const  io_target,
-                                              uint32_t const    in_idx)
+//  utf-16形式で一文字分入力(バイトオーダーごとに実体化する)
+template< unicodeHelperByteOrder in_order>
+static signed int   unicodeHelper_loadUTF16( uint32_t*const     out_unicode,
+                                             readStream*const   io_target,
+                                             uint64_t*const     io_idx)
 {
-    uint8_t                     uc1st;
-
-    if( unicodeHelper_loadByte( &uc1st, io_target, in_idx)!= 0)
+    uint8_t                     buf[ 4];
+    uint64_t const              idxTop= *io_idx;
+    if( unicodeHelper_loadBytes( &buf[ 0], io_target, idxTop, 2UL)!= 0)
     {
-        uint8_t                     uc2nd;
-        if( unicodeHelper_loadByte( &uc2nd, io_target, (uint32_t)( in_idx+ 1))!= 0)
+        //  上位サロゲートならもう1word必要
+        uint32_t const              sz= ( (uint16_t)( unicodeHelper_peekWord( &buf[ 0], in_order)& 0xfc00U)== 0xd800U)? 4UL: 2UL;
+        if( ( sz== 2UL
+              || unicodeHelper_loadBytes( &buf[ 2], io_target, (uint64_t)( idxTop+ 2UL), 2UL)!= 0)
+            && unicodeHelper_decodeUTF16( out_unicode, &buf[ 0], sz, in_order)== (signed int)sz)
         {
-            *out_dst                        = (uint16_t)( (uint16_t)( ( (uint16_t)uc2nd)<< 8)
-                                                          | (uint16_t)uc1st);
+            *io_idx                         = (uint64_t)( idxTop+ sz);
             return  -1;
         }
     }
+
+    *out_unicode                    = 0UL;
+
     return  0;
 }
 
-//  ビッグエンディアンでuint16_tを読み込む
-static signed int   unicodeHelper_loadWordBE( uint16_t*const    out_dst,
-                                              readStream*const  io_target,
-                                              uint32_t const    in_idx)
+//  表で引くコードページ形式で一文字入力
+template< codepageIndex in_cp>
+static signed int   unicodeHelper_loadCodepage( uint32_t*const      out_unicode,
+                                                readStream*const    io_target,
+                                                uint64_t*const      io_idx)
 {
-    uint8_t                     uc1st;
-
-    if( unicodeHelper_loadByte( &uc1st, io_target, in_idx)!= 0)
+    uint8_t                     buf[ 2];
+    uint64_t const              idxTop= *io_idx;
+    if( unicodeHelper_loadByte( &buf[ 0], io_target, idxTop)!= 0)
     {
-        uint8_t                     uc2nd;
-        if( unicodeHelper_loadByte( &uc2nd, io_target, (uint32_t)( in_idx+ 1))!= 0)
+        uint32_t const              sz= unicodeHelper_sizeCodepage( in_cp, buf[ 0]);
+        if( ( sz== 1UL
+              || unicodeHelper_loadByte( &buf[ 1], io_target, (uint64_t)( idxTop+ 1UL))!= 0)
+            && unicodeHelper_decodeCodepage< in_cp>( out_unicode, &buf[ 0], sz)== (signed int)sz)
         {
-            *out_dst                        = (uint16_t)( (uint16_t)( ( (uint16_t)uc1st)<< 8)
-                                                          | (uint16_t)uc2nd);
+            *io_idx                         = (uint64_t)( idxTop+ sz);
             return  -1;
         }
     }
+
+    *out_unicode                    = 0UL;
     return  0;
 }
 
-//  書き出し処理用
-typedef struct {
-    //  書き出し関数
-    unicodeHelperWriteByteStream _wStream;
-    void*                       _arg;
-} writeStream;
+//  何かのエンコードで指定のreadStreamからunicodeを読み込む関数の型
+typedef signed int(*loadFunc)( uint32_t*const   /*  unicodeの出力先  */,
+                               readStream*const /*  読み込みストリーム */,
+                               uint64_t*const   /*  入力:読み込み開始ofs 出力: 読み込み後のofs */);
 
-//  writeStreamを初期化
-static writeStream* unicodeHelper_writeStreamClear( writeStream*const                   io_target,
-                                                    unicodeHelperWriteByteStream const  in_wStream,
-                                                    void*const                          io_arg)
+//  指定エンコーディングで1文字読み込む関数へのポインタ取得
+static loadFunc unicodeHelperGetLoadFunc( unicodeHelperEncoding const in_target)
 {
-    io_target->_wStream             = in_wStream;
-    io_target->_arg                 = io_arg;
+    switch( in_target)
+    {
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_loadUTF8;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_loadUTF16< unicodeHelperByteOrder_arch>;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_loadUTF16< unicodeHelperByteOrder_le>;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_loadUTF16< unicodeHelperByteOrder_be>;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_loadCodepage< codepage_cp932>;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_loadCodepage< codepage_shiftJIS>;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_loadCodepage< codepage_eucJP>;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_loadCodepage< codepage_gbk>;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_loadCodepage< codepage_big5>;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_loadCodepage< codepage_cp949>;
+    }
 
-    return  io_target;
+    return  (loadFunc)0;
 }
 
-//  1[byte]出力
-static signed int   unicodeHelper_storeByte( writeStream*const  io_target,
-                                             uint8_t const      in_tar)
-{
-    return  io_target->_wStream( in_tar, io_target->_arg);
-}
+//  エンコード解析のための1unicodehelperEncoding単位の調査用ワーク
+typedef struct {
+    signed int                  _isValid;       //  0:このエンコードは候補ではない -1:このエンコードは現在調査中 1:入力の最後まで読めた
+    uint64_t                    _index;         //  次に読み出すreadStreamのオフセット
+    uint32_t                    _maxReadSize;   //  このエンコードの一文字の最大サイズ([byte])
+    loadFunc                    _loadFunc;      //  一文字読み込み用の関数へのポインタ
+} analyze;
 
-//  アーキテクチャ依存のエンディアンでuint16_tを書き込む
-static signed int   unicodeHelper_storeWordArch( writeStream*const  io_target,
-                                                 uint16_t const     in_tar)
+//  analyze構造体を初期化
+static analyze* unicodeHelper_analyzeClear( analyze*const   out_analyze,
+                                            uint32_t const  in_maxReadSize,
+                                            loadFunc const  in_loadFunc)
 {
-    if( unicodeHelper_storeByte( io_target, *(uint8_t const*)( (void const*)&in_tar))!= 0
-        && unicodeHelper_storeByte( io_target, *(uint8_t const*)( (uint8_t const*)( (void const*)&in_tar)+ 1))!= 0)
-    {
-        return  -1;
-    }
-    return  0;
+    out_analyze->_isValid           = -1;
+    out_analyze->_index             = 0ULL;
+    out_analyze->_maxReadSize       = in_maxReadSize;
+    out_analyze->_loadFunc          = in_loadFunc;
+    return  out_analyze;
 }
 
-//  リトルエンディアンでuint16_tを書き込む
-static signed int   unicodeHelper_storeWordLE( writeStream*const    io_target,
-                                               uint16_t const       in_tar)
+//  readStreamのバッファ内に次の文字が読めるだけの未読or格納領域があるか
+static signed int   unicodeHelper_analyzeIsCheckTarget( analyze const*const     in_analyze,
+                                                        readStream const*const  in_rStream)
 {
-    if( unicodeHelper_storeByte( io_target, (uint8_t)( in_tar& 0x00ffU))!= 0
-        && unicodeHelper_storeByte( io_target, (uint8_t)( in_tar>> 8))!= 0)
+    if( in_analyze->_isValid!= 0)
     {
-        return  -1;
+
+        if( in_analyze->_index>= in_rStream->_indexStream)
+        {
+
+            uint64_t const              offsetInBuff= (uint64_t)( in_analyze->_index- in_rStream->_indexStream);
+            if( (uint64_t)( offsetInBuff+ in_analyze->_maxReadSize)<= (uint64_t)sizeBufferedMax)
+            {
+                return  -1;
+            }
+        }
     }
     return  0;
 }
 
-//  ビッグエンディアンでuint16_tを書き込む
-static signed int   unicodeHelper_storeWordBE( writeStream*const    io_target,
-                                               uint16_t const       in_tar)
+//  analyzeの指定エンコーディングで直近の一文字が読めたかどうか
+static signed int   unicodeHelper_analyzeTest( analyze*const    io_analyze,
+                                               readStream*const io_stream)
 {
-    if( unicodeHelper_storeByte( io_target, (uint8_t)( in_tar>> 8))!= 0
-        && unicodeHelper_storeByte( io_target, (uint8_t)( in_tar& 0x00ffU))!= 0)
+    uint32_t                    unicode;
+
+    if( io_analyze->_loadFunc( &unicode, io_stream, &io_analyze->_index)!= 0)
     {
-        return  -1;
+    } else if( io_stream->_EOS!= 0
+               && io_analyze->_index== (uint64_t)( io_stream->_indexStream+ io_stream->_szBuffered))
+    {
+        //  文字の切れ目でちょうど入力が終わった
+        io_analyze->_isValid            = 1;
+    } else {
+        io_analyze->_isValid            = 0;
     }
-    return  0;
+    return  io_analyze->_isValid;
 }
 
+//  analyzeの初期化を列挙するための構造体
+typedef struct {
+    unicodeHelperEncoding       _encoding;      //  エンコード
+    uint32_t                    _maxReadSize;   //  一文字の最大サイズ([byte])
+} encodingAndLoadFunc;
+
+//  unicodeHelperAnalyzeEncoding()中の、エンコード単位のanalyze初期化用パラメータ配列
+static encodingAndLoadFunc const gAnalyzeTargetAry[]= {
+    { unicodeHelperEncoding_utf8,    4UL},
+    { unicodeHelperEncoding_utf16le, 4UL},
+    { unicodeHelperEncoding_utf16be, 4UL},
+    { unicodeHelperEncoding_cp932,   2UL}
+};
 
+//  エンコーディング読解
+UNICODEHELPER_EXTERN_C unicodeHelperEncoding    unicodeHelperAnalyzeEncoding( unicodeHelperReadByteStream const in_rStrm,
+                                                                              void*const                        io_arg)
+{
+    readStream                  rs;
 
+    readStream*const            prs= unicodeHelper_readStreamClear( &rs, in_rStrm, io_arg);
 
+    //  まずここで、BOMのチェックをします
+    uint8_t                     uc1st, uc2nd;
+    if( unicodeHelper_loadByte( &uc1st, prs, 0UL)!= 0
+        && unicodeHelper_loadByte( &uc2nd, prs, 1UL)!= 0)
+    {
+        if( uc1st== 0xffU&& uc2nd== 0xfeU)  return  unicodeHelperEncoding_utf16le;
+        if( uc1st== 0xfeU&& uc2nd== 0xffU)  return  unicodeHelperEncoding_utf16be;
 
-//  utf-8形式で一文字分入力
-static signed int   unicodeHelper_loadUTF8( uint32_t*const      out_unicode,
-                                            readStream*const    io_target,
-                                            uint32_t* const     io_idx)
-{
-    uint8_t                     uc1st;
-    uint32_t const              idxTop= *io_idx;
-    if( unicodeHelper_loadByte( &uc1st, io_target, idxTop)!= 0)
+        if( uc1st== 0xefU&& uc2nd== 0xbbU)
+        {
+            uint8_t                     uc3rd;
+            if( unicodeHelper_loadByte( &uc3rd, prs, 2UL)!= 0
+                && uc3rd== 0xbfU)
+            {
+                return  unicodeHelperEncoding_utf8;
+            }
+        }
+    }
     {
-        if( uc1st< 0x80U)
+        //  エンコーディング単位の解析情報を保存する構造体を初期化
+        analyze                     analyzeAry[ sizeof(gAnalyzeTargetAry)/ sizeof(gAnalyzeTargetAry[0])];
+
+        for( int i= 0; i< sizeof(analyzeAry)/ sizeof(analyzeAry[0]); i++)
         {
-            *out_unicode                    = (uint32_t)uc1st;
-            *io_idx                         = (uint32_t)( idxTop+ 1UL);
-            return  -1;
-        } else if( (uint8_t)( uc1st& 0xc0U)== 0xc0U)
+            unicodeHelper_analyzeClear( &analyzeAry[ i],
+                                        gAnalyzeTargetAry[ i]._maxReadSize,
+                                        unicodeHelperGetLoadFunc( gAnalyzeTargetAry[ i]._encoding));
+        }
+
+
+        //  全エンコーディングについて、読めない文字が出るまで読んでい
+        //  く
+        for(;;)
         {
-            uint8_t                     mask=   0xe0U;
-            uint8_t                     prefix= 0xc0U;
-            uint32_t                    valueLow= 0UL;
-            for( int i= 1; i< 6; i++)
+            unicodeHelperEncoding       lastHitEncoding= unicodeHelperEncoding_unknown;
+            unicodeHelperEncoding       firstFinishedEncoding= unicodeHelperEncoding_unknown;
+            int                         validEntryNum= 0;
+            int                         finishedEntryNum= 0;
+            signed int                  idxCurMinIsValid= 0;
+            uint64_t                    idxCurMin= 0ULL;
+            for( int i= 0; i< sizeof(analyzeAry)/ sizeof(analyzeAry[0]); i++)
             {
-                uint8_t                     ucCur;
-                if( unicodeHelper_loadByte( &ucCur, io_target, (uint32_t)( idxTop+ i))!= 0)
+                analyze*const               analyzeCur= &analyzeAry[ i];
+                //  既に除外されているエンコードは省略
+                if( analyzeCur->_isValid== 0)   continue;
+
+                //  最後まで読めたエンコードは、gAnalyzeTargetAryの並び順で優先
+                if( analyzeCur->_isValid> 0)
                 {
-                    break;
+                    if( finishedEntryNum== 0)   firstFinishedEncoding= gAnalyzeTargetAry[ i]._encoding;
+                    finishedEntryNum++;
+                    validEntryNum++;
+                    lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
+                    continue;
                 }
-                if( (uint8_t)( ucCur& 0x80U)== 0)
+
+                //  prsの読み取り範囲の外に次の読み込み位置があるエンコー
+                //  ドは保留
+                if( unicodeHelper_analyzeIsCheckTarget( analyzeCur, prs)== 0)
                 {
-                    break;
+                    if( idxCurMinIsValid== 0|| idxCurMin> analyzeCur->_index)
+                    {
+                        idxCurMinIsValid                = -1;
+                        idxCurMin                       = analyzeCur->_index;
+                    }
+                    validEntryNum++;
+                    lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
+                    continue;
                 }
-                valueLow                        = (uint32_t)( (uint32_t)( valueLow<< 6)+ (uint32_t)( ucCur& 0x6fU));
-                if( (uint8_t)( uc1st& mask)== prefix)
+
+                //  prsからunicodeを読めるかテスト
+                if( unicodeHelper_analyzeTest( analyzeCur, prs)!= 0)
                 {
-                    *out_unicode                    = (uint32_t)( (uint32_t)( (uint32_t)( ucCur
-                                                                                          & (uint8_t)( ~mask))
-                                                                              << (int)( i* 6))
-                                                                  + valueLow);
-                    *io_idx                         = (uint32_t)( idxTop+ i);
-                    return  -1;
+                    if( analyzeCur->_isValid> 0)
+                    {
+                        if( finishedEntryNum== 0)   firstFinishedEncoding= gAnalyzeTargetAry[ i]._encoding;
+                        finishedEntryNum++;
+                        validEntryNum++;
+                        lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
+                        continue;
+                    }
+                    if( idxCurMinIsValid== 0|| idxCurMin> analyzeCur->_index)
+                    {
+                        idxCurMinIsValid                = -1;
+                        idxCurMin                       = analyzeCur->_index;
+                    }
+                    validEntryNum++;
+                    lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
+                } else {
+                    //  候補外
+                    analyzeCur->_isValid            = 0;
                 }
-                mask                            = (uint8_t)( (uint8_t)( mask>>   1)| 0x80U);
-                prefix                          = (uint8_t)( (uint8_t)( prefix>> 1)| 0x80U);
             }
+            if( validEntryNum<= 1)
+            {
+                //  こいつが候補です
+                return  lastHitEncoding;
+            }
+            if( finishedEntryNum== validEntryNum)
+            {
+                //  どれでも最後まで読めた
+                return  firstFinishedEncoding;
+            }
+            unicodeHelper_releaseBuffer( prs, idxCurMin);
         }
     }
+    return  unicodeHelperEncoding_unknown;
+}
 
-    *out_unicode                    = 0UL;
 
-    return  0;
-}
+//  メモリ上で一文字デコードする関数の型
+typedef signed int(*decodeFunc)( uint32_t*const         /*  unicodeの出力先  */,
+                                 uint8_t const*const    /*  入力の先頭 */,
+                                 size_t const           /*  入力のサイズ([byte]) */);
+
+//  メモリ上に一文字エンコードする関数の型
+typedef signed int(*encodeFunc)( uint8_t*const          /*  出力先(4[byte]以上) */,
+                                 uint32_t const         /*  unicode */);
 
-//  utf-8形式で指定のunicode値を出力
-static signed int   unicodeHelper_storeUTF8( writeStream*const  io_target,
-                                             uint32_t const     in_unicode)
+//  一文字あたりの最大エンコードサイズ([byte])
+static size_t const             sizeEncodedMax= 4;
+
+//  メモリ上でin_decodeからin_encodeへ変換する
+template< decodeFunc in_decode, encodeFunc in_encode>
+static convertStop  unicodeHelper_convertBuffer( uint8_t*const         out_dst,
+                                                 size_t const           in_dstCap,
+                                                 size_t*const           io_written,
+                                                 uint8_t const*const    in_src,
+                                                 size_t const           in_srcLen,
+                                                 size_t*const           io_consumed)
 {
-    if( in_unicode< 0x00000080UL)
-    {
-        return  unicodeHelper_storeByte( io_target, (uint8_t)( in_unicode& 0x0000007fUL));
-    } else if( in_unicode< 0x00000800UL)
-    {
-        uint8_t const               uc1st= (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>>  6)& 0x0000001fUL)| 0xc0U);
-        uint8_t const               uc2nd= (uint8_t)( (uint32_t)( in_unicode& 0x0000003fUL)| 0x80U);
-        if( unicodeHelper_storeByte( io_target, uc1st)!= 0
-            && unicodeHelper_storeByte( io_target, uc2nd)!= 0)
-        {
-            return  -1;
-        }
-    } else if( in_unicode< 0x00010000UL)
-    {
-        uint8_t const               uc1st= (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>> 12)& 0x0000000fUL)| 0xe0U);
-        uint8_t const               uc2nd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 6)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc3rd= (uint8_t)( (uint32_t)( in_unicode& 0x0000003fUL)| 0x80U);
-        if( unicodeHelper_storeByte( io_target, uc1st)!= 0
-            && unicodeHelper_storeByte( io_target, uc2nd)!= 0
-            && unicodeHelper_storeByte( io_target, uc3rd)!= 0)
-        {
-            return  -1;
-        }
-    } else if( in_unicode< 0x00200000UL)
-    {
-        uint8_t const               uc1st= (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>>  18)& 0x00000007UL)| 0xf0U);
-        uint8_t const               uc2nd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 12)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc3rd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>>  6)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc4th= (uint8_t)( (uint32_t)( in_unicode& 0x0000003fUL)| 0x80U);
-        if( unicodeHelper_storeByte( io_target, uc1st)!= 0
-            && unicodeHelper_storeByte( io_target, uc2nd)!= 0
-            && unicodeHelper_storeByte( io_target, uc3rd)!= 0
-            && unicodeHelper_storeByte( io_target, uc4th)!= 0)
-        {
-            return  -1;
-        }
-    } else if( in_unicode< 0x04000000UL)
+    size_t                      idxDst= *io_written;
+    size_t                      idxSrc= *io_consumed;
+    convertStop                 result= convertStop_complete;
+
+    while( idxSrc< in_srcLen)
     {
-        uint8_t const               uc1st= (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>>  24)& 0x00000003UL)| 0xf8U);
-        uint8_t const               uc2nd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 18)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc3rd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 12)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc4th= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>>  6)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc5th= (uint8_t)( (uint32_t)( in_unicode& 0x0000003fUL)| 0x80U);
-        if( unicodeHelper_storeByte( io_target, uc1st)!= 0
-            && unicodeHelper_storeByte( io_target, uc2nd)!= 0
-            && unicodeHelper_storeByte( io_target, uc3rd)!= 0
-            && unicodeHelper_storeByte( io_target, uc4th)!= 0
-            && unicodeHelper_storeByte( io_target, uc5th)!= 0)
+        uint32_t                    unicode;
+        signed int const            szIn= in_decode( &unicode, in_src+ idxSrc, (size_t)( in_srcLen- idxSrc));
+        if( szIn<= 0)
         {
-            return  -1;
+            result                          = ( szIn== 0)? convertStop_shortInput: convertStop_invalid;
+            break;
         }
-    } else if( in_unicode< 0x7fffffffUL)
-    {
-        uint8_t const               uc1st= (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>>  30)& 0x00000001UL)| 0xfcU);
-        uint8_t const               uc2nd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 24)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc3rd= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 18)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc4th= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>> 12)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc5th= (uint8_t)( (uint32_t)( (uint32_t)( in_unicode>>  6)& 0x0000003fUL)| 0x80U);
-        uint8_t const               uc6th= (uint8_t)( (uint32_t)( in_unicode& 0x0000003fUL)| 0x80U);
-        if( unicodeHelper_storeByte( io_target, uc1st)!= 0
-            && unicodeHelper_storeByte( io_target, uc2nd)!= 0
-            && unicodeHelper_storeByte( io_target, uc3rd)!= 0
-            && unicodeHelper_storeByte( io_target, uc4th)!= 0
-            && unicodeHelper_storeByte( io_target, uc5th)!= 0
-            && unicodeHelper_storeByte( io_target, uc6th)!= 0)
+
+        if( (size_t)( in_dstCap- idxDst)>= sizeEncodedMax)
         {
-            return  -1;
+            //  出力先に余裕があるので直接書く
+            signed int const            szOut= in_encode( out_dst+ idxDst, unicode);
+            if( szOut== 0)
+            {
+                result                          = convertStop_invalid;
+                break;
+            }
+            idxDst                          += (size_t)szOut;
+        } else {
+            //  出力先の終端付近は一旦ためてから収まるか確認
+            uint8_t                     buf[ sizeEncodedMax];
+            signed int const            szOut= in_encode( &buf[ 0], unicode);
+            if( szOut== 0)
+            {
+                result                          = convertStop_invalid;
+                break;
+            }
+            if( (size_t)( in_dstCap- idxDst)< (size_t)szOut)
+            {
+                result                          = convertStop_shortOutput;
+                break;
+            }
+            memcpy( out_dst+ idxDst, &buf[ 0], (size_t)szOut);
+            idxDst                          += (size_t)szOut;
         }
+        idxSrc                          += (size_t)szIn;
     }
 
-    return  0;
+    *io_written                     = idxDst;
+    *io_consumed                    = idxSrc;
+    return  result;
 }
 
-//  utf-16コードの値
-typedef struct {
-    uint16_t                    uw1st;
-    uint16_t                    uw2nd;
-} utf16Pair;
-
-//  サロゲートペアをunicode値に変更
-static uint32_t unicodeHelper_FromSurrogatePair( utf16Pair const*const in_src)
+//  入力側のデコード関数を決めた上で、出力エンコーディングごとの変換関数へのポインタ取得
+template< decodeFunc in_decode>
+static convertBufferFunc    unicodeHelperGetConvertBufferFuncDst( unicodeHelperEncoding const in_ecDst)
 {
-    return  (uint32_t)( (uint32_t)( (uint32_t)( (uint16_t)( in_src->uw1st& 0x03ffU)+ 0x0040U)<< 10)
-                        | (uint32_t)( in_src->uw2nd& 0x03ffU));
+    switch( in_ecDst)
+    {
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeUTF8>;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeUTF16Arch>;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeUTF16LE>;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeUTF16BE>;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_cp932> >;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_shiftJIS> >;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_eucJP> >;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_gbk> >;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_big5> >;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_convertBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_cp949> >;
+    default:                                    break;
+    }
+
+    return  (convertBufferFunc)0;
 }
 
-//  unicode値をサロゲートペアに変更
-static signed int   unicodeHelper_ToSurrogatePair( utf16Pair*const  io_dst,
-                                                   uint32_t const   in_unicode)
+//  指定エンコーディング間でメモリ上の変換をする関数へのポインタ取得
+static convertBufferFunc    unicodeHelperGetConvertBufferFunc( unicodeHelperEncoding const  in_ecDst,
+                                                               unicodeHelperEncoding const  in_ecSrc)
 {
-    if( in_unicode< 0x00010000UL)
-    {
-        io_dst->uw1st                   = (uint16_t)in_unicode;
-        io_dst->uw2nd                   = 0UL;
-        return  -1;
-    } else if( in_unicode>= 0x00010000UL&& in_unicode<= 0x0010ffffUL)
+    //  まとめて処理する専用の関数があればそちらを使う
+    convertBufferFunc const     pSimd= unicodeHelper_simdGetConvertBufferFunc( in_ecDst, in_ecSrc);
+    if( pSimd!= (convertBufferFunc)0)   return  pSimd;
+
+    switch( in_ecSrc)
     {
-        io_dst->uw1st                   = (uint16_t)( (uint16_t)( (uint32_t)( (uint32_t)( in_unicode
-                                                                                          - 0x0010000UL)
-                                                                              & 0x000ffc00)>> 10)
-                                                      | 0xd800U);
-        io_dst->uw2nd                   = (uint16_t)( (uint16_t)( in_unicode& 0x000003ffUL)| 0xdc00U);
-        return  -1;
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeUTF8>( in_ecDst);
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeUTF16Arch>( in_ecDst);
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeUTF16LE>( in_ecDst);
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeUTF16BE>( in_ecDst);
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_cp932> >( in_ecDst);
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_shiftJIS> >( in_ecDst);
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_eucJP> >( in_ecDst);
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_gbk> >( in_ecDst);
+    case    unicodeHelperEncoding_big5:         return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_big5> >( in_ecDst);
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelperGetConvertBufferFuncDst< unicodeHelper_decodeCodepage< codepage_cp949> >( in_ecDst);
+    default:                                    break;
     }
-    return  0;
-}
 
+    return  (convertBufferFunc)0;
+}
 
-//  utf-16arch形式で一文字分入力
-static signed int   unicodeHelper_loadUTF16Arch( uint32_t*const     out_unicode,
-                                                 readStream*const   io_target,
-                                                 uint32_t*const     io_idx)
+//  メモリ上でin_decodeからin_encodeへ変換した場合の出力サイズを一文字ずつ数える
+template< decodeFunc in_decode, encodeFunc in_encode>
+static size_t   unicodeHelper_measureBuffer( size_t*const           out_size,
+                                             uint8_t const*const    in_src,
+                                             size_t const           in_srcLen)
 {
-    utf16Pair                   utf16;
-    uint32_t const              idxTop= *io_idx;
-    if( unicodeHelper_loadWordArch( &utf16.uw1st, io_target, idxTop)!= 0)
+    size_t                      size= 0UL;
+    size_t                      idx= 0UL;
+    while( idx< in_srcLen)
     {
-        if( (uint16_t)( utf16.uw1st& 0xfc00)!= 0xd800U)
-        {
-            *out_unicode                    = (uint32_t)utf16.uw1st;
-            return  -1;
-        } else {
-            if( unicodeHelper_loadWordArch( &utf16.uw2nd, io_target, (uint32_t)( idxTop+ 1UL))!= 0)
-            {
-                if( (uint16_t)( utf16.uw2nd& 0xfc00)!= 0xdc00U)
-                {
-                    *out_unicode                    = unicodeHelper_FromSurrogatePair( &utf16);
-                    return  -1;
-                }
-            }
-        }
+        uint32_t                    unicode;
+        signed int const            szIn= in_decode( &unicode, in_src+ idx, (size_t)( in_srcLen- idx));
+        if( szIn<= 0)   break;
+
+        uint8_t                     buf[ sizeEncodedMax];
+        signed int const            szOut= in_encode( &buf[ 0], unicode);
+        if( szOut== 0)  break;
+
+        size                            += (size_t)szOut;
+        idx                             += (size_t)szIn;
     }
-    return  0;
+
+    *out_size                       = size;
+    return  idx;
 }
 
-//  utf-16arch形式で指定のunicode値を出力
-static signed int   unicodeHelper_storeUTF16Arch( writeStream*const io_target,
-                                                  uint32_t const    in_unicode)
+//  入力側のデコード関数を決めた上で、出力エンコーディングごとの出力サイズを数える関数へのポインタ取得
+template< decodeFunc in_decode>
+static measureFunc  unicodeHelperGetMeasureFuncDst( unicodeHelperEncoding const in_ecDst)
 {
-    utf16Pair                   utf16;
-    if( unicodeHelper_ToSurrogatePair( &utf16, in_unicode)!= 0)
+    switch( in_ecDst)
     {
-        if( unicodeHelper_storeWordArch( io_target, utf16.uw1st)!= 0)
-        {
-            if( utf16.uw2nd== 0U
-                || unicodeHelper_storeWordArch( io_target, utf16.uw2nd)!= 0)
-            {
-                return  -1;
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeUTF8>;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeUTF16Arch>;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeUTF16LE>;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeUTF16BE>;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_cp932> >;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_shiftJIS> >;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_eucJP> >;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_gbk> >;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_big5> >;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_measureBuffer< in_decode, unicodeHelper_encodeCodepage< codepage_cp949> >;
+    default:                                    break;
     }
 
-    return  0;
+    return  (measureFunc)0;
 }
 
-//  utf-16le形式で一文字分入力
-static signed int   unicodeHelper_loadUTF16LE( uint32_t*const   out_unicode,
-                                               readStream*const io_target,
-                                               uint32_t*const   io_idx)
+//  指定エンコーディング間の出力サイズを数える関数へのポインタ取得
+static measureFunc  unicodeHelperGetMeasureFunc( unicodeHelperEncoding const    in_ecDst,
+                                                 unicodeHelperEncoding const    in_ecSrc)
 {
-    utf16Pair                   utf16;
-    uint32_t const              idxTop= *io_idx;
-    if( unicodeHelper_loadWordLE( &utf16.uw1st, io_target, idxTop)!= 0)
+    //  まとめて数える専用の関数があればそちらを使う
+    measureFunc const           pSimd= unicodeHelper_simdGetMeasureFunc( in_ecDst, in_ecSrc);
+    if( pSimd!= (measureFunc)0) return  pSimd;
+
+    switch( in_ecSrc)
     {
-        if( (uint16_t)( utf16.uw1st& 0xfc00)!= 0xd800U)
-        {
-            *out_unicode                    = (uint32_t)utf16.uw1st;
-            return  -1;
-        } else {
-            if( unicodeHelper_loadWordLE( &utf16.uw2nd, io_target, (uint32_t)( idxTop+ 1UL))!= 0)
-            {
-                if( (uint16_t)( utf16.uw2nd& 0xfc00)!= 0xdc00U)
-                {
-                    *out_unicode                    = unicodeHelper_FromSurrogatePair( &utf16);
-                    return  -1;
-                }
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeUTF8>( in_ecDst);
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeUTF16Arch>( in_ecDst);
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeUTF16LE>( in_ecDst);
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeUTF16BE>( in_ecDst);
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_cp932> >( in_ecDst);
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_shiftJIS> >( in_ecDst);
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_eucJP> >( in_ecDst);
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_gbk> >( in_ecDst);
+    case    unicodeHelperEncoding_big5:         return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_big5> >( in_ecDst);
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelperGetMeasureFuncDst< unicodeHelper_decodeCodepage< codepage_cp949> >( in_ecDst);
+    default:                                    break;
     }
-    return  0;
+
+    return  (measureFunc)0;
 }
 
-//  utf-16le形式で指定のunicode値を出力
-static signed int   unicodeHelper_storeUTF16LE( writeStream*const   io_target,
-                                                uint32_t const      in_unicode)
+//  指定エンコーディングで一文字デコードする関数へのポインタ取得
+static decodeFunc   unicodeHelperGetDecodeFunc( unicodeHelperEncoding const in_target)
 {
-    utf16Pair                   utf16;
-    if( unicodeHelper_ToSurrogatePair( &utf16, in_unicode)!= 0)
+    switch( in_target)
     {
-        if( unicodeHelper_storeWordLE( io_target, utf16.uw1st)!= 0)
-        {
-            if( utf16.uw2nd== 0U
-                || unicodeHelper_storeWordLE( io_target, utf16.uw2nd)!= 0)
-            {
-                return  -1;
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_decodeUTF8;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_decodeUTF16Arch;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_decodeUTF16LE;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_decodeUTF16BE;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_decodeCodepage< codepage_cp932>;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_decodeCodepage< codepage_shiftJIS>;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_decodeCodepage< codepage_eucJP>;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_decodeCodepage< codepage_gbk>;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_decodeCodepage< codepage_big5>;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_decodeCodepage< codepage_cp949>;
+    default:                                    break;
     }
 
-    return  0;
+    return  (decodeFunc)0;
 }
 
-//  utf-16be形式で一文字分入力
-static signed int   unicodeHelper_loadUTF16BE( uint32_t*const   out_unicode,
-                                               readStream*const io_target,
-                                               uint32_t*const   io_idx)
+//  指定エンコーディングで一文字エンコードする関数へのポインタ取得
+static encodeFunc   unicodeHelperGetEncodeFunc( unicodeHelperEncoding const in_target)
 {
-    utf16Pair                   utf16;
-    uint32_t const              idxTop= *io_idx;
-    if( unicodeHelper_loadWordBE( &utf16.uw1st, io_target, idxTop)!= 0)
+    switch( in_target)
     {
-        if( (uint16_t)( utf16.uw1st& 0xfc00)!= 0xd800U)
-        {
-            *out_unicode                    = (uint32_t)utf16.uw1st;
-            return  -1;
-        } else {
-            if( unicodeHelper_loadWordBE( &utf16.uw2nd, io_target, (uint32_t)( idxTop+ 1UL))!= 0)
-            {
-                if( (uint16_t)( utf16.uw2nd& 0xfc00)!= 0xdc00U)
-                {
-                    *out_unicode                    = unicodeHelper_FromSurrogatePair( &utf16);
-                    return  -1;
-                }
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_encodeUTF8;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_encodeUTF16Arch;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_encodeUTF16LE;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_encodeUTF16BE;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_encodeCodepage< codepage_cp932>;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_encodeCodepage< codepage_shiftJIS>;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_encodeCodepage< codepage_eucJP>;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_encodeCodepage< codepage_gbk>;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_encodeCodepage< codepage_big5>;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_encodeCodepage< codepage_cp949>;
+    default:                                    break;
     }
-    return  0;
+
+    return  (encodeFunc)0;
 }
 
-//  utf-16be形式で指定のunicode値を出力
-static signed int   unicodeHelper_storeUTF16BE( writeStream*const   io_target,
-                                                uint32_t const      in_unicode)
+//  メモリ上の入力で、指定の位置以降の最初の文字の切れ目を探す関数の型
+//  (入力が正しければ切れ目になる位置を返す。正しくなければ分けた後の変換で失敗するので何を返してもよい)
+typedef size_t(*boundaryFunc)( uint8_t const*const  /*  入力元 */,
+                               size_t const         /*  入力元のサイズ([byte]) */,
+                               size_t const         /*  文字の切れ目と分かっている位置 */,
+                               size_t const         /*  探し始める位置 */);
+
+//  utf-8の文字の切れ目を探す(継続byteを飛ばす)
+static size_t   unicodeHelper_boundaryUTF8( uint8_t const*const in_src,
+                                            size_t const        in_srcLen,
+                                            size_t const        /*  in_known */,
+                                            size_t const        in_idx)
 {
-    utf16Pair                   utf16;
-    if( unicodeHelper_ToSurrogatePair( &utf16, in_unicode)!= 0)
+    size_t                      idx= in_idx;
+    while( idx< in_srcLen
+           && (size_t)( idx- in_idx)< 3UL
+           && (uint8_t)( in_src[ idx]& 0xc0U)== 0x80U)
     {
-        if( unicodeHelper_storeWordBE( io_target, utf16.uw1st)!= 0)
-        {
-            if( utf16.uw2nd== 0U
-                || unicodeHelper_storeWordBE( io_target, utf16.uw2nd)!= 0)
-            {
-                return  -1;
-            }
-        }
+        idx++;
     }
+    return  idx;
+}
 
-    return  0;
+//  utf-16の文字の切れ目を探す(wordの境界に合わせ、下位サロゲートなら飛ばす)
+template< unicodeHelperByteOrder in_order>
+static size_t   unicodeHelper_boundaryUTF16( uint8_t const*const    in_src,
+                                             size_t const           in_srcLen,
+                                             size_t const           in_known,
+                                             size_t const           in_idx)
+{
+    size_t                      idx= (size_t)( in_idx- ( (size_t)( in_idx- in_known)& 1UL));
+    if( (size_t)( idx+ 2UL)<= in_srcLen
+        && (uint16_t)( unicodeHelper_peekWord( in_src+ idx, in_order)& 0xfc00U)== 0xdc00U)
+    {
+        idx                             += 2UL;
+    }
+    return  ( idx< in_srcLen)? idx: in_srcLen;
 }
 
-#if         defined(UNICODE_HELPER_USE_CP932)
+//  表で引くコードページの文字の切れ目を探す
+//  直前に続く「先頭byteになりうるbyte」の数を数え、奇数なら直前のbyteが先頭byteなので一つ進める
+//  (先頭byteになりえないbyteの直後は必ず文字の切れ目なので、そこから二つずつ組になる)
+template< codepageIndex in_cp>
+static size_t   unicodeHelper_boundaryCodepage( uint8_t const*const in_src,
+                                                size_t const        in_srcLen,
+                                                size_t const        in_known,
+                                                size_t const        in_idx)
+{
+    uint8_t const*const         pTrail= unicodeHelper_codepageTrail( in_cp);
+    size_t                      idx= in_idx;
+    while( idx> in_known&& pTrail[ in_src[ idx- 1UL]]!= 0U)    idx--;
 
-//  cp932形式で一文字入力
-static signed int   unicodeHelper_loadCP932( uint32_t*const     out_unicode,
-                                             readStream*const   io_target,
-                                             uint32_t*const     io_idx)
+    size_t const                result= ( ( (size_t)( in_idx- idx)& 1UL)!= 0UL)? (size_t)( in_idx+ 1UL): in_idx;
+    return  ( result< in_srcLen)? result: in_srcLen;
+}
+
+//  指定エンコーディングの文字の切れ目を探す関数へのポインタ取得
+static boundaryFunc unicodeHelperGetBoundaryFunc( unicodeHelperEncoding const in_target)
 {
-    uint8_t                     uc1st;
-    uint32_t const              idxTop= *io_idx;
-    if( unicodeHelper_loadByte( &uc1st, io_target, idxTop)!= 0)
+    switch( in_target)
     {
-        if( uc1st< 0x80U)
-        {
-            if( uc1st!= 0U)
-            {
-                uint16_t const              unicode= unicodeHelper_search( &cp932_c2uc[ 0],
-                                                                           (uint32_t)( sizeof(cp932_c2uc)/ sizeof(cp932_c2uc[0])),
-                                                                           (uint16_t)uc1st,
-                                                                           0x0000U);
-                if( unicode!= 0U)
-                {
-                    *out_unicode                    = (uint32_t)unicode;
-                    *io_idx                         = (uint32_t)( idxTop+ 1);
-                    return  -1;
-                }
-            } else {
-                *out_unicode                    = 0UL;
-                *io_idx                         = (uint32_t)( idxTop+ 1);
-                return  -1;
-            }
-        } else {
-            uint8_t                     uc2nd;
-            if( unicodeHelper_loadByte( &uc2nd, io_target, (uint32_t)( idxTop+ 1UL))!= 0)
-            {
-                uint16_t const              cp932= (uint16_t)( (uint16_t)( ( (uint16_t)uc1st)<< 8)
-                                                               | (uint16_t)uc2nd);
-                uint16_t const              unicode= unicodeHelper_search( &cp932_c2uc[ 0],
-                                                                           (uint32_t)( sizeof(cp932_c2uc)/ sizeof(cp932_c2uc[0])),
-                                                                           cp932,
-                                                                           0x0000U);
-                if( unicode!= 0U)
-                {
-                    *out_unicode                    = (uint32_t)unicode;
-                    *io_idx                         = (uint32_t)( idxTop+ 1);
-                    return  -1;
-                }
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_boundaryUTF8;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_boundaryUTF16< unicodeHelperByteOrder_arch>;
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_boundaryUTF16< unicodeHelperByteOrder_le>;
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_boundaryUTF16< unicodeHelperByteOrder_be>;
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_boundaryCodepage< codepage_cp932>;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_boundaryCodepage< codepage_shiftJIS>;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_boundaryCodepage< codepage_eucJP>;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_boundaryCodepage< codepage_gbk>;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_boundaryCodepage< codepage_big5>;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_boundaryCodepage< codepage_cp949>;
+    default:                                    break;
     }
 
-    *out_unicode                    = 0UL;
-    return  0;
+    return  (boundaryFunc)0;
 }
 
-//  cp932形式で一文字出力
-static signed int   unicodeHelper_storeCP932( writeStream*const io_target,
-                                              uint32_t const    in_unicode)
+//  エンコーディングの種類(出力サイズの上限を求める表の添字)
+static size_t   unicodeHelper_boundKind( unicodeHelperEncoding const in_encoding)
 {
-    if( in_unicode< 0x00010000UL)
+    switch( in_encoding)
     {
-        if( in_unicode!= 0UL)
-        {
-            uint16_t const              cp932= unicodeHelper_search( &cp932_uc2c[ 0],
-                                                                     (uint32_t)( sizeof(cp932_uc2c)/ sizeof(cp932_uc2c[0])),
-                                                                     (uint16_t)( in_unicode& 0x0000ffffUL),
-                                                                     0x0000U);
-            if( cp932!= 0U)
-            {
-                if( cp932& 0xff00U)
-                {
-                    if( unicodeHelper_storeByte( io_target, (uint8_t)( cp932>> 8))!= 0
-                        && unicodeHelper_storeByte( io_target, (uint8_t)( cp932& 0x00ffU))!= 0)
-                    {
-                        return  -1;
-                    }
-                } else {
-                    if( unicodeHelper_storeByte( io_target, (uint8_t)( cp932& 0x00ffU))!= 0)
-                    {
-                        return  -1;
-                    }
-                }
-            }
-        } else {
-            if( unicodeHelper_storeByte( io_target, 0U)!= 0)
-            {
-                return  -1;
-            }
-        }
+    case    unicodeHelperEncoding_utf8:         return  0;
+    case    unicodeHelperEncoding_utf16arch:
+    case    unicodeHelperEncoding_utf16le:
+    case    unicodeHelperEncoding_utf16be:      return  1;
+    case    unicodeHelperEncoding_cp932:
+    case    unicodeHelperEncoding_shiftJIS:
+    case    unicodeHelperEncoding_eucJP:
+    case    unicodeHelperEncoding_gbk:
+    case    unicodeHelperEncoding_big5:
+    case    unicodeHelperEncoding_cp949:        return  2;
+    default:                                    break;
     }
-
-    return  0;
+    return  3;
 }
-#else   //  defined(UNICODE_HELPER_USE_CP932)
 
-//  cp932をサポートしない場合の一文字読み込み用ダミー関数
-static signed int   unicodeHelper_loadCP932( uint32_t*const,
-                                             readStream*const,
-                                             uint32_t*const)
+//  入力1[byte]あたりの出力の最大[byte]の2倍(変換できない組み合わせなら0)
+static size_t   unicodeHelper_boundHalfRatio( unicodeHelperEncoding const   in_ecDst,
+                                              unicodeHelperEncoding const   in_ecSrc)
 {
-    return  0;
+    //  [出力の種類][入力の種類]
+    //  utf-8へはutf-16の2[byte]が3[byte]に、コードページの1[byte]の半角カナなどが3[byte]になる
+    //  utf-16へはutf-8やコードページの1[byte]が2[byte]になる
+    //  コードページへはcp932の1[byte]の半角カナがeuc-jpの2[byte]になる
+    static uint8_t const        halfRatio[ 3][ 3]= {
+        { 2, 3, 6},
+        { 4, 2, 4},
+        { 2, 2, 4},
+    };
+    size_t const                kindDst= unicodeHelper_boundKind( in_ecDst);
+    size_t const                kindSrc= unicodeHelper_boundKind( in_ecSrc);
+    if( kindDst>= 3|| kindSrc>= 3)  return  0;
+
+    return  halfRatio[ kindDst][ kindSrc];
 }
 
-//  cp932をサポートしない場合の一文字書き出し用ダミー関数
-static signed int   unicodeHelper_storeCP932( writeStream*const, uint32_t const)
+//  変換器の中身(作った後は変えない)
+struct unicodeHelperConverter_ {
+    //  エンコーディングの組み合わせごとの変換関数
+    convertBufferFunc           _convert;
+    //  入力のBOMを調べるためのデコード関数
+    decodeFunc                  _decode;
+    //  入力を分けて並列に変換する際に文字の切れ目を探す関数
+    boundaryFunc                _boundary;
+    //  出力サイズを数える関数
+    measureFunc                 _measure;
+    //  出力するBOMのサイズ([byte])。0なら出力しない
+    size_t                      _szBOM;
+    //  出力するBOM
+    uint8_t                     _bom[ sizeEncodedMax];
+    //  入力1[byte]あたりの出力の最大[byte]の2倍(unicodeHelperBoundSize()と同じ)
+    size_t                      _boundHalfRatio;
+};
+
+//  変換器の中身を埋める
+//  変換できない組み合わせか、出力先エンコードにBOMが無いのにBOMの出力を指定していれば0を返す
+static signed int   unicodeHelper_converterSetup( unicodeHelperConverter*const  out_converter,
+                                                  unicodeHelperEncoding const   in_ecDst,
+                                                  unicodeHelperEncoding const   in_ecSrc,
+                                                  uint32_t const                in_flags)
 {
-    return  0;
+    convertBufferFunc const     pConvert= unicodeHelperGetConvertBufferFunc( in_ecDst, in_ecSrc);
+    if( pConvert== (convertBufferFunc)0)    return  0;
+
+    out_converter->_convert         = pConvert;
+    out_converter->_decode          = unicodeHelperGetDecodeFunc( in_ecSrc);
+    out_converter->_boundary        = unicodeHelperGetBoundaryFunc( in_ecSrc);
+    out_converter->_measure         = unicodeHelperGetMeasureFunc( in_ecDst, in_ecSrc);
+    out_converter->_boundHalfRatio  = unicodeHelper_boundHalfRatio( in_ecDst, in_ecSrc);
+    out_converter->_szBOM           = 0UL;
+    if( (uint32_t)( in_flags& unicodeHelperConvertFlag_withBOM)!= 0UL)
+    {
+        signed int const            szOut= unicodeHelperGetEncodeFunc( in_ecDst)( &out_converter->_bom[ 0], 0x0000feffUL);
+        if( szOut== 0)  return  0;
+        out_converter->_szBOM           = (size_t)szOut;
+    }
+    return  -1;
 }
 
-#endif  //  defined(UNICODE_HELPER_USE_CP932)
+//  変換器でメモリ上のデータを変換
+static signed int   unicodeHelper_converterRun( unicodeHelperConverter const*const  in_converter,
+                                                uint8_t*const                       out_dst,
+                                                size_t const                        in_dstCap,
+                                                size_t*const                        out_written,
+                                                uint8_t const*const                 in_src,
+                                                size_t const                        in_srcLen,
+                                                size_t*const                        out_consumed)
+{
+    size_t                      written= 0;
+    size_t                      consumed= 0;
+    signed int                  result= 0;
 
-//  何かのエンコードで指定のreadStreamからunicodeを読み込む関数の型
-typedef signed int(*loadFunc)( uint32_t*const   /*  unicodeの出力先  */,
-                               readStream*const /*  読み込みストリーム */,
-                               uint32_t*const   /*  入力:読み込み開始ofs 出力: 読み込み後のofs */);
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szBOM= in_converter->_decode( &unicode, in_src, in_srcLen);
+    if( szBOM> 0&& unicode== 0x0000feffUL)
+    {
+        consumed                        = (size_t)szBOM;
+    }
 
-//  何かのエンコードで指定のwriteStreamへunicodeを書き込む関数の型
-typedef signed int(*storeFunc)( writeStream*const   /*  書き出しストリーム */,
-                                uint32_t const      /*  unicode */ );
+    //  BOMの出力が必要なら出力
+    if( in_converter->_szBOM<= in_dstCap)
+    {
+        if( in_converter->_szBOM!= 0UL)
+        {
+            memcpy( out_dst, &in_converter->_bom[ 0], in_converter->_szBOM);
+            written                         = in_converter->_szBOM;
+        }
+        if( in_converter->_convert( out_dst, in_dstCap, &written, in_src, in_srcLen, &consumed)== convertStop_complete)
+        {
+            result                          = -1;
+        }
+    }
 
+    if( out_written!= (size_t*)0)   *out_written= written;
+    if( out_consumed!= (size_t*)0)  *out_consumed= consumed;
+    return  result;
+}
 
-//  指定エンコーディングで1文字読み込む関数へのポインタ取得
-static loadFunc unicodeHelperGetLoadFunc( unicodeHelperEncoding const in_target)
+//  変換器で変換した場合の出力サイズを数える
+static signed int   unicodeHelper_converterMeasure( unicodeHelperConverter const*const  in_converter,
+                                                    size_t*const                        out_size,
+                                                    uint8_t const*const                 in_src,
+                                                    size_t const                        in_srcLen)
 {
-    switch( in_target)
+    size_t                      consumed= 0;
+
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szBOM= in_converter->_decode( &unicode, in_src, in_srcLen);
+    if( szBOM> 0&& unicode== 0x0000feffUL)
     {
-    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_loadUTF8;
-    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_loadUTF16Arch;
-    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_loadUTF16LE;
-    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_loadUTF16BE;
-    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_loadCP932;
+        consumed                        = (size_t)szBOM;
     }
 
-    return  (loadFunc)0;
+    size_t                      size= 0;
+    consumed                        += in_converter->_measure( &size, in_src+ consumed, (size_t)( in_srcLen- consumed));
+
+    if( out_size!= (size_t*)0)  *out_size= (size_t)( in_converter->_szBOM+ size);
+    return  ( consumed== in_srcLen)? -1: 0;
 }
 
-//  指定エンコーディングで1文字書き出す関数へのポインタ取得
-static storeFunc    unicodeHelperGetStoreFunc( unicodeHelperEncoding const in_target)
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBuffer( uint8_t*const                   out_dst,
+                                                                size_t const                    in_dstCap,
+                                                                size_t*const                    out_written,
+                                                                uint8_t const*const             in_src,
+                                                                size_t const                    in_srcLen,
+                                                                size_t*const                    out_consumed,
+                                                                unicodeHelperEncoding const     in_ecDst,
+                                                                unicodeHelperEncoding const     in_ecSrc,
+                                                                uint32_t const                  in_flags)
 {
-    switch( in_target)
+    //  エンコーディングの組み合わせごとに変換用の関数を分ける
+    unicodeHelperConverter      converter;
+    if( unicodeHelper_converterSetup( &converter, in_ecDst, in_ecSrc, in_flags)!= 0)
     {
-    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_storeUTF8;
-    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_storeUTF16Arch;
-    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_storeUTF16LE;
-    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_storeUTF16BE;
-    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_storeCP932;
+        return  unicodeHelper_converterRun( &converter, out_dst, in_dstCap, out_written, in_src, in_srcLen, out_consumed);
     }
 
-    return  (storeFunc)0;
+    if( out_written!= (size_t*)0)   *out_written= 0UL;
+    if( out_consumed!= (size_t*)0)  *out_consumed= 0UL;
+    return  0;
 }
 
-//  BOMがあるようなら、readStreamをその分飛ばす
-static void unicodeHelperSkipBOM( readStream*const  in_prs,
-                                  loadFunc const    in_loadFunc)
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperMeasure( size_t*const                  out_size,
+                                                          uint8_t const*const           in_src,
+                                                          size_t const                  in_srcLen,
+                                                          unicodeHelperEncoding const   in_ecDst,
+                                                          unicodeHelperEncoding const   in_ecSrc,
+                                                          uint32_t const                in_flags)
 {
-    uint32_t                    unicode;
-
-    if( in_loadFunc( &unicode, in_prs, &in_prs->_indexStream)!= 0)
+    unicodeHelperConverter      converter;
+    if( unicodeHelper_converterSetup( &converter, in_ecDst, in_ecSrc, in_flags)!= 0)
     {
-        if( unicode== 0x0000feffUL)
-        {
-            //  BOMなので除外
-            unicodeHelper_releaseBuffer( in_prs, (uint32_t)( in_prs->_indexStream+ in_prs->_szBuffered));
-        }
+        return  unicodeHelper_converterMeasure( &converter, out_size, in_src, in_srcLen);
     }
+
+    if( out_size!= (size_t*)0)  *out_size= 0UL;
+    return  0;
 }
 
-//  BOMを出力する
-static signed int   unicodeHelperStoreBOM( writeStream*     in_pws,
-                                           storeFunc const  in_storeFunc)
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperBoundSize( size_t const                    in_srcLen,
+                                                        unicodeHelperEncoding const     in_ecDst,
+                                                        unicodeHelperEncoding const     in_ecSrc,
+                                                        uint32_t const                  in_flags)
 {
-    // BOM出力
-    if( in_storeFunc( in_pws, 0x0000feffUL)== 0)
+    size_t const                halfRatio= unicodeHelper_boundHalfRatio( in_ecDst, in_ecSrc);
+    if( halfRatio== 0UL)    return  0;
+
+    //  BOMは出力先エンコードでの実際のサイズ(BOMが無いエンコードなら、unicodeHelperConverterCreate()と同じく変換できない)
+    size_t                      szBOM= 0;
+    if( (uint32_t)( in_flags& unicodeHelperConvertFlag_withBOM)!= 0UL)
     {
-        return  0;
+        uint8_t                     bom[ sizeEncodedMax];
+        signed int const            szOut= unicodeHelperGetEncodeFunc( in_ecDst)( &bom[ 0], 0x0000feffUL);
+        if( szOut== 0)  return  0;
+        szBOM                           = (size_t)szOut;
     }
+    return  (size_t)( in_srcLen/ 2* halfRatio+ ( in_srcLen% 2)* halfRatio+ szBOM);
+}
 
-    return  -1;
+UNICODEHELPER_EXTERN_C unicodeHelperConverter const*    unicodeHelperConverterCreate( unicodeHelperEncoding const   in_ecDst,
+                                                                                      unicodeHelperEncoding const   in_ecSrc,
+                                                                                      uint32_t const                in_flags)
+{
+    unicodeHelperConverter      converter;
+    if( unicodeHelper_converterSetup( &converter, in_ecDst, in_ecSrc, in_flags)== 0)    return  0;
+
+    unicodeHelperConverter*const    pConverter= (unicodeHelperConverter*)malloc( sizeof(unicodeHelperConverter));
+    if( pConverter== 0) return  0;
+
+    *pConverter                     = converter;
+    return  pConverter;
 }
 
-//  エンコード解析のための1unicodehelperEncoding単位の調査用ワーク
-typedef struct {
-    signed int                  _isValid;       //  0:このエンコードは候補ではない -1:このエンコードは現在調査中
-    uint32_t                    _index;         //  次に読み出すreadStreamのオフセット
-    uint32_t                    _maxReadSize;   //  このエンコードの一文字の最大サイズ([byte])
-    loadFunc                    _loadFunc;      //  一文字読み込み用の関数へのポインタ
-} analyze;
+UNICODEHELPER_EXTERN_C void     unicodeHelperConverterDestroy( unicodeHelperConverter const*const  in_converter)
+{
+    free( (void*)in_converter);
+}
 
-//  analyze構造体を初期化
-static analyze* unicodeHelper_analyzeClear( analyze*const   out_analyze,
-                                            uint32_t const  in_maxReadSize,
-                                            loadFunc const  in_loadFunc)
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterMeasure( unicodeHelperConverter const*const  in_converter,
+                                                                   size_t*const                        out_size,
+                                                                   uint8_t const*const                 in_src,
+                                                                   size_t const                        in_srcLen)
 {
-    out_analyze->_isValid           = -1;
-    out_analyze->_index             = 0UL;
-    out_analyze->_maxReadSize       = in_maxReadSize;
-    out_analyze->_loadFunc          = in_loadFunc;
-    return  out_analyze;
+    if( in_converter== 0)
+    {
+        if( out_size!= (size_t*)0)  *out_size= 0UL;
+        return  0;
+    }
+    return  unicodeHelper_converterMeasure( in_converter, out_size, in_src, in_srcLen);
 }
 
-//  readStreamのバッファ内に次の文字が読めるだけの未読or格納領域があるか
-static signed int   unicodeHelper_analyzeIsCheckTarget( analyze const*const     in_analyze,
-                                                        readStream const*const  in_rStream)
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRun( unicodeHelperConverter const*const  in_converter,
+                                                               uint8_t*const                       out_dst,
+                                                               size_t const                        in_dstCap,
+                                                               size_t*const                        out_written,
+                                                               uint8_t const*const                 in_src,
+                                                               size_t const                        in_srcLen,
+                                                               size_t*const                        out_consumed)
 {
-    if( in_analyze->_isValid!= 0)
+    if( in_converter== 0)
     {
+        if( out_written!= (size_t*)0)   *out_written= 0UL;
+        if( out_consumed!= (size_t*)0)  *out_consumed= 0UL;
+        return  0;
+    }
+    return  unicodeHelper_converterRun( in_converter, out_dst, in_dstCap, out_written, in_src, in_srcLen, out_consumed);
+}
 
-        if( in_analyze->_index>= in_rStream->_indexBuffers)
+//  変換器で複数の入力を一つの出力先に続けて変換(戻り値は出力し終えた入力の数)
+static size_t   unicodeHelper_converterRunBatch( unicodeHelperConverter const*const  in_converter,
+                                                 uint8_t*const                       out_dst,
+                                                 size_t const                        in_dstCap,
+                                                 size_t*const                        out_offsets,
+                                                 signed int*const                    out_results,
+                                                 unicodeHelperSpan const*const       in_srcs,
+                                                 size_t const                        in_num)
+{
+    convertBufferFunc const     pConvert= in_converter->_convert;
+    decodeFunc const            pDecode= in_converter->_decode;
+    size_t const                szBOMDst= in_converter->_szBOM;
+    size_t                      written= 0;
+    size_t                      idx= 0;
+
+    out_offsets[ 0]                 = 0UL;
+    for( ; idx< in_num; idx++)
+    {
+        uint8_t const*const         pSrc= in_srcs[ idx]._data;
+        size_t const                szSrc= in_srcs[ idx]._size;
+        size_t const                top= written;
+        size_t                      consumed= 0;
+
+        //  BOMがあったらスキップ(BOMの先頭byteはutf-8で0xef、utf-16で0xfeか0xffなので、それ未満ならデコードしない)
+        uint32_t                    unicode;
+        if( szSrc!= 0UL&& pSrc[ 0]>= 0xefU)
         {
-
-            uint32_t                    offsetInBuff= (uint32_t)( in_analyze->_index- in_rStream->_indexBuffers);
-            if( (uint32_t)( offsetInBuff+ in_analyze->_maxReadSize)<= sizeBufferedMax)
+            signed int const            szBOM= pDecode( &unicode, pSrc, szSrc);
+            if( szBOM> 0&& unicode== 0x0000feffUL)
             {
-                return  -1;
+                consumed                        = (size_t)szBOM;
             }
         }
+
+        //  BOMの出力が必要なら出力
+        if( szBOMDst> (size_t)( in_dstCap- written))    break;
+        if( szBOMDst!= 0UL)
+        {
+            memcpy( out_dst+ written, &in_converter->_bom[ 0], szBOMDst);
+            written                         += szBOMDst;
+        }
+
+        //  前の入力の出力に続けて書く(出力先が足りなければこの入力の分を取り消して止める)
+        convertStop const           stop= pConvert( out_dst, in_dstCap, &written, pSrc, szSrc, &consumed);
+        if( stop== convertStop_shortOutput)
+        {
+            written                         = top;
+            break;
+        }
+
+        if( out_results!= (signed int*)0)   out_results[ idx]= ( stop== convertStop_complete)? -1: 0;
+        out_offsets[ idx+ 1]            = written;
     }
-    return  0;
+
+    return  idx;
 }
 
-//  analyzeの指定エンコーディングで直近の一文字が読めたかどうか
-static signed int   unicodeHelper_analyzeTest( analyze*const    io_analyze,
-                                               readStream*const io_stream)
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperConverterRunBatch( unicodeHelperConverter const*const  in_converter,
+                                                                uint8_t*const                       out_dst,
+                                                                size_t const                        in_dstCap,
+                                                                size_t*const                        out_offsets,
+                                                                signed int*const                    out_results,
+                                                                unicodeHelperSpan const*const       in_srcs,
+                                                                size_t const                        in_num)
 {
-    uint32_t                    unicode;
-
-    if( io_analyze->_loadFunc( &unicode, io_stream, &io_analyze->_index)!= 0)
+    if( in_converter== 0)
     {
-    } else {
-        io_analyze->_isValid            = 0;
+        out_offsets[ 0]                 = 0UL;
+        return  0;
     }
-    return  io_analyze->_isValid;
+    return  unicodeHelper_converterRunBatch( in_converter, out_dst, in_dstCap, out_offsets, out_results, in_srcs, in_num);
 }
 
-//  analyzeの初期化を列挙するための構造体
-typedef struct {
-    unicodeHelperEncoding       _encoding;      //  エンコード
-    uint32_t                    _maxReadSize;   //  一文字の最大サイズ([byte])
-} encodingAndLoadFunc;
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperConvertBatch( uint8_t*const                   out_dst,
+                                                           size_t const                    in_dstCap,
+                                                           size_t*const                    out_offsets,
+                                                           signed int*const                out_results,
+                                                           unicodeHelperSpan const*const   in_srcs,
+                                                           size_t const                    in_num,
+                                                           unicodeHelperEncoding const     in_ecDst,
+                                                           unicodeHelperEncoding const     in_ecSrc,
+                                                           uint32_t const                  in_flags)
+{
+    unicodeHelperConverter      converter;
+    if( unicodeHelper_converterSetup( &converter, in_ecDst, in_ecSrc, in_flags)!= 0)
+    {
+        return  unicodeHelper_converterRunBatch( &converter, out_dst, in_dstCap, out_offsets, out_results, in_srcs, in_num);
+    }
 
-//  unicodeHelperAnalyzeEncoding()中の、エンコード単位のanalyze初期化用パラメータ配列
-static encodingAndLoadFunc const gAnalyzeTargetAry[]= {
-    { unicodeHelperEncoding_utf8,    6UL},
-    { unicodeHelperEncoding_utf16le, 4UL},
-    { unicodeHelperEncoding_utf16be, 4UL},
-    { unicodeHelperEncoding_cp932,   2UL}
-};
+    out_offsets[ 0]                 = 0UL;
+    return  0;
+}
 
-//  エンコーディング読解
-UNICODEHELPER_EXTERN_C unicodeHelperEncoding    unicodeHelperAnalyzeEncoding( unicodeHelperReadByteStream const in_rStrm,
-                                                                              void*const                        io_arg)
+//  変換器でメモリ上のデータを変換(出力先はin_allocatorで確保し、足りなければ倍々で広げる)
+static signed int   unicodeHelper_converterRunAlloc( unicodeHelperConverter const*const  in_converter,
+                                                     unicodeHelperAllocator const*const  in_allocator,
+                                                     uint8_t**const                      out_dst,
+                                                     size_t*const                        out_written,
+                                                     uint8_t const*const                 in_src,
+                                                     size_t const                        in_srcLen)
 {
-    readStream                  rs;
+    unicodeHelperResizeFunc const   pResize= in_allocator->_resize;
+    void*const                  pArg= in_allocator->_arg;
+    size_t const                szBOMDst= in_converter->_szBOM;
+    size_t const                halfRatio= in_converter->_boundHalfRatio;
+    size_t const                bound= (size_t)( in_srcLen/ 2* halfRatio+ ( in_srcLen% 2)* halfRatio+ szBOMDst);
+    size_t                      written= 0;
+    size_t                      consumed= 0;
+
+    *out_dst                        = (uint8_t*)0;
+    if( out_written!= (size_t*)0)   *out_written= 0UL;
+
+    //  最初は入力のサイズ程度(上限がそれより小さければ上限)
+    size_t                      cap= (size_t)( in_srcLen+ szBOMDst+ 16UL);
+    if( bound< cap) cap= bound;
+    if( cap< sizeEncodedMax)    cap= sizeEncodedMax;
+    uint8_t*                    pDst= (uint8_t*)pResize( pArg, (void*)0, 0UL, &cap);
+    if( pDst== (uint8_t*)0) return  0;
+
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szBOM= in_converter->_decode( &unicode, in_src, in_srcLen);
+    if( szBOM> 0&& unicode== 0x0000feffUL)
+    {
+        consumed                        = (size_t)szBOM;
+    }
 
-    readStream*const            prs= unicodeHelper_readStreamClear( &rs, in_rStrm, io_arg);
+    //  BOMの出力が必要なら出力
+    if( szBOMDst!= 0UL)
+    {
+        memcpy( pDst, &in_converter->_bom[ 0], szBOMDst);
+        written                         = szBOMDst;
+    }
 
-    //  まずここで、BOMのチェックをします
-    uint8_t                     uc1st, uc2nd;
-    if( unicodeHelper_loadByte( &uc1st, prs, 0UL)!= 0
-        && unicodeHelper_loadByte( &uc2nd, prs, 1UL)!= 0)
+    //  出力先が足りなくなったら広げて続きから変換する
+    convertStop                 stop;
+    for( ;;)
     {
-        if( uc1st== 0xffU&& uc2nd== 0xfeU)  return  unicodeHelperEncoding_utf16le;
-        if( uc1st== 0xfeU&& uc2nd== 0xffU)  return  unicodeHelperEncoding_utf16be;
+        stop                            = in_converter->_convert( pDst, cap, &written, in_src, in_srcLen, &consumed);
+        if( stop!= convertStop_shortOutput) break;
 
-        if( uc1st== 0xefU&& uc2nd== 0xbbU)
+        size_t                      req= (size_t)( cap* 2UL);
+        if( cap< bound&& bound< req)    req= bound;
+
+        uint8_t*const               pGrown= (uint8_t*)pResize( pArg, pDst, written, &req);
+        if( pGrown== (uint8_t*)0)
         {
-            uint8_t                     uc3rd;
-            if( unicodeHelper_loadByte( &uc3rd, prs, 2UL)!= 0
-                && uc3rd== 0xbfU)
-            {
-                return  unicodeHelperEncoding_utf8;
-            }
+            size_t                      szFree= 0;
+            pResize( pArg, pDst, written, &szFree);
+            return  0;
         }
+        pDst                            = pGrown;
+        cap                             = req;
     }
+
+    //  使わなかった分を戻す(縮められなくてもそのまま使う)
+    if( written< cap)
     {
-        //  エンコーディング単位の解析情報を保存する構造体を初期化
-        analyze                     analyzeAry[ sizeof(gAnalyzeTargetAry)/ sizeof(gAnalyzeTargetAry[0])];
+        size_t                      szShrink= ( written!= 0UL)? written: 1UL;
+        uint8_t*const               pShrunk= (uint8_t*)pResize( pArg, pDst, written, &szShrink);
+        if( pShrunk!= (uint8_t*)0)  pDst= pShrunk;
+    }
 
-        for( int i= 0; i< sizeof(analyzeAry)/ sizeof(analyzeAry[0]); i++)
-        {
-            unicodeHelper_analyzeClear( &analyzeAry[ i],
-                                        gAnalyzeTargetAry[ i]._maxReadSize,
-                                        unicodeHelperGetLoadFunc( gAnalyzeTargetAry[ i]._encoding));
-        }
+    *out_dst                        = pDst;
+    if( out_written!= (size_t*)0)   *out_written= written;
+    return  ( stop== convertStop_complete)? -1: 0;
+}
 
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRunAlloc( unicodeHelperConverter const*const  in_converter,
+                                                                    unicodeHelperAllocator const*const  in_allocator,
+                                                                    uint8_t**const                      out_dst,
+                                                                    size_t*const                        out_written,
+                                                                    uint8_t const*const                 in_src,
+                                                                    size_t const                        in_srcLen)
+{
+    if( in_converter== 0)
+    {
+        *out_dst                        = (uint8_t*)0;
+        if( out_written!= (size_t*)0)   *out_written= 0UL;
+        return  0;
+    }
+    return  unicodeHelper_converterRunAlloc( in_converter, in_allocator, out_dst, out_written, in_src, in_srcLen);
+}
 
-        //  全エンコーディングについて、読めない文字が出るまで読んでい
-        //  く
-        for(;;)
-        {
-            unicodeHelperEncoding       lastHitEncoding= unicodeHelperEncoding_unknown;
-            int                         validEntryNum= 0;
-            signed int                  idxCurMinIsValid= 0;
-            uint32_t                    idxCurMin= 0UL;
-            for( int i= 0; i< sizeof(analyzeAry)/ sizeof(analyzeAry[0]); i++)
-            {
-                analyze*const               analyzeCur= &analyzeAry[ i];
-                //  既に除外されているエンコードは省略
-                if( analyzeCur->_isValid== 0)   continue;
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertAlloc( unicodeHelperAllocator const*const  in_allocator,
+                                                               uint8_t**const                      out_dst,
+                                                               size_t*const                        out_written,
+                                                               uint8_t const*const                 in_src,
+                                                               size_t const                        in_srcLen,
+                                                               unicodeHelperEncoding const         in_ecDst,
+                                                               unicodeHelperEncoding const         in_ecSrc,
+                                                               uint32_t const                      in_flags)
+{
+    unicodeHelperConverter      converter;
+    if( unicodeHelper_converterSetup( &converter, in_ecDst, in_ecSrc, in_flags)!= 0)
+    {
+        return  unicodeHelper_converterRunAlloc( &converter, in_allocator, out_dst, out_written, in_src, in_srcLen);
+    }
 
-                //  prsの読み取り範囲の外に次の読み込み位置があるエンコー
-                //  ドは保留
-                if( unicodeHelper_analyzeIsCheckTarget( analyzeCur, prs)== 0)
-                {
-                    if( idxCurMinIsValid== 0|| idxCurMin> analyzeCur->_index)
-                    {
-                        idxCurMinIsValid                = -1;
-                        idxCurMin                       = analyzeCur->_index;
-                    }
-                    validEntryNum++;
-                    lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
-                    continue;
-                }
+    *out_dst                        = (uint8_t*)0;
+    if( out_written!= (size_t*)0)   *out_written= 0UL;
+    return  0;
+}
 
-                //  prsからunicodeを読めるかテスト
-                if( unicodeHelper_analyzeTest( analyzeCur, prs)!= 0)
-                {
-                    if( idxCurMinIsValid== 0|| idxCurMin> analyzeCur->_index)
-                    {
-                        idxCurMinIsValid                = -1;
-                        idxCurMin                       = analyzeCur->_index;
-                    }
-                    validEntryNum++;
-                    lastHitEncoding                 = gAnalyzeTargetAry[ i]._encoding;
-                } else {
-                    //  候補外
-                    analyzeCur->_isValid            = 0;
-                }
-            }
-            if( validEntryNum<= 1)
+//  分割された入力の切れ目でとっておく最大サイズ([byte])(一文字の最大はutf-8/utf-16の4[byte])
+static size_t const             sizeCarryMax= 4;
+
+//  分割された入力を続けて変換するための状態
+struct unicodeHelperConverterState_ {
+    //  使う変換器
+    unicodeHelperConverter const*   _converter;
+    //  前回の入力の最後で切れていた文字
+    uint8_t                     _carry[ sizeCarryMax];
+    //  _carryのサイズ([byte])
+    size_t                      _szCarry;
+    //  0:入力の先頭は過ぎた -1:入力のBOMをまだ調べていない
+    signed int                  _isTop;
+    //  0:BOMは出力済みか不要 -1:BOMをまだ出力していない
+    signed int                  _isBOMPending;
+    //  0:変換を続けられる -1:不正な入力で止まっている
+    signed int                  _isError;
+};
+
+//  状態を作った直後に戻す
+static void unicodeHelper_converterStateClear( unicodeHelperConverterState*const   io_state)
+{
+    io_state->_szCarry              = 0UL;
+    io_state->_isTop                = -1;
+    io_state->_isBOMPending         = ( io_state->_converter->_szBOM!= 0UL)? -1: 0;
+    io_state->_isError              = 0;
+}
+
+//  まだ出力していないBOMを出力(出力先が足りなければ0を返す)
+static signed int   unicodeHelper_converterStateFlushBOM( unicodeHelperConverterState*const   io_state,
+                                                          uint8_t*const                       out_dst,
+                                                          size_t const                        in_dstCap,
+                                                          size_t*const                        io_written)
+{
+    if( io_state->_isBOMPending!= 0)
+    {
+        unicodeHelperConverter const*const  pConverter= io_state->_converter;
+        if( (size_t)( in_dstCap- *io_written)< pConverter->_szBOM)  return  0;
+
+        memcpy( out_dst+ *io_written, &pConverter->_bom[ 0], pConverter->_szBOM);
+        *io_written                     += pConverter->_szBOM;
+        io_state->_isBOMPending         = 0;
+    }
+    return  -1;
+}
+
+//  前回の入力の最後で切れていた文字を、今回の入力の先頭とつないで変換
+//  止まった理由を返す(convertStop_completeなら*io_consumedまでで一文字出来た)
+static convertStop  unicodeHelper_converterStateJoin( unicodeHelperConverterState*const   io_state,
+                                                      uint8_t*const                       out_dst,
+                                                      size_t const                        in_dstCap,
+                                                      size_t*const                        io_written,
+                                                      uint8_t const*const                 in_src,
+                                                      size_t const                        in_srcLen,
+                                                      size_t*const                        io_consumed)
+{
+    unicodeHelperConverter const*const  pConverter= io_state->_converter;
+    size_t const                szCarry= io_state->_szCarry;
+    size_t const                szJoin= ( in_srcLen< sizeCarryMax)? in_srcLen: sizeCarryMax;
+    uint8_t                     buf[ sizeCarryMax* 2];
+
+    memcpy( &buf[ 0], &io_state->_carry[ 0], szCarry);
+    if( szJoin!= 0UL)   memcpy( &buf[ szCarry], in_src, szJoin);
+
+    uint32_t                    unicode;
+    signed int const            szIn= pConverter->_decode( &unicode, &buf[ 0], (size_t)( szCarry+ szJoin));
+    if( szIn< 0)    return  convertStop_invalid;
+    if( szIn== 0)
+    {
+        //  まだ足りないので、今回の入力も全部とっておく
+        memcpy( &io_state->_carry[ szCarry], in_src, in_srcLen);
+        io_state->_szCarry              = (size_t)( szCarry+ in_srcLen);
+        *io_consumed                    = in_srcLen;
+        return  convertStop_shortInput;
+    }
+
+    //  入力の先頭のBOMは出力しない
+    if( io_state->_isTop== 0|| unicode!= 0x0000feffUL)
+    {
+        size_t                      idxBuf= 0UL;
+        convertStop const           stop= pConverter->_convert( out_dst, in_dstCap, io_written, &buf[ 0], (size_t)szIn, &idxBuf);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+
+    io_state->_szCarry              = 0UL;
+    io_state->_isTop                = 0;
+    *io_consumed                    = (size_t)( (size_t)szIn- szCarry);
+    return  convertStop_complete;
+}
+
+//  状態を使った変換(止まった理由を返す)
+static convertStop  unicodeHelper_converterStateFeed( unicodeHelperConverterState*const   io_state,
+                                                      uint8_t*const                       out_dst,
+                                                      size_t const                        in_dstCap,
+                                                      size_t*const                        io_written,
+                                                      uint8_t const*const                 in_src,
+                                                      size_t const                        in_srcLen,
+                                                      size_t*const                        io_consumed)
+{
+    unicodeHelperConverter const*const  pConverter= io_state->_converter;
+
+    if( unicodeHelper_converterStateFlushBOM( io_state, out_dst, in_dstCap, io_written)== 0)
+    {
+        return  convertStop_shortOutput;
+    }
+
+    //  前回の続きの文字を先に片付ける
+    if( io_state->_szCarry!= 0UL)
+    {
+        convertStop const           stop= unicodeHelper_converterStateJoin( io_state, out_dst, in_dstCap, io_written, in_src, in_srcLen, io_consumed);
+        if( stop!= convertStop_complete)    return  ( stop== convertStop_shortInput)? convertStop_complete: stop;
+    }
+
+    //  BOMがあったらスキップ(一文字に足りなければ、切れた文字として次で調べる)
+    if( io_state->_isTop!= 0)
+    {
+        uint32_t                    unicode;
+        signed int const            szBOM= pConverter->_decode( &unicode, in_src+ *io_consumed, (size_t)( in_srcLen- *io_consumed));
+        if( szBOM> 0&& unicode== 0x0000feffUL)
+        {
+            *io_consumed                    += (size_t)szBOM;
+        }
+        if( szBOM!= 0)  io_state->_isTop= 0;
+    }
+
+    convertStop const           stop= pConverter->_convert( out_dst, in_dstCap, io_written, in_src, in_srcLen, io_consumed);
+    if( stop== convertStop_shortInput)
+    {
+        //  最後で切れている文字はとっておく
+        size_t const                szRest= (size_t)( in_srcLen- *io_consumed);
+        if( szRest> sizeCarryMax)   return  convertStop_invalid;
+        memcpy( &io_state->_carry[ 0], in_src+ *io_consumed, szRest);
+        io_state->_szCarry              = szRest;
+        *io_consumed                    = in_srcLen;
+        return  convertStop_complete;
+    }
+    return  stop;
+}
+
+UNICODEHELPER_EXTERN_C unicodeHelperConverterState*     unicodeHelperConverterStateCreate( unicodeHelperConverter const*const  in_converter)
+{
+    if( in_converter== 0)   return  0;
+
+    unicodeHelperConverterState*const   pState= (unicodeHelperConverterState*)malloc( sizeof(unicodeHelperConverterState));
+    if( pState== 0) return  0;
+
+    pState->_converter              = in_converter;
+    unicodeHelper_converterStateClear( pState);
+    return  pState;
+}
+
+UNICODEHELPER_EXTERN_C void     unicodeHelperConverterStateDestroy( unicodeHelperConverterState*const   in_state)
+{
+    free( in_state);
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterStateFeed( unicodeHelperConverterState*const   io_state,
+                                                                     uint8_t*const                       out_dst,
+                                                                     size_t const                        in_dstCap,
+                                                                     size_t*const                        out_written,
+                                                                     uint8_t const*const                 in_src,
+                                                                     size_t const                        in_srcLen,
+                                                                     size_t*const                        out_consumed)
+{
+    size_t                      written= 0;
+    size_t                      consumed= 0;
+    signed int                  result= 0;
+
+    if( io_state!= 0&& io_state->_isError== 0)
+    {
+        if( unicodeHelper_converterStateFeed( io_state, out_dst, in_dstCap, &written, in_src, in_srcLen, &consumed)== convertStop_invalid)
+        {
+            io_state->_isError              = -1;
+        } else {
+            result                          = -1;
+        }
+    }
+
+    if( out_written!= (size_t*)0)   *out_written= written;
+    if( out_consumed!= (size_t*)0)  *out_consumed= consumed;
+    return  result;
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterStateFinish( unicodeHelperConverterState*const io_state,
+                                                                       uint8_t*const                     out_dst,
+                                                                       size_t const                      in_dstCap,
+                                                                       size_t*const                      out_written)
+{
+    size_t                      written= 0;
+    signed int                  result= 0;
+
+    if( io_state!= 0)
+    {
+        if( io_state->_isError!= 0|| io_state->_szCarry!= 0UL)
+        {
+            //  途中で失敗していたか、入力の最後で文字が切れていた
+            unicodeHelper_converterStateClear( io_state);
+        } else if( unicodeHelper_converterStateFlushBOM( io_state, out_dst, in_dstCap, &written)!= 0) {
+            unicodeHelper_converterStateClear( io_state);
+            result                          = -1;
+        }
+    }
+
+    if( out_written!= (size_t*)0)   *out_written= written;
+    return  result;
+}
+
+//  並列に変換する際に一つのスレッドに任せる入力のサイズ([byte])
+static size_t const             sizeParallelChunk= 1UL* 1024UL* 1024UL;
+
+//  入力1[byte]あたりの最大の出力サイズ([byte])(cp932の半角カナ1[byte]がutf-8で3[byte]になるのが最大)
+static size_t const             ratioOutputMax= 3;
+
+//  並列に変換する一かたまりの入力
+typedef struct {
+    uint8_t const*              _src;
+    size_t                      _srcLen;
+} parallelChunk;
+
+//  並列に変換する全体(全部のスレッドで共有する)
+typedef struct {
+    unicodeHelperConverter const*   _converter;
+    parallelChunk const*        _chunks;
+    uint32_t                    _numChunks;
+    uint8_t*                    _dst;
+    size_t                      _dstCap;
+    //  次に変換するかたまり
+    std::atomic<uint32_t>       _next;
+    //  以下は_mutexで守る
+    std::mutex                  _mutex;
+    std::condition_variable     _placed;
+    //  出力先での位置が決まったかたまりの数(_offsets[ _numPlaced]までは決まっている)
+    uint32_t                    _numPlaced;
+    //  一つのスレッドで続きを変換するかたまり(失敗したか出力先に収まらない。無ければ_numChunks)
+    uint32_t                    _stop;
+    //  かたまりごとの出力先での位置(_numChunks+ 1個)
+    size_t*                     _offsets;
+} parallelJob;
+
+//  かたまりを順に取っては作業用の出力先に変換し、前のかたまりの出力サイズで位置が決まったら出力先へ写す
+//  写すのはかたまりごとに別のスレッドで行うので、位置を決める所だけが順番待ちになる
+static void unicodeHelper_parallelWorker( parallelJob*const io_job,
+                                          uint8_t*const     io_work,
+                                          size_t const      in_workCap)
+{
+    for( ;;)
+    {
+        uint32_t const              idx= io_job->_next.fetch_add( 1UL, std::memory_order_relaxed);
+        if( idx>= io_job->_numChunks)   break;
+
+        parallelChunk const*const   pChunk= &io_job->_chunks[ idx];
+        size_t                      written= 0UL;
+        size_t                      consumed= 0UL;
+        convertStop const           stop= io_job->_converter->_convert( io_work, in_workCap, &written, pChunk->_src, pChunk->_srcLen, &consumed);
+
+        size_t                      offset;
+        bool                        isPlaced;
+        {
+            std::unique_lock<std::mutex>    lock( io_job->_mutex);
+            while( io_job->_numPlaced!= idx&& io_job->_stop> idx)   io_job->_placed.wait( lock);
+            //  前のかたまりで止まっていれば、以降は要らない
+            if( io_job->_stop< idx) break;
+
+            offset                          = io_job->_offsets[ idx];
+            isPlaced                        = ( stop== convertStop_complete&& written<= (size_t)( io_job->_dstCap- offset));
+            if( isPlaced!= false)
             {
-                //  こいつが候補です
-                return  lastHitEncoding;
+                io_job->_offsets[ idx+ 1UL]     = (size_t)( offset+ written);
+                io_job->_numPlaced              = idx+ 1UL;
+            } else {
+                io_job->_stop                   = idx;
             }
-            unicodeHelper_releaseBuffer( prs, (uint32_t)( idxCurMin- prs->_indexBuffers));
         }
+        io_job->_placed.notify_all();
+        if( isPlaced== false)   break;
+
+        memcpy( io_job->_dst+ offset, io_work, written);
     }
-    return  unicodeHelperEncoding_unknown;
 }
 
+//  入力を文字の切れ目で分けて、複数のスレッドで変換
+//  スレッドは一度だけ作り、各スレッドがかたまりを順に取って変換しては出力サイズを順に足した位置へ写す
+//  失敗したかたまりか、出力先に収まらないかたまりからは一つのスレッドで続けるので、結果は一つのスレッドで変換した場合と同じ
+static signed int   unicodeHelper_converterRunParallel( unicodeHelperConverter const*const  in_converter,
+                                                        uint8_t*const                       out_dst,
+                                                        size_t const                        in_dstCap,
+                                                        size_t*const                        out_written,
+                                                        uint8_t const*const                 in_src,
+                                                        size_t const                        in_srcLen,
+                                                        size_t*const                        out_consumed,
+                                                        uint32_t const                      in_numThreads)
+{
+    uint32_t                    numThreads= ( in_numThreads!= 0UL)? in_numThreads: (uint32_t)std::thread::hardware_concurrency();
+    if( numThreads<= 1UL|| in_srcLen< sizeParallelChunk* 2UL)
+    {
+        return  unicodeHelper_converterRun( in_converter, out_dst, in_dstCap, out_written, in_src, in_srcLen, out_consumed);
+    }
 
-UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvert( unicodeHelperWriteByteStream const    in_wStrm,
-                                                          unicodeHelperEncoding const           in_ecDst,
-                                                          signed int const                      in_withBOM,
-                                                          unicodeHelperReadByteStream const     in_rStrm,
-                                                          unicodeHelperEncoding const           in_ecSrc,
-                                                          void*const                            io_arg)
+    size_t                      written= 0;
+    size_t                      consumed= 0;
+
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szBOM= in_converter->_decode( &unicode, in_src, in_srcLen);
+    if( szBOM> 0&& unicode== 0x0000feffUL)
+    {
+        consumed                        = (size_t)szBOM;
+    }
+
+    //  BOMの出力が必要なら出力
+    if( in_converter->_szBOM> in_dstCap)
+    {
+        if( out_written!= (size_t*)0)   *out_written= written;
+        if( out_consumed!= (size_t*)0)  *out_consumed= consumed;
+        return  0;
+    }
+    if( in_converter->_szBOM!= 0UL)
+    {
+        memcpy( out_dst, &in_converter->_bom[ 0], in_converter->_szBOM);
+        written                         = in_converter->_szBOM;
+    }
+
+    //  文字の切れ目で分ける(切れ目は前後の数[byte]を見るだけなので、先に全部決める)
+    //  切れ目は数[byte]前にずれることがあるので、かたまりの数はそれも見込む
+    size_t const                maxChunks= (size_t)( ( in_srcLen- consumed)/ ( sizeParallelChunk- sizeCarryMax)+ 1UL);
+    if( numThreads> maxChunks)  numThreads= (uint32_t)maxChunks;
+
+    //  作業用の出力先(文字の切れ目に合わせて延びる分も見込む)
+    size_t const                sizeWork= (size_t)( ( sizeParallelChunk+ sizeCarryMax)* ratioOutputMax);
+    parallelChunk*const         pChunks= (parallelChunk*)malloc( sizeof(parallelChunk)* maxChunks);
+    size_t*const                pOffsets= (size_t*)malloc( sizeof(size_t)* ( maxChunks+ 1UL));
+    uint8_t*const               pWork= (uint8_t*)malloc( sizeWork* numThreads);
+    std::thread*const           pThreads= new( std::nothrow) std::thread[ numThreads];
+    if( pChunks== 0|| pOffsets== 0|| pWork== 0|| pThreads== 0)
+    {
+        free( pChunks);
+        free( pOffsets);
+        free( pWork);
+        delete[]    pThreads;
+        return  unicodeHelper_converterRun( in_converter, out_dst, in_dstCap, out_written, in_src, in_srcLen, out_consumed);
+    }
+
+    uint32_t                    numChunks= 0UL;
+    for( size_t idx= consumed; idx< in_srcLen; numChunks++)
+    {
+        size_t const                end= ( (size_t)( in_srcLen- idx)<= sizeParallelChunk)? in_srcLen
+                                                                                         : in_converter->_boundary( in_src, in_srcLen, idx, (size_t)( idx+ sizeParallelChunk));
+        pChunks[ numChunks]._src        = in_src+ idx;
+        pChunks[ numChunks]._srcLen     = (size_t)( end- idx);
+        idx                             = end;
+    }
+
+    parallelJob                 job;
+    job._converter                  = in_converter;
+    job._chunks                     = pChunks;
+    job._numChunks                  = numChunks;
+    job._dst                        = out_dst;
+    job._dstCap                     = in_dstCap;
+    job._next.store( 0UL, std::memory_order_relaxed);
+    job._numPlaced                  = 0UL;
+    job._stop                       = numChunks;
+    job._offsets                    = pOffsets;
+    pOffsets[ 0]                    = written;
+
+    //  このスレッドも含めて変換する(スレッドが作れなければ、作れた分だけで変換する)
+    for( uint32_t i= 1UL; i< numThreads; i++)
+    {
+        try {
+            pThreads[ i]                    = std::thread( unicodeHelper_parallelWorker, &job, pWork+ sizeWork* i, sizeWork);
+        } catch( ...) {
+            break;
+        }
+    }
+    unicodeHelper_parallelWorker( &job, pWork, sizeWork);
+    for( uint32_t i= 1UL; i< numThreads; i++)
+    {
+        if( pThreads[ i].joinable())    pThreads[ i].join();
+    }
+
+    signed int                  result= -1;
+    written                         = pOffsets[ job._numPlaced];
+    if( job._stop< numChunks)
+    {
+        //  止まったかたまりからは一つのスレッドで変換して、止まる位置を合わせる
+        consumed                        = (size_t)( pChunks[ job._stop]._src- in_src);
+        if( in_converter->_convert( out_dst, in_dstCap, &written, in_src, in_srcLen, &consumed)!= convertStop_complete)
+        {
+            result                          = 0;
+        }
+    } else {
+        consumed                        = in_srcLen;
+    }
+
+    free( pChunks);
+    free( pOffsets);
+    free( pWork);
+    delete[]    pThreads;
+
+    if( out_written!= (size_t*)0)   *out_written= written;
+    if( out_consumed!= (size_t*)0)  *out_consumed= consumed;
+    return  result;
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRunParallel( unicodeHelperConverter const*const  in_converter,
+                                                                       uint8_t*const                       out_dst,
+                                                                       size_t const                        in_dstCap,
+                                                                       size_t*const                        out_written,
+                                                                       uint8_t const*const                 in_src,
+                                                                       size_t const                        in_srcLen,
+                                                                       size_t*const                        out_consumed,
+                                                                       uint32_t const                      in_numThreads)
 {
-    readStream                  rs;
-    readStream*                 prs;
-    writeStream                 ws;
-    writeStream*                pws;
+    if( in_converter== 0)
+    {
+        if( out_written!= (size_t*)0)   *out_written= 0UL;
+        if( out_consumed!= (size_t*)0)  *out_consumed= 0UL;
+        return  0;
+    }
+    return  unicodeHelper_converterRunParallel( in_converter, out_dst, in_dstCap, out_written, in_src, in_srcLen, out_consumed, in_numThreads);
+}
+
+//  メモリ上でin_decodeとして一文字ずつ検証する
+//  最初に不正な文字の位置([byte])を返す(全部正しければin_srcLen)
+template< decodeFunc in_decode>
+static size_t   unicodeHelper_validateBuffer( uint8_t const*const   in_src,
+                                              size_t const          in_srcLen)
+{
+    size_t                      idx= 0UL;
+    while( idx< in_srcLen)
+    {
+        uint32_t                    unicode;
+        signed int const            szIn= in_decode( &unicode, in_src+ idx, (size_t)( in_srcLen- idx));
+        if( szIn<= 0)   break;
+        idx                             += (size_t)szIn;
+    }
+    return  idx;
+}
+
+//  指定エンコーディングの検証関数へのポインタ取得
+static validateFunc unicodeHelperGetValidateFunc( unicodeHelperEncoding const in_target)
+{
+    //  まとめて処理できるものはそちら
+    validateFunc const          pSimd= unicodeHelper_simdGetValidateFunc( in_target);
+    if( pSimd!= (validateFunc)0)    return  pSimd;
+
+    switch( in_target)
+    {
+    case    unicodeHelperEncoding_cp932:        return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_cp932> >;
+    case    unicodeHelperEncoding_shiftJIS:     return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_shiftJIS> >;
+    case    unicodeHelperEncoding_eucJP:        return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_eucJP> >;
+    case    unicodeHelperEncoding_gbk:          return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_gbk> >;
+    case    unicodeHelperEncoding_big5:         return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_big5> >;
+    case    unicodeHelperEncoding_cp949:        return  unicodeHelper_validateBuffer< unicodeHelper_decodeCodepage< codepage_cp949> >;
+    default:                                    break;
+    }
+
+    return  (validateFunc)0;
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperValidate( unicodeHelperEncoding const     in_encoding,
+                                                           uint8_t const*const             in_src,
+                                                           size_t const                    in_srcLen,
+                                                           size_t*const                    out_errorOffset)
+{
+    size_t                      errorOffset= 0UL;
+    signed int                  result= 0;
+
+    validateFunc const          pValidate= unicodeHelperGetValidateFunc( in_encoding);
+    if( pValidate!= (validateFunc)0)
+    {
+        errorOffset                     = pValidate( in_src, in_srcLen);
+        if( errorOffset== in_srcLen)    result= -1;
+    }
+
+    if( out_errorOffset!= (size_t*)0)   *out_errorOffset= errorOffset;
+    return  result;
+}
+
+//  unicodeHelperDetectEncoding()で調べるエンコードの並び(確からしさが同じならこの順)
+static unicodeHelperEncoding const  gDetectTargetAry[]= {
+    unicodeHelperEncoding_utf8,
+    unicodeHelperEncoding_utf16le,
+    unicodeHelperEncoding_utf16be,
+    unicodeHelperEncoding_cp932
+};
+
+//  全部正しいか、最後で文字が切れているだけなら0以外
+static signed int   unicodeHelper_detectIsValid( unicodeHelperEncoding const    in_encoding,
+                                                 uint8_t const*const            in_src,
+                                                 size_t const                   in_srcLen)
+{
+    validateFunc const          pValidate= unicodeHelperGetValidateFunc( in_encoding);
+    decodeFunc const            pDecode= unicodeHelperGetDecodeFunc( in_encoding);
+    if( pValidate== (validateFunc)0|| pDecode== (decodeFunc)0)  return  0;
+
+    size_t const                errorOffset= pValidate( in_src, in_srcLen);
+    if( errorOffset== in_srcLen)    return  -1;
+
+    //  残りが一文字に足りないだけ(デコードが0)なら切れた文字
     uint32_t                    unicode;
-    storeFunc                   pStore;
+    return  ( pDecode( &unicode, in_src+ errorOffset, (size_t)( in_srcLen- errorOffset))== 0)? -1: 0;
+}
+
+//  確からしさを1〜100に収める(0以下は候補外)
+static uint32_t unicodeHelper_detectClamp( signed long const in_score)
+{
+    if( in_score< 0L)   return  0UL;
+    if( in_score> 100L) return  100UL;
+    return  (uint32_t)in_score;
+}
+
+//  エンコードごとの確からしさ(0は候補外)
+//  in_otherは、0x80以上を含む文字が読めた他の1[byte]単位のエンコードの確からしさ(そちらが確かなほど差し引く)
+static uint32_t unicodeHelper_detectScore( unicodeHelperEncoding const  in_encoding,
+                                           byteHistogram const*const    in_histogram,
+                                           uint32_t const               in_other,
+                                           size_t const                 in_srcLen)
+{
+    size_t const                numZero= (size_t)( in_histogram->_zeroEven+ in_histogram->_zeroOdd);
+    //  0x00と制御文字は1/4あれば候補外になる程度に差し引く
+    signed long const           penaltyZero= ( in_srcLen== 0UL)? 0L: (signed long)( (double)numZero* 400.0/ (double)in_srcLen);
+    signed long const           penaltyControl= ( in_srcLen== 0UL)? 0L: (signed long)( (double)in_histogram->_control* 400.0/ (double)in_srcLen);
+
+    switch( in_encoding)
+    {
+    case    unicodeHelperEncoding_utf8:
+        return  unicodeHelper_detectClamp( ( ( in_histogram->_high> 0UL)? 100L: 95L)- penaltyZero- penaltyControl);
+
+    case    unicodeHelperEncoding_cp932:
+        {
+            //  utf-8としても正しい2[byte]文字の並びは、偶然cp932として読めただけのことが多い
+            signed long                 score= 90L;
+            if( in_histogram->_high> 0UL)   score= 95L- (signed long)( in_other* 55UL/ 100UL);
+            return  unicodeHelper_detectClamp( score- penaltyZero- penaltyControl);
+        }
+
+    case    unicodeHelperEncoding_utf16le:
+    case    unicodeHelperEncoding_utf16be:
+        {
+            if( in_srcLen< 2UL) return  0UL;
+
+            //  ASCIIの文字は上位byteが0x00になり、同じ種類の文字が続くと上位byteが同じになるので、
+            //  0x00と2[byte]先と同じbyteが、上位byteの側(leなら奇数番目)に偏っているかを見る
+            signed int const            isLE= ( in_encoding== unicodeHelperEncoding_utf16le)? -1: 0;
+            double const                numWord= (double)( in_srcLen/ 2UL);
+            double const                zeroHigh= (double)( ( isLE!= 0)? in_histogram->_zeroOdd: in_histogram->_zeroEven);
+            double const                repeatHigh= (double)( ( isLE!= 0)? in_histogram->_repeatOdd: in_histogram->_repeatEven);
+            double const                repeatLow= (double)( ( isLE!= 0)? in_histogram->_repeatEven: in_histogram->_repeatOdd);
+            signed long                 score= 50L+ (signed long)( ( zeroHigh+ repeatHigh- repeatLow)* 50.0/ numWord);
+            score                           -= (signed long)( in_other* 30UL/ 100UL);
+            if( numZero== 0UL&& in_histogram->_high== 0UL)  score-= 40L;
+            return  unicodeHelper_detectClamp( score);
+        }
+
+    default:
+        break;
+    }
+    return  0UL;
+}
+
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperDetectEncoding( unicodeHelperDetectCandidate*const  out_candidates,
+                                                             size_t const                        in_candidateCap,
+                                                             signed int*const                    out_isASCII,
+                                                             uint8_t const*const                 in_src,
+                                                             size_t const                        in_srcLen)
+{
+    //  BOMがあればそのエンコード
+    unicodeHelperEncoding       ecBOM= unicodeHelperEncoding_unknown;
+    if( in_srcLen>= 2UL)
+    {
+        if( in_src[ 0]== 0xffU&& in_src[ 1]== 0xfeU)    ecBOM= unicodeHelperEncoding_utf16le;
+        if( in_src[ 0]== 0xfeU&& in_src[ 1]== 0xffU)    ecBOM= unicodeHelperEncoding_utf16be;
+        if( in_srcLen>= 3UL
+            && in_src[ 0]== 0xefU&& in_src[ 1]== 0xbbU&& in_src[ 2]== 0xbfU)
+        {
+            ecBOM                           = unicodeHelperEncoding_utf8;
+        }
+    }
+    if( ecBOM!= unicodeHelperEncoding_unknown)
+    {
+        if( out_isASCII!= (signed int*)0)   *out_isASCII= 0;
+        if( in_candidateCap== 0UL)  return  0UL;
+        out_candidates[ 0]._encoding    = ecBOM;
+        out_candidates[ 0]._confidence  = 100UL;
+        return  1UL;
+    }
+
+    //  byteの種類ごとの個数を一度に数える
+    byteHistogram               histogram;
+    unicodeHelper_simdByteHistogram( &histogram, in_src, in_srcLen);
+    signed int const            isASCII= ( histogram._high== 0UL&& histogram._zeroEven== 0UL&& histogram._zeroOdd== 0UL)? -1: 0;
+    if( out_isASCII!= (signed int*)0)   *out_isASCII= isASCII;
+
+    //  確からしさが残った候補だけを検証する(utf-8とcp932は0x80以上がある場合だけ)
+    uint32_t                    confUTF8= unicodeHelper_detectScore( unicodeHelperEncoding_utf8, &histogram, 0UL, in_srcLen);
+    if( confUTF8!= 0UL&& histogram._high> 0UL
+        && unicodeHelper_detectIsValid( unicodeHelperEncoding_utf8, in_src, in_srcLen)== 0)
+    {
+        confUTF8                        = 0UL;
+    }
+    uint32_t const              otherCP932= ( histogram._high> 0UL)? confUTF8: 0UL;
+    uint32_t                    confCP932= unicodeHelper_detectScore( unicodeHelperEncoding_cp932, &histogram, otherCP932, in_srcLen);
+    if( confCP932!= 0UL&& histogram._high> 0UL
+        && unicodeHelper_detectIsValid( unicodeHelperEncoding_cp932, in_src, in_srcLen)== 0)
+    {
+        confCP932                       = 0UL;
+    }
+    uint32_t const              otherUTF16= ( histogram._high== 0UL)? 0UL: ( confUTF8> confCP932)? confUTF8: confCP932;
+
+    unicodeHelperDetectCandidate    candidates[ sizeof(gDetectTargetAry)/ sizeof(gDetectTargetAry[0])];
+    size_t                      numCandidates= 0UL;
+    for( size_t i= 0UL; i< sizeof(gDetectTargetAry)/ sizeof(gDetectTargetAry[0]); i++)
+    {
+        unicodeHelperEncoding const ec= gDetectTargetAry[ i];
+        uint32_t                    confidence= 0UL;
+        switch( ec)
+        {
+        case    unicodeHelperEncoding_utf8:     confidence= confUTF8;   break;
+        case    unicodeHelperEncoding_cp932:    confidence= confCP932;  break;
+        default:
+            confidence                      = unicodeHelper_detectScore( ec, &histogram, otherUTF16, in_srcLen);
+            if( confidence!= 0UL&& unicodeHelper_detectIsValid( ec, in_src, in_srcLen)== 0)    confidence= 0UL;
+            break;
+        }
+        if( confidence== 0UL)   continue;
+
+        //  確からしさの高い順に挿入(同じなら先に調べた方が前)
+        size_t                      idx= numCandidates;
+        while( idx> 0UL&& candidates[ idx- 1UL]._confidence< confidence)
+        {
+            candidates[ idx]                = candidates[ idx- 1UL];
+            idx--;
+        }
+        candidates[ idx]._encoding      = ec;
+        candidates[ idx]._confidence    = confidence;
+        numCandidates++;
+    }
 
-    //  入力エンコーディングごとに読み込み用の関数を分ける
-    loadFunc const              pLoad= unicodeHelperGetLoadFunc( in_ecSrc);
-    if( pLoad== (loadFunc)0)    return  0;
+    size_t const                numWritten= ( numCandidates< in_candidateCap)? numCandidates: in_candidateCap;
+    for( size_t i= 0UL; i< numWritten; i++)
+    {
+        out_candidates[ i]              = candidates[ i];
+    }
+    return  numWritten;
+}
 
-    //  出力エンコーディングごとに書き出し用の関数を分ける
-    pStore                          = unicodeHelperGetStoreFunc( in_ecDst);
-    if( pStore== (storeFunc)0)  return  0;
+//  ブロック単位の入出力でためておくサイズ([byte])
+static size_t const             sizeStagingBuffer= 16UL* 1024UL;
 
-    //  入出力ストリームを初期化
-    prs                             = unicodeHelper_readStreamClear(  &rs, in_rStrm, io_arg);
-    pws                             = unicodeHelper_writeStreamClear( &ws, in_wStrm, io_arg);
+//  ブロック単位の書き出し処理用
+typedef struct {
+    //  書き出し関数
+    unicodeHelperWriteBlockStream   _wStream;
+    void*                       _arg;
+    //  ためてあるサイズ([byte])
+    size_t                      _szBuffered;
+    //  これまでに書き出したサイズ([byte])
+    uint64_t                    _written;
+    //  ためている内容
+    uint8_t                     _buffer[ sizeStagingBuffer];
+} writeBlockStream;
+
+//  writeBlockStreamを初期化
+static writeBlockStream*    unicodeHelper_writeBlockStreamClear( writeBlockStream*const              io_target,
+                                                                 unicodeHelperWriteBlockStream const in_wStream,
+                                                                 void*const                          io_arg)
+{
+    io_target->_wStream             = in_wStream;
+    io_target->_arg                 = io_arg;
+    io_target->_szBuffered          = 0UL;
+    io_target->_written             = 0ULL;
 
-    //  BOMがあるったらスキップ
-    unicodeHelperSkipBOM( prs, pLoad);
+    return  io_target;
+}
+
+//  ためてある内容を書き出す
+static signed int   unicodeHelper_flushBlock( writeBlockStream*const io_target)
+{
+    if( io_target->_szBuffered!= 0UL)
+    {
+        if( io_target->_wStream( &io_target->_buffer[ 0], io_target->_szBuffered, io_target->_arg)== 0)
+        {
+            return  0;
+        }
+        io_target->_written             += (uint64_t)io_target->_szBuffered;
+        io_target->_szBuffered          = 0UL;
+    }
+    return  -1;
+}
+
+//  書き出すごとに途中経過を知らせる(in_progressが無ければ何もしない)
+static signed int   unicodeHelper_notifyProgress( unicodeHelperProgress const   in_progress,
+                                                  uint64_t const                in_consumed,
+                                                  writeBlockStream const*const  in_ws)
+{
+    if( in_progress== (unicodeHelperProgress)0) return  -1;
+    return  in_progress( in_consumed, in_ws->_written, in_ws->_arg);
+}
+
+//  ブロック単位の入出力でエンコード変更
+//  io_bufIn(sizeStagingBuffer[byte])の先頭in_szIn[byte]は読み込み済みの入力で、in_isEOSなら入力はそれで終わり
+static signed int   unicodeHelper_convertBlock( unicodeHelperWriteBlockStream const   in_wStrm,
+                                                unicodeHelperEncoding const           in_ecDst,
+                                                signed int const                      in_withBOM,
+                                                unicodeHelperReadBlockStream const    in_rStrm,
+                                                unicodeHelperEncoding const           in_ecSrc,
+                                                unicodeHelperProgress const           in_progress,
+                                                void*const                            io_arg,
+                                                uint8_t*const                         io_bufIn,
+                                                size_t const                          in_szIn,
+                                                signed int const                      in_isEOS)
+{
+    writeBlockStream            ws;
+    uint8_t*const               bufIn= io_bufIn;
+    size_t                      szIn= in_szIn;
+    size_t                      idxIn= 0UL;
+    uint64_t                    consumed= 0ULL;     //  bufInより前に変換し終えたサイズ([byte])
+    signed int                  isEOS= in_isEOS;
+    signed int                  isTop= -1;
+
+    //  エンコーディングの組み合わせごとに変換用の関数を分ける
+    convertBufferFunc const     pConvert= unicodeHelperGetConvertBufferFunc( in_ecDst, in_ecSrc);
+    if( pConvert== (convertBufferFunc)0)    return  0;
+
+    writeBlockStream*const      pws= unicodeHelper_writeBlockStreamClear( &ws, in_wStrm, io_arg);
 
     //  BOMの出力が必要なら出力
-    if( in_withBOM!= 0&& unicodeHelperStoreBOM( pws, pStore)== 0)   return  0;
+    if( in_withBOM!= 0)
+    {
+        signed int const            szOut= unicodeHelperGetEncodeFunc( in_ecDst)( &pws->_buffer[ 0], 0x0000feffUL);
+        if( szOut== 0)  return  0;
+        pws->_szBuffered                = (size_t)szOut;
+    }
 
-    //  一文字ごとに処理
     for(;;)
     {
-        //  読み込み
-        if( pLoad( &unicode, prs, &prs->_indexStream)== 0)
+        //  未変換の分を前に詰めて、入力を補充
+        if( idxIn!= 0UL)
+        {
+            memmove( &bufIn[ 0], &bufIn[ idxIn], (size_t)( szIn- idxIn));
+            consumed                        += (uint64_t)idxIn;
+            szIn                            = (size_t)( szIn- idxIn);
+            idxIn                           = 0UL;
+        }
+        if( isEOS== 0&& szIn< sizeStagingBuffer)
         {
-            //  入力が切れてる?
-            if( prs->_EOS!= 0&& prs->_szBuffered== 0UL)
+            size_t const                szRead= in_rStrm( &bufIn[ szIn], (size_t)( sizeStagingBuffer- szIn), io_arg);
+            if( szRead== 0UL)
             {
-                return  -1;
+                isEOS                           = -1;
+            } else {
+                szIn                            += szRead;
+            }
+        }
+
+        //  BOMがあったらスキップ
+        if( isTop!= 0)
+        {
+            uint32_t                    unicode;
+            signed int const            szBOM= unicodeHelperGetDecodeFunc( in_ecSrc)( &unicode, &bufIn[ 0], szIn);
+            if( szBOM== 0&& isEOS== 0)  continue;
+            if( szBOM> 0&& unicode== 0x0000feffUL)
+            {
+                idxIn                           = (size_t)szBOM;
+            }
+            isTop                           = 0;
+        }
+
+        //  変換
+        switch( pConvert( &pws->_buffer[ 0], sizeStagingBuffer, &pws->_szBuffered, &bufIn[ 0], szIn, &idxIn))
+        {
+        case    convertStop_complete:
+            if( isEOS!= 0)
+            {
+                if( unicodeHelper_flushBlock( pws)== 0) return  0;
+                return  unicodeHelper_notifyProgress( in_progress, (uint64_t)( consumed+ idxIn), pws);
+            }
+            break;
+        case    convertStop_shortInput:
+            if( isEOS!= 0)
+            {
+                //  入力の最後で文字が切れていた
+                unicodeHelper_flushBlock( pws);
+                return  0;
             }
-            //  入力が終わらなかったね
             break;
+        case    convertStop_shortOutput:
+            if( unicodeHelper_flushBlock( pws)== 0)     return  0;
+            if( unicodeHelper_notifyProgress( in_progress, (uint64_t)( consumed+ idxIn), pws)== 0)  return  0;
+            break;
+        default:
+            unicodeHelper_flushBlock( pws);
+            return  0;
         }
-        unicodeHelper_releaseBuffer( prs, (uint32_t)( prs->_indexStream+ prs->_szBuffered));
+    }
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBlock( unicodeHelperWriteBlockStream const   in_wStrm,
+                                                               unicodeHelperEncoding const           in_ecDst,
+                                                               signed int const                      in_withBOM,
+                                                               unicodeHelperReadBlockStream const    in_rStrm,
+                                                               unicodeHelperEncoding const           in_ecSrc,
+                                                               void*const                            io_arg)
+{
+    uint8_t                     bufIn[ sizeStagingBuffer];
+
+    return  unicodeHelper_convertBlock( in_wStrm, in_ecDst, in_withBOM, in_rStrm, in_ecSrc, (unicodeHelperProgress)0, io_arg,
+                                        &bufIn[ 0], 0UL, 0);
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBlockProgress( unicodeHelperWriteBlockStream const   in_wStrm,
+                                                                       unicodeHelperEncoding const           in_ecDst,
+                                                                       signed int const                      in_withBOM,
+                                                                       unicodeHelperReadBlockStream const    in_rStrm,
+                                                                       unicodeHelperEncoding const           in_ecSrc,
+                                                                       unicodeHelperProgress const           in_progress,
+                                                                       void*const                            io_arg)
+{
+    uint8_t                     bufIn[ sizeStagingBuffer];
+
+    return  unicodeHelper_convertBlock( in_wStrm, in_ecDst, in_withBOM, in_rStrm, in_ecSrc, in_progress, io_arg,
+                                        &bufIn[ 0], 0UL, 0);
+}
+
+//  エンコードの判定に使う先読みサイズ([byte])の既定値
+static size_t const             sizeDetectLookaheadDefault= 4UL* 1024UL;
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperDetectAndConvertBlock( unicodeHelperWriteBlockStream const   in_wStrm,
+                                                                        unicodeHelperEncoding const           in_ecDst,
+                                                                        signed int const                      in_withBOM,
+                                                                        unicodeHelperReadBlockStream const    in_rStrm,
+                                                                        size_t const                          in_lookahead,
+                                                                        unicodeHelperEncoding*const           out_ecSrc,
+                                                                        void*const                            io_arg)
+{
+    if( out_ecSrc!= (unicodeHelperEncoding*)0)  *out_ecSrc= unicodeHelperEncoding_unknown;
+
+    //  先読みは変換の入力用のバッファにそのまま読み込むので、その大きさまで
+    size_t                      lookahead= ( in_lookahead== 0UL)? sizeDetectLookaheadDefault: in_lookahead;
+    if( lookahead> sizeStagingBuffer)   lookahead= sizeStagingBuffer;
 
-        //  書き出し
-        if( pStore( pws, unicode)== 0)
+    uint8_t                     bufIn[ sizeStagingBuffer];
+    size_t                      szIn= 0UL;
+    signed int                  isEOS= 0;
+    while( szIn< lookahead)
+    {
+        size_t const                szRead= in_rStrm( &bufIn[ szIn], (size_t)( lookahead- szIn), io_arg);
+        if( szRead== 0UL)
         {
+            isEOS                           = -1;
             break;
         }
+        szIn                            += szRead;
     }
-    return  0;
+
+    //  一番確からしいエンコードで、先読みした分から変換する
+    unicodeHelperDetectCandidate    candidate;
+    if( unicodeHelperDetectEncoding( &candidate, 1UL, (signed int*)0, &bufIn[ 0], szIn)== 0UL)
+    {
+        return  0;
+    }
+    if( out_ecSrc!= (unicodeHelperEncoding*)0)  *out_ecSrc= candidate._encoding;
+
+    return  unicodeHelper_convertBlock( in_wStrm, in_ecDst, in_withBOM, in_rStrm, candidate._encoding, (unicodeHelperProgress)0, io_arg,
+                                        &bufIn[ 0], szIn, isEOS);
+}
+
+//  1[byte]単位の入出力関数をブロック単位で使うためのパラメータ
+typedef struct {
+    unicodeHelperReadByteStream     _rStream;
+    unicodeHelperWriteByteStream    _wStream;
+    void*                       _arg;
+    //  _rStreamが一度0を返した(以降は呼ばない)
+    signed int                  _isEOF;
+} byteStreamAdapter;
+
+//  1[byte]単位の読み込み関数でブロックを読み込む
+//  (終端の後にもう一度呼ぶとブロックするパイプなどがあるので、一度0が返ったら以降は読まない)
+static size_t   unicodeHelper_readBlockByByte( uint8_t*const    out_dst,
+                                               size_t const     in_size,
+                                               void*const       io_arg)
+{
+    byteStreamAdapter*const     pAdapter= (byteStreamAdapter*)io_arg;
+    size_t                      idx= 0UL;
+    if( pAdapter->_isEOF!= 0)   return  0UL;
+
+    for( ; idx< in_size; idx++)
+    {
+        if( pAdapter->_rStream( out_dst+ idx, pAdapter->_arg)== 0)
+        {
+            pAdapter->_isEOF                = -1;
+            break;
+        }
+    }
+    return  idx;
+}
+
+//  1[byte]単位の書き出し関数でブロックを書き出す
+static signed int   unicodeHelper_writeBlockByByte( uint8_t const*const in_src,
+                                                    size_t const        in_size,
+                                                    void*const          io_arg)
+{
+    byteStreamAdapter const*const   pAdapter= (byteStreamAdapter const*)io_arg;
+
+    for( size_t idx= 0UL; idx< in_size; idx++)
+    {
+        if( pAdapter->_wStream( in_src[ idx], pAdapter->_arg)== 0)  return  0;
+    }
+    return  -1;
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvert( unicodeHelperWriteByteStream const    in_wStrm,
+                                                          unicodeHelperEncoding const           in_ecDst,
+                                                          signed int const                      in_withBOM,
+                                                          unicodeHelperReadByteStream const     in_rStrm,
+                                                          unicodeHelperEncoding const           in_ecSrc,
+                                                          void*const                            io_arg)
+{
+    byteStreamAdapter           adapter;
+
+    adapter._rStream                = in_rStrm;
+    adapter._wStream                = in_wStrm;
+    adapter._arg                    = io_arg;
+    adapter._isEOF                  = 0;
+
+    return  unicodeHelperConvertBlock( unicodeHelper_writeBlockByByte, in_ecDst, in_withBOM,
+                                       unicodeHelper_readBlockByByte,  in_ecSrc,
+                                       &adapter);
+}
+
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperDetectAndConvert( unicodeHelperWriteByteStream const    in_wStrm,
+                                                                   unicodeHelperEncoding const           in_ecDst,
+                                                                   signed int const                      in_withBOM,
+                                                                   unicodeHelperReadByteStream const     in_rStrm,
+                                                                   size_t const                          in_lookahead,
+                                                                   unicodeHelperEncoding*const           out_ecSrc,
+                                                                   void*const                            io_arg)
+{
+    byteStreamAdapter           adapter;
+
+    adapter._rStream                = in_rStrm;
+    adapter._wStream                = in_wStrm;
+    adapter._arg                    = io_arg;
+    adapter._isEOF                  = 0;
+
+    return  unicodeHelperDetectAndConvertBlock( unicodeHelper_writeBlockByByte, in_ecDst, in_withBOM,
+                                                unicodeHelper_readBlockByByte,  in_lookahead, out_ecSrc,
+                                                &adapter);
 }
 //  End of Source [text/unicodeHelper.cpp]
@@ -3,6 +3,7 @@
 #ifndef             TEXT_UNICODE_HELPER_H___
 #define             TEXT_UNICODE_HELPER_H___
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 
@@ -15,8 +16,65 @@ typedef enum {
     unicodeHelperEncoding_utf16le   =  (3),     //  utf-16(little endian)
     unicodeHelperEncoding_utf16be   =  (4),     //  utf-16(big endian)
     unicodeHelperEncoding_cp932     =  (5),     //  cp932
+    unicodeHelperEncoding_shiftJIS  =  (6),     //  shift_jis(JIS X 0208)
+    unicodeHelperEncoding_eucJP     =  (7),     //  euc-jp(JIS X 0208と半角カナ。JIS X 0212の3[byte]文字は扱わない)
+    unicodeHelperEncoding_gbk       =  (8),     //  gbk(cp936)
+    unicodeHelperEncoding_big5      =  (9),     //  big5
+    unicodeHelperEncoding_cp949     = (10),     //  cp949(統合型ハングル)
 } unicodeHelperEncoding;
 
+/// @enum   unicodeHelperConvertFlag
+/// @brief  unicodeHelperConvertBuffer()の動作指定(論理和で複数指定)
+typedef enum {
+    unicodeHelperConvertFlag_none       =  (0x00000000),
+    unicodeHelperConvertFlag_withBOM    =  (0x00000001),    //  BOMを出力
+} unicodeHelperConvertFlag;
+
+/// @struct unicodeHelperTable
+/// @brief  unicodeHelperLoadTable()で読み込んだ変換表(中身は非公開)
+typedef struct unicodeHelperTable_  unicodeHelperTable;
+
+/// @struct unicodeHelperConverter
+/// @brief  unicodeHelperConverterCreate()で作った変換器(中身は非公開)
+typedef struct unicodeHelperConverter_  unicodeHelperConverter;
+
+/// @struct unicodeHelperConverterState
+/// @brief  unicodeHelperConverterStateCreate()で作った、分割された入力を続けて変換するための状態(中身は非公開)
+typedef struct unicodeHelperConverterState_ unicodeHelperConverterState;
+
+/// @struct unicodeHelperDetectCandidate
+/// @brief  unicodeHelperDetectEncoding()が返すエンコーディングの候補
+typedef struct {
+    unicodeHelperEncoding       _encoding;      //  エンコーディング
+    uint32_t                    _confidence;    //  確からしさ(1〜100。BOMがあれば100)
+} unicodeHelperDetectCandidate;
+
+/// @struct unicodeHelperSpan
+/// @brief  unicodeHelperConvertBatch()に渡す入力の一つ(メモリ上のbyte列)
+typedef struct {
+    uint8_t const*              _data;          //  先頭
+    size_t                      _size;          //  サイズ([byte])
+} unicodeHelperSpan;
+
+/// @struct unicodeHelperArena
+/// @brief  呼び出し側のメモリから前詰めで確保していく領域(unicodeHelperArenaResize()で使う。中身は直接触らない)
+/// @note   個別の解放は最後に確保したものだけが戻る。全部はunicodeHelperArenaReset()で一度に戻す。
+typedef struct {
+    uint8_t*                    _buffer;        //  全体の先頭
+    size_t                      _capacity;      //  全体のサイズ([byte])
+    size_t                      _used;          //  確保済みのサイズ([byte])
+    size_t                      _last;          //  最後に確保した領域の先頭の位置([byte])
+} unicodeHelperArena;
+
+/// @struct unicodeHelperPool
+/// @brief  呼び出し側のメモリを同じサイズのブロックに分けて貸す領域(unicodeHelperPoolResize()で使う。中身は直接触らない)
+typedef struct {
+    uint8_t*                    _buffer;        //  全体の先頭
+    size_t                      _blockSize;     //  ブロックのサイズ([byte])
+    size_t                      _numBlocks;     //  ブロックの数
+    void*                       _free;          //  空いているブロックのリスト(各ブロックの先頭に次を書く)
+} unicodeHelperPool;
+
 #if         defined(__cplusplus)
 #define UNICODEHELPER_EXTERN_C  extern "C"
 #else   //  defined(__cplusplus)
@@ -42,11 +100,65 @@ UNICODEHELPER_EXTERN_C typedef  signed int(*unicodeHelperReadByteStream)( uint8_
 UNICODEHELPER_EXTERN_C typedef  signed int(*unicodeHelperWriteByteStream)( uint8_t const    in_src,
                                                                            void*const       io_arg);
 
+/// @def    unicodeHelperReadBlockStream
+/// @brief  最大in_size[byte]をまとめて読み込む関数の型
+/// @param  out_dst 読み込んだデータの出力先
+/// @param  in_size out_dstのサイズ([byte])
+/// @param  io_arg  ユーザー定義のパラメータ
+/// @return 読み込んだサイズ([byte])。0は読み込み出来ない(入力の終わり)
+/// @note   in_sizeに満たなくても、読めた分だけ返せばよい
+UNICODEHELPER_EXTERN_C typedef  size_t(*unicodeHelperReadBlockStream)( uint8_t*const     out_dst,
+                                                                       size_t const      in_size,
+                                                                       void*const        io_arg);
+
+/// @def    unicodeHelperWriteBlockStream
+/// @brief  in_size[byte]をまとめて書き出す関数の型
+/// @param  in_src  出力するデータ
+/// @param  in_size in_srcのサイズ([byte])
+/// @param  io_arg  ユーザー定義のパラメータ
+/// @retval 0   出力出来ない
+/// @retval その他  全部書き出し成功
+UNICODEHELPER_EXTERN_C typedef  signed int(*unicodeHelperWriteBlockStream)( uint8_t const*const   in_src,
+                                                                            size_t const          in_size,
+                                                                            void*const            io_arg);
+
+/// @def    unicodeHelperProgress
+/// @brief  変換の途中経過を受け取る関数の型
+/// @param  in_consumed これまでに変換した入力のサイズ([byte])
+/// @param  in_written  これまでに書き出した出力のサイズ([byte])
+/// @param  io_arg  ユーザー定義のパラメータ
+/// @retval 0   変換を中断する
+/// @retval その他  続ける
+UNICODEHELPER_EXTERN_C typedef  signed int(*unicodeHelperProgress)( uint64_t const  in_consumed,
+                                                                    uint64_t const  in_written,
+                                                                    void*const      io_arg);
+
+/// @def    unicodeHelperResizeFunc
+/// @brief  出力先の領域を確保/広げる/解放する関数の型(unicodeHelperConvertAlloc()が使う)
+/// @param  io_arg  unicodeHelperAllocatorの_arg
+/// @param  in_ptr  広げる/解放する領域(0なら新しく確保)
+/// @param  in_oldSize  in_ptrの今のサイズ([byte])。中身はこのサイズまで残すこと
+/// @param  io_size 入力:欲しいサイズ([byte]。0なら解放) 出力:確保できたサイズ(欲しいサイズ以上)
+/// @return 領域(0は確保できない。その場合in_ptrはそのまま使える。解放した場合も0)
+UNICODEHELPER_EXTERN_C typedef  void*(*unicodeHelperResizeFunc)( void*const     io_arg,
+                                                                 void*const     in_ptr,
+                                                                 size_t const   in_oldSize,
+                                                                 size_t*const   io_size);
+
+/// @struct unicodeHelperAllocator
+/// @brief  unicodeHelperConvertAlloc()に渡す出力先の確保方法
+typedef struct {
+    unicodeHelperResizeFunc     _resize;        //  確保/広げる/解放する関数
+    void*                       _arg;           //  _resizeに渡すパラメータ
+} unicodeHelperAllocator;
+
 /// @fn unicodeHelperAnalyzeEncode
 /// @brief  指定の文字列のエンコードが何かを調べる
 /// @param  in_rstrm    入力用の関数
 /// @param  io_arg  入出力関数に渡すユーザーパラメータ
 /// @return エンコーディング
+/// @note   入力がメモリ上にあるなら、unicodeHelperDetectEncoding()の方が一度に調べるので速く、確からしさも分かる。
+/// 判定した後に変換するなら、unicodeHelperDetectAndConvert()で入力を読み直さずに済む。
 UNICODEHELPER_EXTERN_C unicodeHelperEncoding    unicodeHelperAnalyzeEncoding( unicodeHelperReadByteStream const in_rstrm,
                                                                               void*const                        io_arg);
 
@@ -64,6 +176,9 @@ UNICODEHELPER_EXTERN_C unicodeHelperEncoding    unicodeHelperAnalyzeEncoding( un
 /// 一回目はin_wstrmに出力サイズだけをカウントアップする関数を渡して
 /// サイズ計測。
 /// 二回目は実際に出力する関数を渡して出力っていうパターンかと。
+/// 入力がメモリ上にあるなら、サイズ計測はunicodeHelperMeasure()の方が変換しない分速い。
+/// @note   内部ではunicodeHelperConvertBlock()に1[byte]単位の入出力関数を
+/// つなぐだけなので、新規に書くならそちらを使った方が呼び出し回数が減る。
 UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvert( unicodeHelperWriteByteStream const    in_wstrm,
                                                           unicodeHelperEncoding const           in_ecDst,
                                                           signed int const                      in_withBOM,
@@ -71,5 +186,485 @@ UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvert( unicodeHelperWriteByte
                                                           unicodeHelperEncoding const           in_ecSrc,
                                                           void*const                            io_arg);
 
+/// @fn unicodeHelperConvertBlock
+/// @brief  ブロック単位の入出力関数を使ったエンコード変更
+/// @param  in_wstrm    出力用の関数
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_withBOM  BOMを出力
+/// @param  in_rstrm    入力用の関数
+/// @param  in_ecSrc    入力元エンコード
+/// @param  io_arg  入出力関数に渡すユーザーパラメータ
+/// @retval 0   全部は出力出来なかった
+/// @retval その他  全部出力出来た
+/// @note   出力は内部でためておき、大きめの単位でまとめてin_wstrmに渡す。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBlock( unicodeHelperWriteBlockStream const   in_wstrm,
+                                                               unicodeHelperEncoding const           in_ecDst,
+                                                               signed int const                      in_withBOM,
+                                                               unicodeHelperReadBlockStream const    in_rstrm,
+                                                               unicodeHelperEncoding const           in_ecSrc,
+                                                               void*const                            io_arg);
+
+/// @fn unicodeHelperConvertBlockProgress
+/// @brief  途中経過を知らせながら、ブロック単位の入出力関数を使ったエンコード変更
+/// @param  in_wstrm    出力用の関数
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_withBOM  BOMを出力
+/// @param  in_rstrm    入力用の関数
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_progress 途中経過を受け取る関数(NULLならunicodeHelperConvertBlock()と同じ)
+/// @param  io_arg  入出力関数と途中経過を受け取る関数に渡すユーザーパラメータ
+/// @retval 0   全部は出力出来なかった(in_progressが0を返して中断した場合も含む)
+/// @retval その他  全部出力出来た
+/// @note   in_progressはin_wstrmに書き出すたびと、最後に一回呼ぶ。
+/// サイズは64[bit]で数えるので、4[GiB]を超える入力でも止まったり戻ったりしない。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBlockProgress( unicodeHelperWriteBlockStream const   in_wstrm,
+                                                                       unicodeHelperEncoding const           in_ecDst,
+                                                                       signed int const                      in_withBOM,
+                                                                       unicodeHelperReadBlockStream const    in_rstrm,
+                                                                       unicodeHelperEncoding const           in_ecSrc,
+                                                                       unicodeHelperProgress const           in_progress,
+                                                                       void*const                            io_arg);
+
+/// @fn unicodeHelperDetectAndConvert
+/// @brief  入力元のエンコードを判定しながらエンコード変更(入力は一度だけ読む)
+/// @param  in_wstrm    出力用の関数
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_withBOM  BOMを出力
+/// @param  in_rstrm    入力用の関数
+/// @param  in_lookahead    判定に使う先読みサイズの上限([byte])。0なら4[KiB]、16[KiB]より大きければ16[KiB]
+/// @param  out_ecSrc   判定した入力元エンコードの格納先(不要ならNULL)。判定できなければunicodeHelperEncoding_unknown
+/// @param  io_arg  入出力関数に渡すユーザーパラメータ
+/// @retval 0   全部は出力出来なかった(判定できない場合も含む)
+/// @retval その他  全部出力出来た
+/// @note   unicodeHelperAnalyzeEncoding()の後にunicodeHelperConvert()を呼ぶと入力を二度読むことになるので、
+/// 巻き戻せない入力(パイプやソケット)ではこちらを使う。
+/// 先読みした分をunicodeHelperDetectEncoding()で判定して一番確からしいエンコードに決め、先読みした分からそのまま変換する。
+/// 先読みは入力の終わりかin_lookaheadに達するまでなので、それ以上は待たない。
+/// 先読みより後ろで判定したエンコードとして読めない所があれば、そこまで出力して0を返す。
+/// 内部ではunicodeHelperDetectAndConvertBlock()に1[byte]単位の入出力関数をつなぐだけ。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperDetectAndConvert( unicodeHelperWriteByteStream const    in_wstrm,
+                                                                   unicodeHelperEncoding const           in_ecDst,
+                                                                   signed int const                      in_withBOM,
+                                                                   unicodeHelperReadByteStream const     in_rstrm,
+                                                                   size_t const                          in_lookahead,
+                                                                   unicodeHelperEncoding*const           out_ecSrc,
+                                                                   void*const                            io_arg);
+
+/// @fn unicodeHelperDetectAndConvertBlock
+/// @brief  ブロック単位の入出力関数を使って、入力元のエンコードを判定しながらエンコード変更
+/// @param  in_wstrm    出力用の関数
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_withBOM  BOMを出力
+/// @param  in_rstrm    入力用の関数
+/// @param  in_lookahead    判定に使う先読みサイズの上限([byte])。0なら4[KiB]、16[KiB]より大きければ16[KiB]
+/// @param  out_ecSrc   判定した入力元エンコードの格納先(不要ならNULL)。判定できなければunicodeHelperEncoding_unknown
+/// @param  io_arg  入出力関数に渡すユーザーパラメータ
+/// @retval 0   全部は出力出来なかった(判定できない場合も含む)
+/// @retval その他  全部出力出来た
+/// @note   先読みは変換の入力用のバッファに直接読むので、判定した後に読み直したりコピーしたりしない。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperDetectAndConvertBlock( unicodeHelperWriteBlockStream const   in_wstrm,
+                                                                        unicodeHelperEncoding const           in_ecDst,
+                                                                        signed int const                      in_withBOM,
+                                                                        unicodeHelperReadBlockStream const    in_rstrm,
+                                                                        size_t const                          in_lookahead,
+                                                                        unicodeHelperEncoding*const           out_ecSrc,
+                                                                        void*const                            io_arg);
+
+/// @fn unicodeHelperConvertBuffer
+/// @brief  メモリ上のデータのエンコード変更
+/// @param  out_dst     出力先
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  out_consumed    入力元から読み込んだサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @retval 0   全部は出力出来なかった(不正な入力、入力の最後で文字が切れている、出力先が足りない)
+/// @retval その他  全部出力出来た
+/// @note   unicodeHelperConvert()と違い、一文字ごとにユーザー定義の関数を呼ばない。
+/// 失敗した場合も*out_consumed/*out_writtenには変換できたところまでが入るので、
+/// 出力先を広げて続きから呼び直すことが出来る(その場合入力のBOMはもう無い)。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertBuffer( uint8_t*const                   out_dst,
+                                                                size_t const                    in_dstCap,
+                                                                size_t*const                    out_written,
+                                                                uint8_t const*const             in_src,
+                                                                size_t const                    in_srcLen,
+                                                                size_t*const                    out_consumed,
+                                                                unicodeHelperEncoding const     in_ecDst,
+                                                                unicodeHelperEncoding const     in_ecSrc,
+                                                                uint32_t const                  in_flags);
+
+/// @fn unicodeHelperConverterCreate
+/// @brief  エンコーディングの組み合わせごとの変換関数を一度だけ選んでおく変換器を作る
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @return 変換器(0は変換できない組み合わせか、出力先エンコードにBOMが無いのにBOMの出力を指定した)
+/// @note   作った後は中身を変えないので、一つの変換器で複数のスレッドから同時に
+/// unicodeHelperConverterRun()を呼んでよい。
+/// 短い文字列を大量に変換する場合、unicodeHelperConvertBuffer()が呼び出しごとに
+/// 関数を選び直す分を省ける。
+UNICODEHELPER_EXTERN_C unicodeHelperConverter const*    unicodeHelperConverterCreate( unicodeHelperEncoding const   in_ecDst,
+                                                                                      unicodeHelperEncoding const   in_ecSrc,
+                                                                                      uint32_t const                in_flags);
+
+/// @fn unicodeHelperConverterDestroy
+/// @brief  unicodeHelperConverterCreate()で作った変換器を解放
+/// @param  in_converter    解放する変換器(0なら何もしない)
+/// @note   変換中の他のスレッドがあれば、終わってから呼ぶこと。
+UNICODEHELPER_EXTERN_C void     unicodeHelperConverterDestroy( unicodeHelperConverter const*const  in_converter);
+
+/// @fn unicodeHelperConverterRun
+/// @brief  変換器でメモリ上のデータのエンコード変更
+/// @param  in_converter    unicodeHelperConverterCreate()で作った変換器
+/// @param  out_dst     出力先
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  out_consumed    入力元から読み込んだサイズ([byte])の格納先(不要ならNULL)
+/// @retval 0   全部は出力出来なかった(不正な入力、入力の最後で文字が切れている、出力先が足りない)
+/// @retval その他  全部出力出来た
+/// @note   結果はunicodeHelperConvertBuffer()に同じエンコードとフラグを渡した場合と同じ。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRun( unicodeHelperConverter const*const  in_converter,
+                                                               uint8_t*const                       out_dst,
+                                                               size_t const                        in_dstCap,
+                                                               size_t*const                        out_written,
+                                                               uint8_t const*const                 in_src,
+                                                               size_t const                        in_srcLen,
+                                                               size_t*const                        out_consumed);
+
+/// @fn unicodeHelperConverterRunBatch
+/// @brief  変換器で複数の入力を、一つの出力先に続けてエンコード変更
+/// @param  in_converter    unicodeHelperConverterCreate()で作った変換器
+/// @param  out_dst     出力先(全部の入力の出力を順に詰める)
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_offsets 各入力の出力の位置の格納先(in_num+ 1個。i番目の出力はout_dst[ out_offsets[ i]]からout_dst[ out_offsets[ i+ 1]]の手前まで)
+/// @param  out_results 各入力の成否の格納先(in_num個。不要ならNULL。値はunicodeHelperConverterRun()の戻り値と同じ)
+/// @param  in_srcs     入力の並び
+/// @param  in_num      入力の数
+/// @return 出力し終えた入力の数(out_offsetsは戻り値+ 1個、out_resultsは戻り値の個数だけ入る)
+/// @note   入力ごとの結果はunicodeHelperConverterRun()と同じ(入力ごとにBOMをスキップし、指定があればBOMを出力する)。
+/// 不正な入力は変換できたところまでを出力し、その入力の成否を0にして次の入力に進む。
+/// 出力先が足りなくなった入力は出力を取り消してそこで止めるので、戻り値がin_numより小さければ
+/// in_srcs+ 戻り値から別の出力先で呼び直す(一つも出力できなければ出力先を広げる)。
+/// 変換関数の選択は変換器を作った時に済んでいて、各入力の出力は前の入力の出力に続けて書くので、
+/// 短い入力が大量にある場合にunicodeHelperConverterRun()を繰り返すより呼び出しと準備の分速い。
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperConverterRunBatch( unicodeHelperConverter const*const  in_converter,
+                                                                uint8_t*const                       out_dst,
+                                                                size_t const                        in_dstCap,
+                                                                size_t*const                        out_offsets,
+                                                                signed int*const                    out_results,
+                                                                unicodeHelperSpan const*const       in_srcs,
+                                                                size_t const                        in_num);
+
+/// @fn unicodeHelperConvertBatch
+/// @brief  複数の入力を、一つの出力先に続けてエンコード変更
+/// @param  out_dst     出力先(全部の入力の出力を順に詰める)
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_offsets 各入力の出力の位置の格納先(in_num+ 1個)
+/// @param  out_results 各入力の成否の格納先(in_num個。不要ならNULL)
+/// @param  in_srcs     入力の並び
+/// @param  in_num      入力の数
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @return 出力し終えた入力の数(変換できない組み合わせは0)
+/// @note   結果はunicodeHelperConverterRunBatch()に同じエンコードとフラグで作った変換器を渡した場合と同じ。
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperConvertBatch( uint8_t*const                   out_dst,
+                                                           size_t const                    in_dstCap,
+                                                           size_t*const                    out_offsets,
+                                                           signed int*const                out_results,
+                                                           unicodeHelperSpan const*const   in_srcs,
+                                                           size_t const                    in_num,
+                                                           unicodeHelperEncoding const     in_ecDst,
+                                                           unicodeHelperEncoding const     in_ecSrc,
+                                                           uint32_t const                  in_flags);
+
+/// @fn unicodeHelperConverterRunAlloc
+/// @brief  変換器でメモリ上のデータのエンコード変更(出力先はin_allocatorで確保し、足りなければ広げる)
+/// @param  in_converter    unicodeHelperConverterCreate()で作った変換器
+/// @param  in_allocator    出力先の確保方法
+/// @param  out_dst     出力先の格納先(確保できなかった場合は0)
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @retval 0   全部は出力出来なかった(不正な入力、入力の最後で文字が切れている、出力先が確保できない)
+/// @retval その他  全部出力出来た
+/// @note   出力先は入力のサイズ程度から始めて倍々で広げ(unicodeHelperBoundSize()の上限は超えない)、
+/// 最後に出力したサイズまで縮める。出力先を数えるために一度変換する必要が無い。
+/// 不正な入力の場合も変換できたところまでが*out_dstに入るので、使い終わったらin_allocatorで解放する。
+/// 確保できなかった場合は途中まで確保した分も解放し、*out_dstは0になる。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRunAlloc( unicodeHelperConverter const*const  in_converter,
+                                                                    unicodeHelperAllocator const*const  in_allocator,
+                                                                    uint8_t**const                      out_dst,
+                                                                    size_t*const                        out_written,
+                                                                    uint8_t const*const                 in_src,
+                                                                    size_t const                        in_srcLen);
+
+/// @fn unicodeHelperConvertAlloc
+/// @brief  メモリ上のデータのエンコード変更(出力先はin_allocatorで確保し、足りなければ広げる)
+/// @param  in_allocator    出力先の確保方法
+/// @param  out_dst     出力先の格納先(確保できなかった場合は0)
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @retval 0   全部は出力出来なかった
+/// @retval その他  全部出力出来た
+/// @note   結果はunicodeHelperConverterRunAlloc()に同じエンコードとフラグで作った変換器を渡した場合と同じ。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConvertAlloc( unicodeHelperAllocator const*const  in_allocator,
+                                                               uint8_t**const                      out_dst,
+                                                               size_t*const                        out_written,
+                                                               uint8_t const*const                 in_src,
+                                                               size_t const                        in_srcLen,
+                                                               unicodeHelperEncoding const         in_ecDst,
+                                                               unicodeHelperEncoding const         in_ecSrc,
+                                                               uint32_t const                      in_flags);
+
+/// @fn unicodeHelperHeapResize
+/// @brief  malloc()/realloc()/free()で出力先を確保するunicodeHelperResizeFunc(io_argは使わない)
+UNICODEHELPER_EXTERN_C void*    unicodeHelperHeapResize( void*const     io_arg,
+                                                         void*const     in_ptr,
+                                                         size_t const   in_oldSize,
+                                                         size_t*const   io_size);
+
+/// @fn unicodeHelperArenaInit
+/// @brief  呼び出し側のメモリを前詰めで確保する領域として初期化
+/// @param  out_arena   初期化する領域
+/// @param  in_buffer   使うメモリ(unicodeHelperArenaを使い終わるまで残しておくこと)
+/// @param  in_capacity in_bufferのサイズ([byte])
+UNICODEHELPER_EXTERN_C void     unicodeHelperArenaInit( unicodeHelperArena*const    out_arena,
+                                                        void*const                  in_buffer,
+                                                        size_t const                in_capacity);
+
+/// @fn unicodeHelperArenaReset
+/// @brief  領域から確保したものを全部一度に戻す
+/// @param  io_arena    戻す領域
+UNICODEHELPER_EXTERN_C void     unicodeHelperArenaReset( unicodeHelperArena*const   io_arena);
+
+/// @fn unicodeHelperArenaResize
+/// @brief  unicodeHelperArenaから出力先を確保するunicodeHelperResizeFunc(io_argはunicodeHelperArena*)
+/// @note   最後に確保した領域はその場で広げ/縮めるので、unicodeHelperConvertAlloc()が広げても中身を写さない
+/// (使わなかった分は最後に縮めて戻る)。それ以外の領域を広げる場合は後ろに確保し直して中身を写す
+/// (元の領域はunicodeHelperArenaReset()まで戻らない)。
+/// 確保する領域の先頭は16[byte]境界に揃える。
+UNICODEHELPER_EXTERN_C void*    unicodeHelperArenaResize( void*const    io_arg,
+                                                          void*const    in_ptr,
+                                                          size_t const  in_oldSize,
+                                                          size_t*const  io_size);
+
+/// @fn unicodeHelperPoolInit
+/// @brief  呼び出し側のメモリを同じサイズのブロックに分けて貸す領域として初期化
+/// @param  out_pool    初期化する領域
+/// @param  in_buffer   使うメモリ(in_blockSize* in_numBlocks[byte]以上。unicodeHelperPoolを使い終わるまで残しておくこと)
+/// @param  in_blockSize    ブロックのサイズ([byte]。ポインタのサイズの倍数で、ポインタのサイズ以上)
+/// @param  in_numBlocks    ブロックの数
+UNICODEHELPER_EXTERN_C void     unicodeHelperPoolInit( unicodeHelperPool*const  out_pool,
+                                                       void*const               in_buffer,
+                                                       size_t const             in_blockSize,
+                                                       size_t const             in_numBlocks);
+
+/// @fn unicodeHelperPoolResize
+/// @brief  unicodeHelperPoolのブロックを出力先にするunicodeHelperResizeFunc(io_argはunicodeHelperPool*)
+/// @note   いつもブロック一つを渡すので、ブロックのサイズを超えて広げることは出来ない(変換は失敗する)。
+/// unicodeHelperConvertAlloc()は最初に入力のサイズ+ 16[byte]程度(unicodeHelperBoundSize()の方が小さければそれ)を欲しがるので、
+/// ブロックのサイズはそれ以上にしておくこと。
+UNICODEHELPER_EXTERN_C void*    unicodeHelperPoolResize( void*const     io_arg,
+                                                         void*const     in_ptr,
+                                                         size_t const   in_oldSize,
+                                                         size_t*const   io_size);
+
+/// @fn unicodeHelperConverterMeasure
+/// @brief  変換器で変換した場合の出力サイズを、変換せずに数える
+/// @param  in_converter    unicodeHelperConverterCreate()で作った変換器
+/// @param  out_size    出力サイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @retval 0   全部は変換出来ない
+/// @retval その他  全部変換出来る
+/// @note   結果はunicodeHelperMeasure()に同じエンコードとフラグを渡した場合と同じ。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterMeasure( unicodeHelperConverter const*const  in_converter,
+                                                                   size_t*const                        out_size,
+                                                                   uint8_t const*const                 in_src,
+                                                                   size_t const                        in_srcLen);
+
+/// @fn unicodeHelperConverterRunParallel
+/// @brief  変換器でメモリ上のデータのエンコード変更(入力を分けて複数のスレッドで変換)
+/// @param  in_converter    unicodeHelperConverterCreate()で作った変換器
+/// @param  out_dst     出力先
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  out_consumed    入力元から読み込んだサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_numThreads   使うスレッドの数(呼び出したスレッドを含む。0なら実行中のcpuのコア数)
+/// @retval 0   全部は出力出来なかった(不正な入力、入力の最後で文字が切れている、出力先が足りない)
+/// @retval その他  全部出力出来た
+/// @note   入力を1[MiB]ずつ文字の切れ目で分けて変換し、出力サイズを順に足した位置へつなげる。
+/// スレッドは呼び出しごとに一度だけ作り、各スレッドが分けたかたまりを順に取って変換しては出力先へ写す。
+/// 文字の切れ目は、utf-8は継続byteを、utf-16は下位サロゲートを飛ばし、
+/// 表で引くコードページは直前に続く先頭byteになりうるbyteの数で決める。
+/// 結果(失敗した場合の止まった位置も含む)はunicodeHelperConverterRun()と同じ。
+/// 入力が小さい場合は一つのスレッドで変換する。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterRunParallel( unicodeHelperConverter const*const  in_converter,
+                                                                       uint8_t*const                       out_dst,
+                                                                       size_t const                        in_dstCap,
+                                                                       size_t*const                        out_written,
+                                                                       uint8_t const*const                 in_src,
+                                                                       size_t const                        in_srcLen,
+                                                                       size_t*const                        out_consumed,
+                                                                       uint32_t const                      in_numThreads);
+
+/// @fn unicodeHelperConverterStateCreate
+/// @brief  分割して届く入力を順に変換するための状態を作る
+/// @param  in_converter    使う変換器(状態を解放するまで解放しないこと)
+/// @return 状態(0はin_converterが0か、メモリが足りない)
+/// @note   変換器は複数の状態で共有できる。状態の方は一つの入力の流れ専用で、
+/// 複数のスレッドから同時に使ってはいけない。
+UNICODEHELPER_EXTERN_C unicodeHelperConverterState*     unicodeHelperConverterStateCreate( unicodeHelperConverter const*const  in_converter);
+
+/// @fn unicodeHelperConverterStateDestroy
+/// @brief  unicodeHelperConverterStateCreate()で作った状態を解放
+/// @param  in_state    解放する状態(0なら何もしない)
+UNICODEHELPER_EXTERN_C void     unicodeHelperConverterStateDestroy( unicodeHelperConverterState*const   in_state);
+
+/// @fn unicodeHelperConverterStateFeed
+/// @brief  分割された入力の続きを変換
+/// @param  io_state    状態
+/// @param  out_dst     出力先
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元(前回までの続き)
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  out_consumed    入力元から読み込んだサイズ([byte])の格納先(不要ならNULL)
+/// @retval 0   不正な入力か、出力先のエンコードに無い文字があった(以降はunicodeHelperConverterStateFinish()まで失敗する)
+/// @retval その他  成功
+/// @note   入力の最後で切れている文字(utf-8の途中、サロゲートの片割れ、2[byte]文字の先頭byte)は
+/// 状態に取っておき、次の呼び出しの入力と合わせて変換するので、入力をためておく必要は無い。
+/// 成功しても*out_consumedがin_srcLenに満たなければ出力先が足りないので、
+/// 出力先を空けて残りの入力を渡し直すこと。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterStateFeed( unicodeHelperConverterState*const   io_state,
+                                                                     uint8_t*const                       out_dst,
+                                                                     size_t const                        in_dstCap,
+                                                                     size_t*const                        out_written,
+                                                                     uint8_t const*const                 in_src,
+                                                                     size_t const                        in_srcLen,
+                                                                     size_t*const                        out_consumed);
+
+/// @fn unicodeHelperConverterStateFinish
+/// @brief  入力の終わりを伝え、状態を作った直後に戻す
+/// @param  io_state    状態
+/// @param  out_dst     出力先(まだ出力していないBOMがあれば出力する)
+/// @param  in_dstCap   出力先のサイズ([byte])
+/// @param  out_written 出力したサイズ([byte])の格納先(不要ならNULL)
+/// @retval 0   途中で失敗していたか、入力の最後で文字が切れていた
+/// @retval その他  全部出力出来た
+/// @note   BOMを出力する出力先が足りない場合だけは状態を戻さないので、出力先を空けて呼び直す。
+/// 戻した後の状態は、次の入力の流れにそのまま使える。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperConverterStateFinish( unicodeHelperConverterState*const io_state,
+                                                                       uint8_t*const                     out_dst,
+                                                                       size_t const                      in_dstCap,
+                                                                       size_t*const                      out_written);
+
+/// @fn unicodeHelperMeasure
+/// @brief  メモリ上のデータをエンコード変更した場合の出力サイズを、変換せずに数える
+/// @param  out_size    出力サイズ([byte])の格納先(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @retval 0   全部は変換出来ない(不正な入力、入力の最後で文字が切れている、出力先のエンコードに無い文字)
+/// @retval その他  全部変換出来る
+/// @note   *out_sizeは、unicodeHelperConvertBuffer()に十分な出力先を渡した場合の*out_writtenと同じ
+/// (失敗する場合は止まる所までのサイズ)なので、そのまま出力先の確保に使える。
+/// utf-8とutf-16の間は検証してから継続byteやサロゲートの数をまとめて数え、それ以外は一文字ずつ数える。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperMeasure( size_t*const                  out_size,
+                                                          uint8_t const*const           in_src,
+                                                          size_t const                  in_srcLen,
+                                                          unicodeHelperEncoding const   in_ecDst,
+                                                          unicodeHelperEncoding const   in_ecSrc,
+                                                          uint32_t const                in_flags);
+
+/// @fn unicodeHelperBoundSize
+/// @brief  メモリ上のデータをエンコード変更した場合の出力サイズの上限を、入力を見ずに求める
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @return 出力サイズの上限([byte])。変換できない組み合わせ(BOMの無い出力先エンコードへのBOMの出力指定も含む)は0
+/// @note   unicodeHelperMeasure()と違い入力を読まないので、出力先を一度で確保して
+/// そのままunicodeHelperConvertBuffer()を呼ぶ場合に使う(utf-16からutf-8は入力の1.5倍、utf-8からutf-16は2倍、
+/// コードページからutf-8は3倍まで)。
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperBoundSize( size_t const                    in_srcLen,
+                                                        unicodeHelperEncoding const     in_ecDst,
+                                                        unicodeHelperEncoding const     in_ecSrc,
+                                                        uint32_t const                  in_flags);
+
+/// @fn unicodeHelperValidate
+/// @brief  メモリ上のデータが指定エンコードとして正しいかの検証
+/// @param  in_encoding 入力元エンコード
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  out_errorOffset 最初に不正な文字の位置([byte])の格納先(不要ならNULL)。全部正しければin_srcLenが入る
+/// @retval 0   不正な文字がある(最後で文字が切れている場合も含む)
+/// @retval その他  全部正しい
+/// @note   utf-8は冗長な表現、サロゲート、U+10FFFFより大きいものを不正とする。
+/// utf-16は対になっていないサロゲートを不正とする。
+/// 変換はしないので、unicodeHelperConvertBuffer()に捨てる出力先を渡すより速い。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperValidate( unicodeHelperEncoding const     in_encoding,
+                                                           uint8_t const*const             in_src,
+                                                           size_t const                    in_srcLen,
+                                                           size_t*const                    out_errorOffset);
+
+/// @fn unicodeHelperDetectEncoding
+/// @brief  メモリ上のデータのエンコードを推定し、確からしい順に候補を返す
+/// @param  out_candidates  候補の出力先
+/// @param  in_candidateCap out_candidatesの要素数
+/// @param  out_isASCII     0x80以上と0x00が無ければ0以外(不要ならNULL)
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @return out_candidatesに書いた候補の数(0は当てはまるものが無い)
+/// @note   候補はutf-8、utf-16le、utf-16be、cp932。BOMがあればそのエンコードだけを返す。
+/// 0x00や2[byte]先と同じbyteの偶数奇数の偏り、0x80以上や制御文字の数を一度に数え、残った候補だけを検証する。
+/// 入力の最後で文字が切れているだけなら、ファイルの先頭だけを渡した場合を考えて正しいとみなす。
+/// ASCIIだけの入力は、utf-8、cp932の順に返す。
+UNICODEHELPER_EXTERN_C size_t   unicodeHelperDetectEncoding( unicodeHelperDetectCandidate*const  out_candidates,
+                                                             size_t const                        in_candidateCap,
+                                                             signed int*const                    out_isASCII,
+                                                             uint8_t const*const                 in_src,
+                                                             size_t const                        in_srcLen);
+
+/// @fn unicodeHelperLoadTable
+/// @brief  convunicodeorgが出力した表のファイルを読み込み専用でmapする
+/// @param  in_path 表のファイル(.uht)のパス
+/// @return 読み込んだ表(0は読み込み出来ない)
+/// @note   中身は解析せずにmapしたまま引くので、大きな表でも読み込みはすぐ終わる。
+/// 版、バイトオーダー、サイズ、各表の位置と行の番号が合わないファイルは読み込まない。
+/// mmap()の無い環境では常に0を返す。
+UNICODEHELPER_EXTERN_C unicodeHelperTable const*    unicodeHelperLoadTable( char const*const   in_path);
+
+/// @fn unicodeHelperUnloadTable
+/// @brief  unicodeHelperLoadTable()で読み込んだ表を解放
+/// @param  in_table    解放する表(0なら何もしない)
+/// @note   結び付けたままなら組み込みの表に戻す。変換中の他のスレッドがあれば、終わってから呼ぶこと。
+UNICODEHELPER_EXTERN_C void     unicodeHelperUnloadTable( unicodeHelperTable const*const   in_table);
+
+/// @fn unicodeHelperBindTable
+/// @brief  読み込んだ表をエンコードに結び付け、以降の変換で組み込みの表の代わりに使う
+/// @param  in_encoding 結び付けるエンコード(cp932、shift_jis、euc-jp、gbk、big5、cp949)
+/// @param  in_table    使う表(0なら組み込みの表に戻す)
+/// @retval 0   表を差し替えられないエンコードか、表が別のエンコード用
+/// (表の名前はconvunicodeorgに渡したラベルで、cp932、shiftjis、eucjp、gbk、big5、cp949のうちin_encodingのものであること)
+/// @retval その他  結び付けた
+/// @note   組み込みの表をビルドから外して(UNICODE_HELPER_USE_CP932=OFFなど)も、結び付ければ変換できる。
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperBindTable( unicodeHelperEncoding const     in_encoding,
+                                                            unicodeHelperTable const*const  in_table);
+
 #endif  //  ndef    TEXT_UNICODE_HELPER_H___
 //  End of Source [text/unicodeHelper.h]
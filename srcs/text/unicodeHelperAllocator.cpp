@@ -0,0 +1,122 @@
+/// @file   text/unicodeHelperAllocator.cpp
+/// @brief  unicodeHelperConvertAlloc()に渡す出力先の確保方法(malloc()、前詰めの領域、同じサイズのブロック)
+#include "unicodeHelper.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//  前詰めの領域で確保する領域の先頭の境界([byte])
+static size_t const             arenaAlign= 16;
+
+UNICODEHELPER_EXTERN_C void*    unicodeHelperHeapResize( void*const     /*  io_arg */,
+                                                         void*const     in_ptr,
+                                                         size_t const   /*  in_oldSize */,
+                                                         size_t*const   io_size)
+{
+    if( *io_size== 0UL)
+    {
+        free( in_ptr);
+        return  (void*)0;
+    }
+    return  realloc( in_ptr, *io_size);
+}
+
+UNICODEHELPER_EXTERN_C void     unicodeHelperArenaInit( unicodeHelperArena*const    out_arena,
+                                                        void*const                  in_buffer,
+                                                        size_t const                in_capacity)
+{
+    out_arena->_buffer              = (uint8_t*)in_buffer;
+    out_arena->_capacity            = in_capacity;
+    out_arena->_used                = 0UL;
+    out_arena->_last                = 0UL;
+}
+
+UNICODEHELPER_EXTERN_C void     unicodeHelperArenaReset( unicodeHelperArena*const   io_arena)
+{
+    io_arena->_used                 = 0UL;
+    io_arena->_last                 = 0UL;
+}
+
+UNICODEHELPER_EXTERN_C void*    unicodeHelperArenaResize( void*const    io_arg,
+                                                          void*const    in_ptr,
+                                                          size_t const  in_oldSize,
+                                                          size_t*const  io_size)
+{
+    unicodeHelperArena*const    pArena= (unicodeHelperArena*)io_arg;
+    size_t const                size= *io_size;
+    bool const                  isLast= ( in_ptr!= (void*)0&& (uint8_t*)in_ptr== pArena->_buffer+ pArena->_last);
+
+    //  最後に確保した領域はその場で広げ/縮める(解放なら戻す)
+    if( isLast!= false)
+    {
+        if( size> (size_t)( pArena->_capacity- pArena->_last))  return  (void*)0;
+        pArena->_used                   = (size_t)( pArena->_last+ size);
+        return  ( size== 0UL)? (void*)0: in_ptr;
+    }
+    //  それ以外の解放は何もしない(unicodeHelperArenaReset()で戻る)
+    if( size== 0UL)     return  (void*)0;
+
+    //  後ろに確保(広げる場合は中身を写す)
+    uintptr_t const             addrTop= (uintptr_t)( pArena->_buffer+ pArena->_used);
+    size_t const                top= (size_t)( pArena->_used+ (size_t)( (uintptr_t)( arenaAlign- addrTop% arenaAlign)% arenaAlign));
+    if( top> pArena->_capacity
+        || size> (size_t)( pArena->_capacity- top))
+    {
+        return  (void*)0;
+    }
+    uint8_t*const               pDst= pArena->_buffer+ top;
+    if( in_ptr!= (void*)0)  memcpy( pDst, in_ptr, ( in_oldSize< size)? in_oldSize: size);
+    pArena->_last                   = top;
+    pArena->_used                   = (size_t)( top+ size);
+    return  pDst;
+}
+
+UNICODEHELPER_EXTERN_C void     unicodeHelperPoolInit( unicodeHelperPool*const  out_pool,
+                                                       void*const               in_buffer,
+                                                       size_t const             in_blockSize,
+                                                       size_t const             in_numBlocks)
+{
+    out_pool->_buffer               = (uint8_t*)in_buffer;
+    out_pool->_blockSize            = in_blockSize;
+    out_pool->_numBlocks            = in_numBlocks;
+    out_pool->_free                 = (void*)0;
+
+    //  後ろのブロックからリストに積んで、前のブロックから貸す
+    for( size_t i= in_numBlocks; i> 0UL; i--)
+    {
+        void*const                  pBlock= out_pool->_buffer+ (size_t)( i- 1UL)* in_blockSize;
+        memcpy( pBlock, &out_pool->_free, sizeof(void*));
+        out_pool->_free                 = pBlock;
+    }
+}
+
+UNICODEHELPER_EXTERN_C void*    unicodeHelperPoolResize( void*const     io_arg,
+                                                         void*const     in_ptr,
+                                                         size_t const   /*  in_oldSize */,
+                                                         size_t*const   io_size)
+{
+    unicodeHelperPool*const     pPool= (unicodeHelperPool*)io_arg;
+
+    //  解放はリストに戻す
+    if( *io_size== 0UL)
+    {
+        if( in_ptr!= (void*)0)
+        {
+            memcpy( in_ptr, &pPool->_free, sizeof(void*));
+            pPool->_free                    = in_ptr;
+        }
+        return  (void*)0;
+    }
+    if( *io_size> pPool->_blockSize)    return  (void*)0;
+
+    //  ブロックに収まるならそのまま使う
+    *io_size                        = pPool->_blockSize;
+    if( in_ptr!= (void*)0)  return  in_ptr;
+    if( pPool->_free== (void*)0)    return  (void*)0;
+
+    void*const                  pBlock= pPool->_free;
+    memcpy( &pPool->_free, pBlock, sizeof(void*));
+    return  pBlock;
+}
+
+//  End of Source [text/unicodeHelperAllocator.cpp]
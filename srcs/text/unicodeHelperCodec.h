@@ -0,0 +1,431 @@
+/// @file   text/unicodeHelperCodec.h
+/// @brief  メモリ上の一文字単位のデコード/エンコード
+/// @note   decode系の戻り値は次のとおり
+/// - 1以上 : 読み込んだサイズ([byte])
+/// - 0     : 入力が途中で切れている(続きがあれば読めるかもしれない)
+/// - -1    : 不正なシーケンス
+/// encode系はout_dstに最大4[byte]書き込み、書き込んだサイズ([byte])を返す。
+/// 0はその文字を出力できないことを示す。
+#ifndef             TEXT_UNICODE_HELPER_CODEC_H___
+#define             TEXT_UNICODE_HELPER_CODEC_H___
+
+#include "unicodeHelper.h"
+#include <stddef.h>
+#include <string.h>
+
+/// @enum   unicodeHelperByteOrder
+/// @brief  utf-16のバイトオーダー
+typedef enum {
+    unicodeHelperByteOrder_arch     =  (0),     //  実行中のcpuに添ったエンディアン
+    unicodeHelperByteOrder_le       =  (1),     //  little endian
+    unicodeHelperByteOrder_be       =  (2),     //  big endian
+} unicodeHelperByteOrder;
+
+/// @struct unicodeHelperRun
+/// @brief  連続したコードの区間(区間の先頭のコード順に並べて二分探索する)
+typedef struct {
+    uint16_t                    _source;        //  区間の先頭のコード
+    uint16_t                    _length;        //  区間の長さ(unicodeHelperRunLinearが立っていれば対応先も連続)
+    uint16_t                    _value;         //  対応先も連続なら先頭の対応先、そうでなければ対応先の並びの位置
+} unicodeHelperRun;
+
+//  対応先も連続している区間の印
+static uint16_t const           unicodeHelperRunLinear= 0x8000U;
+
+/// @struct unicodeHelperCodepageView
+/// @brief  表で引くコードページの表(unicodeHelper_codepageView()で得る)
+/// @note   二段の表(_c2ucRow、_uc2cRow)が0でなければそれを直接引き、0なら区間の表を二分探索で引く。
+typedef struct {
+    uint8_t const*              _trail;         //  先頭byteごとに続くbyte数(256要素)
+    uint8_t const*              _c2ucRow;       //  コード->unicodeの行の番号(256要素)
+    uint16_t const*             _c2ucTable;     //  コード->unicodeの表(行数* 256要素)
+    uint8_t const*              _uc2cRow;       //  unicode->コードの行の番号(256要素)
+    uint16_t const*             _uc2cTable;     //  unicode->コードの表(行数* 256要素)
+    unicodeHelperRun const*     _c2ucRun;       //  コード->unicodeの区間
+    uint32_t                    _numC2ucRun;
+    uint16_t const*             _c2ucRunDest;   //  対応先が連続でない区間の対応先の並び
+    unicodeHelperRun const*     _uc2cRun;       //  unicode->コードの区間
+    uint32_t                    _numUc2cRun;
+    uint16_t const*             _uc2cRunDest;
+} unicodeHelperCodepageView;
+
+/// @fn unicodeHelper_cp932ToUnicode
+/// @brief  cp932のコードをunicodeに変換
+/// @param  in_cp932    cp932のコード(1[byte]文字は上位8[bit]が0)
+/// @return unicode(0は対応する文字が無い。ただしin_cp932が0の時は0を返す)
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_cp932ToUnicode( uint16_t const in_cp932);
+
+/// @fn unicodeHelper_unicodeToCP932
+/// @brief  unicodeをcp932のコードに変換
+/// @param  in_unicode  unicode(BMPのみ)
+/// @return cp932のコード(0は対応する文字が無い。ただしin_unicodeが0の時は0を返す)
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_unicodeToCP932( uint16_t const in_unicode);
+
+/// @fn unicodeHelper_codepageView
+/// @brief  表で引くコードページの、今使っている表を得る
+/// @param  in_encoding コードページ
+/// @return 表(0は表で引くコードページではない)
+/// @note   unicodeHelperBindTable()で結び付けた表なら、その表をunicodeHelperFreeTable()するまで使える。
+/// 変換の間に表を結び付け直しても、得た表はそのまま。文字ごとに得ずに、変換の始めに一度得て使い回すこと。
+UNICODEHELPER_EXTERN_C unicodeHelperCodepageView const* unicodeHelper_codepageView( unicodeHelperEncoding const in_encoding);
+
+/// @fn unicodeHelper_codepageToUnicode
+/// @brief  表で引くコードページ(cp932、shift_jis、euc-jp、gbk、big5、cp949)のコードをunicodeに変換
+/// @param  in_encoding コードページ
+/// @param  in_code     コード(1[byte]文字は上位8[bit]が0)
+/// @return unicode(0は対応する文字が無いか、表で引くコードページではない)
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_codepageToUnicode( unicodeHelperEncoding const   in_encoding,
+                                                                 uint16_t const                in_code);
+
+/// @fn unicodeHelper_unicodeToCodepage
+/// @brief  unicodeを表で引くコードページのコードに変換
+/// @param  in_encoding コードページ
+/// @param  in_unicode  unicode(BMPのみ)
+/// @return コード(0は対応する文字が無いか、表で引くコードページではない)
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_unicodeToCodepage( unicodeHelperEncoding const   in_encoding,
+                                                                 uint16_t const                in_unicode);
+
+//  utf-8の先頭byteから、その文字のサイズ([byte])を得る(0は先頭byteとして不正)
+static inline uint32_t  unicodeHelper_sizeUTF8( uint8_t const in_uc1st)
+{
+    if( in_uc1st< 0x80U)    return  1UL;
+    if( in_uc1st< 0xc2U)    return  0UL;    //  継続byteか冗長な2[byte]表現
+    if( in_uc1st< 0xe0U)    return  2UL;
+    if( in_uc1st< 0xf0U)    return  3UL;
+    if( in_uc1st< 0xf5U)    return  4UL;
+    return  0UL;
+}
+
+//  utf-8で一文字デコード
+static inline signed int    unicodeHelper_decodeUTF8( uint32_t*const        out_unicode,
+                                                      uint8_t const*const   in_src,
+                                                      size_t const          in_size)
+{
+    if( in_size== 0)    return  0;
+
+    uint8_t const               uc1st= in_src[ 0];
+    if( uc1st< 0x80U)
+    {
+        *out_unicode                    = (uint32_t)uc1st;
+        return  1;
+    }
+
+    uint32_t const              sz= unicodeHelper_sizeUTF8( uc1st);
+    if( sz== 0UL)   return  -1;
+
+    //  2[byte]目は冗長表現とサロゲートと0x10ffff超えを弾くため範囲が狭い
+    uint8_t                     lo2nd= 0x80U;
+    uint8_t                     hi2nd= 0xbfU;
+    switch( uc1st)
+    {
+    case    0xe0U:  lo2nd                           = 0xa0U;    break;
+    case    0xedU:  hi2nd                           = 0x9fU;    break;
+    case    0xf0U:  lo2nd                           = 0x90U;    break;
+    case    0xf4U:  hi2nd                           = 0x8fU;    break;
+    }
+
+    if( in_size>= 2)
+    {
+        uint8_t const               uc2nd= in_src[ 1];
+        if( uc2nd< lo2nd|| uc2nd> hi2nd)    return  -1;
+    }
+    for( uint32_t i= 2UL; i< sz&& i< in_size; i++)
+    {
+        if( (uint8_t)( in_src[ i]& 0xc0U)!= 0x80U)  return  -1;
+    }
+    if( in_size< sz)    return  0;
+
+    switch( sz)
+    {
+    case    2UL:
+        *out_unicode                    = (uint32_t)( (uint32_t)( (uint32_t)( uc1st& 0x1fU)<< 6)
+                                                      | (uint32_t)( in_src[ 1]& 0x3fU));
+        break;
+    case    3UL:
+        *out_unicode                    = (uint32_t)( (uint32_t)( (uint32_t)( uc1st& 0x0fU)<< 12)
+                                                      | (uint32_t)( (uint32_t)( in_src[ 1]& 0x3fU)<< 6)
+                                                      | (uint32_t)( in_src[ 2]& 0x3fU));
+        break;
+    default:
+        *out_unicode                    = (uint32_t)( (uint32_t)( (uint32_t)( uc1st& 0x07U)<< 18)
+                                                      | (uint32_t)( (uint32_t)( in_src[ 1]& 0x3fU)<< 12)
+                                                      | (uint32_t)( (uint32_t)( in_src[ 2]& 0x3fU)<< 6)
+                                                      | (uint32_t)( in_src[ 3]& 0x3fU));
+        break;
+    }
+    return  (signed int)sz;
+}
+
+//  utf-8で一文字エンコード
+static inline signed int    unicodeHelper_encodeUTF8( uint8_t*const     out_dst,
+                                                      uint32_t const    in_unicode)
+{
+    if( in_unicode< 0x00000080UL)
+    {
+        out_dst[ 0]                     = (uint8_t)in_unicode;
+        return  1;
+    } else if( in_unicode< 0x00000800UL)
+    {
+        out_dst[ 0]                     = (uint8_t)( (uint8_t)( in_unicode>> 6)| 0xc0U);
+        out_dst[ 1]                     = (uint8_t)( (uint8_t)( in_unicode& 0x3fUL)| 0x80U);
+        return  2;
+    } else if( in_unicode< 0x00010000UL)
+    {
+        out_dst[ 0]                     = (uint8_t)( (uint8_t)( in_unicode>> 12)| 0xe0U);
+        out_dst[ 1]                     = (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>> 6)& 0x3fUL)| 0x80U);
+        out_dst[ 2]                     = (uint8_t)( (uint8_t)( in_unicode& 0x3fUL)| 0x80U);
+        return  3;
+    } else if( in_unicode< 0x00110000UL)
+    {
+        out_dst[ 0]                     = (uint8_t)( (uint8_t)( in_unicode>> 18)| 0xf0U);
+        out_dst[ 1]                     = (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>> 12)& 0x3fUL)| 0x80U);
+        out_dst[ 2]                     = (uint8_t)( (uint8_t)( (uint32_t)( in_unicode>> 6)& 0x3fUL)| 0x80U);
+        out_dst[ 3]                     = (uint8_t)( (uint8_t)( in_unicode& 0x3fUL)| 0x80U);
+        return  4;
+    }
+    return  0;
+}
+
+//  指定のバイトオーダーでuint16_tを読み込む
+static inline uint16_t  unicodeHelper_peekWord( uint8_t const*const             in_src,
+                                                unicodeHelperByteOrder const    in_order)
+{
+    switch( in_order)
+    {
+    case    unicodeHelperByteOrder_le:
+        return  (uint16_t)( (uint16_t)( (uint16_t)in_src[ 1]<< 8)| (uint16_t)in_src[ 0]);
+    case    unicodeHelperByteOrder_be:
+        return  (uint16_t)( (uint16_t)( (uint16_t)in_src[ 0]<< 8)| (uint16_t)in_src[ 1]);
+    default:
+        {
+            uint16_t                    result;
+            memcpy( &result, in_src, sizeof(result));
+            return  result;
+        }
+    }
+}
+
+//  指定のバイトオーダーでuint16_tを書き込む
+static inline void  unicodeHelper_pokeWord( uint8_t*const                   out_dst,
+                                            uint16_t const                  in_word,
+                                            unicodeHelperByteOrder const    in_order)
+{
+    switch( in_order)
+    {
+    case    unicodeHelperByteOrder_le:
+        out_dst[ 0]                     = (uint8_t)( in_word& 0x00ffU);
+        out_dst[ 1]                     = (uint8_t)( in_word>> 8);
+        break;
+    case    unicodeHelperByteOrder_be:
+        out_dst[ 0]                     = (uint8_t)( in_word>> 8);
+        out_dst[ 1]                     = (uint8_t)( in_word& 0x00ffU);
+        break;
+    default:
+        memcpy( out_dst, &in_word, sizeof(in_word));
+        break;
+    }
+}
+
+//  utf-16で一文字デコード
+static inline signed int    unicodeHelper_decodeUTF16( uint32_t*const               out_unicode,
+                                                       uint8_t const*const          in_src,
+                                                       size_t const                 in_size,
+                                                       unicodeHelperByteOrder const in_order)
+{
+    if( in_size< 2)     return  0;
+
+    uint16_t const              uw1st= unicodeHelper_peekWord( in_src, in_order);
+    if( (uint16_t)( uw1st& 0xf800U)!= 0xd800U)
+    {
+        *out_unicode                    = (uint32_t)uw1st;
+        return  2;
+    }
+    //  ペアになっていないサロゲートは不正
+    if( (uint16_t)( uw1st& 0xfc00U)!= 0xd800U)  return  -1;
+    if( in_size< 4)     return  0;
+
+    uint16_t const              uw2nd= unicodeHelper_peekWord( in_src+ 2, in_order);
+    if( (uint16_t)( uw2nd& 0xfc00U)!= 0xdc00U)  return  -1;
+
+    *out_unicode                    = (uint32_t)( (uint32_t)( (uint32_t)( (uint16_t)( uw1st& 0x03ffU)+ 0x0040U)<< 10)
+                                                  | (uint32_t)( uw2nd& 0x03ffU));
+    return  4;
+}
+
+//  utf-16で一文字エンコード
+static inline signed int    unicodeHelper_encodeUTF16( uint8_t*const                out_dst,
+                                                       uint32_t const               in_unicode,
+                                                       unicodeHelperByteOrder const in_order)
+{
+    if( in_unicode< 0x00010000UL)
+    {
+        unicodeHelper_pokeWord( out_dst, (uint16_t)in_unicode, in_order);
+        return  2;
+    } else if( in_unicode< 0x00110000UL)
+    {
+        uint32_t const              ofs= (uint32_t)( in_unicode- 0x00010000UL);
+        unicodeHelper_pokeWord( out_dst,     (uint16_t)( (uint16_t)( ofs>> 10)| 0xd800U), in_order);
+        unicodeHelper_pokeWord( out_dst+ 2,  (uint16_t)( (uint16_t)( ofs& 0x03ffUL)| 0xdc00U), in_order);
+        return  4;
+    }
+    return  0;
+}
+
+//  utf-16arch形式で一文字デコード
+static inline signed int    unicodeHelper_decodeUTF16Arch( uint32_t*const       out_unicode,
+                                                           uint8_t const*const  in_src,
+                                                           size_t const         in_size)
+{
+    return  unicodeHelper_decodeUTF16( out_unicode, in_src, in_size, unicodeHelperByteOrder_arch);
+}
+
+//  utf-16le形式で一文字デコード
+static inline signed int    unicodeHelper_decodeUTF16LE( uint32_t*const         out_unicode,
+                                                         uint8_t const*const    in_src,
+                                                         size_t const           in_size)
+{
+    return  unicodeHelper_decodeUTF16( out_unicode, in_src, in_size, unicodeHelperByteOrder_le);
+}
+
+//  utf-16be形式で一文字デコード
+static inline signed int    unicodeHelper_decodeUTF16BE( uint32_t*const         out_unicode,
+                                                         uint8_t const*const    in_src,
+                                                         size_t const           in_size)
+{
+    return  unicodeHelper_decodeUTF16( out_unicode, in_src, in_size, unicodeHelperByteOrder_be);
+}
+
+//  utf-16arch形式で一文字エンコード
+static inline signed int    unicodeHelper_encodeUTF16Arch( uint8_t*const    out_dst,
+                                                           uint32_t const   in_unicode)
+{
+    return  unicodeHelper_encodeUTF16( out_dst, in_unicode, unicodeHelperByteOrder_arch);
+}
+
+//  utf-16le形式で一文字エンコード
+static inline signed int    unicodeHelper_encodeUTF16LE( uint8_t*const      out_dst,
+                                                         uint32_t const     in_unicode)
+{
+    return  unicodeHelper_encodeUTF16( out_dst, in_unicode, unicodeHelperByteOrder_le);
+}
+
+//  utf-16be形式で一文字エンコード
+static inline signed int    unicodeHelper_encodeUTF16BE( uint8_t*const      out_dst,
+                                                         uint32_t const     in_unicode)
+{
+    return  unicodeHelper_encodeUTF16( out_dst, in_unicode, unicodeHelperByteOrder_be);
+}
+
+//  上位byteで行を、下位byteで列を引く(対応が無ければ0)
+static inline uint16_t  unicodeHelper_lookupDirect( uint8_t const*const     in_row,
+                                                    uint16_t const*const    in_table,
+                                                    uint16_t const          in_source)
+{
+    return  in_table[ ( (uint32_t)in_row[ in_source>> 8]<< 8)+ (uint32_t)( in_source& 0x00ffU)];
+}
+
+//  in_sourceを含む区間を二分探索で探して引く(対応が無ければ0)
+static inline uint16_t  unicodeHelper_lookupRun( unicodeHelperRun const*const   in_run,
+                                                 uint32_t const                 in_num,
+                                                 uint16_t const*const           in_dest,
+                                                 uint16_t const                 in_source)
+{
+    if( in_num== 0UL)   return  0U;
+
+    //  先頭のコードがin_source以下の最後の区間を探す(分岐予測が外れないよう条件付き代入で絞る)
+    unicodeHelperRun const*     pRun= in_run;
+    uint32_t                    numCur= in_num;
+    while( numCur> 1UL)
+    {
+        uint32_t const              half= (uint32_t)( numCur>> 1);
+        pRun                            = ( pRun[ half]._source<= in_source)? pRun+ half: pRun;
+        numCur                          = (uint32_t)( numCur- half);
+    }
+    if( pRun->_source> in_source)   return  0U;
+
+    uint16_t const              ofs= (uint16_t)( in_source- pRun->_source);
+    if( ofs>= (uint16_t)( pRun->_length& (uint16_t)~unicodeHelperRunLinear))  return  0U;
+
+    if( ( pRun->_length& unicodeHelperRunLinear)!= 0U)
+    {
+        return  (uint16_t)( pRun->_value+ ofs);
+    }
+    return  in_dest[ (uint32_t)pRun->_value+ ofs];
+}
+
+//  表でコードをunicodeに変換(0は対応する文字が無い)
+static inline uint16_t  unicodeHelper_viewToUnicode( unicodeHelperCodepageView const*const  in_view,
+                                                     uint16_t const                         in_code)
+{
+    if( in_view->_c2ucRow!= 0)  return  unicodeHelper_lookupDirect( in_view->_c2ucRow, in_view->_c2ucTable, in_code);
+    return  unicodeHelper_lookupRun( in_view->_c2ucRun, in_view->_numC2ucRun, in_view->_c2ucRunDest, in_code);
+}
+
+//  表でunicodeをコードに変換(0は対応する文字が無い)
+static inline uint16_t  unicodeHelper_viewToCode( unicodeHelperCodepageView const*const in_view,
+                                                  uint16_t const                        in_unicode)
+{
+    if( in_view->_uc2cRow!= 0)  return  unicodeHelper_lookupDirect( in_view->_uc2cRow, in_view->_uc2cTable, in_unicode);
+    return  unicodeHelper_lookupRun( in_view->_uc2cRun, in_view->_numUc2cRun, in_view->_uc2cRunDest, in_unicode);
+}
+
+//  表で引くコードページの先頭byteから、その文字のサイズ([byte])を得る
+static inline uint32_t  unicodeHelper_sizeCodepageView( unicodeHelperCodepageView const*const   in_view,
+                                                        uint8_t const                           in_uc1st)
+{
+    return  (uint32_t)( in_view->_trail[ in_uc1st]+ 1U);
+}
+
+//  表で引くコードページで一文字デコード
+//  先頭byteに続くbyte数を表で引いてコードを組み立てるので、コードページごとの分岐は無い
+static inline signed int    unicodeHelper_decodeCodepageView( uint32_t*const                            out_unicode,
+                                                              uint8_t const*const                       in_src,
+                                                              size_t const                              in_size,
+                                                              unicodeHelperCodepageView const*const     in_view)
+{
+    if( in_size== 0)    return  0;
+
+    uint8_t const               uc1st= in_src[ 0];
+    if( uc1st== 0U)
+    {
+        *out_unicode                    = 0UL;
+        return  1;
+    }
+
+    size_t const                sz= (size_t)unicodeHelper_sizeCodepageView( in_view, uc1st);
+    if( in_size< sz)    return  0;
+
+    uint16_t const              code= ( sz== 1)? (uint16_t)uc1st: (uint16_t)( (uint16_t)( (uint16_t)uc1st<< 8)| (uint16_t)in_src[ 1]);
+    uint16_t const              unicode= unicodeHelper_viewToUnicode( in_view, code);
+    if( unicode== 0U)   return  -1;
+
+    *out_unicode                    = (uint32_t)unicode;
+    return  (signed int)sz;
+}
+
+//  表で引くコードページで一文字エンコード
+static inline signed int    unicodeHelper_encodeCodepageView( uint8_t*const                             out_dst,
+                                                              uint32_t const                            in_unicode,
+                                                              unicodeHelperCodepageView const*const     in_view)
+{
+    if( in_unicode== 0UL)
+    {
+        out_dst[ 0]                     = 0U;
+        return  1;
+    }
+    if( in_unicode>= 0x00010000UL)  return  0;
+
+    uint16_t const              code= unicodeHelper_viewToCode( in_view, (uint16_t)in_unicode);
+    if( code== 0U)  return  0;
+    if( code& 0xff00U)
+    {
+        out_dst[ 0]                     = (uint8_t)( code>> 8);
+        out_dst[ 1]                     = (uint8_t)( code& 0x00ffU);
+        return  2;
+    }
+    out_dst[ 0]                     = (uint8_t)code;
+    return  1;
+}
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_CODEC_H___
+//  End of Source [text/unicodeHelperCodec.h]
@@ -0,0 +1,179 @@
+/// @file   text/unicodeHelperCodepage.cpp
+/// @brief  表で引くコードページの組み込みの表と、表の差し替え
+#include "unicodeHelper.h"
+#include "unicodeHelperCodec.h"
+#include "unicodeHelperCodepage.h"
+#include "unicodeHelperInternal.h"
+#include <string.h>
+
+#if         defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+#define UNICODE_HELPER_TABLE_RUN    1
+#else   //  defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+#define UNICODE_HELPER_TABLE_DIRECT 1
+#endif  //  defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+
+#if         defined(UNICODE_HELPER_USE_CP932)
+#include "cp932.inc"
+#endif  //  defined(UNICODE_HELPER_USE_CP932)
+#if         defined(UNICODE_HELPER_USE_SHIFT_JIS)
+#include "shiftjis.inc"
+#endif  //  defined(UNICODE_HELPER_USE_SHIFT_JIS)
+#if         defined(UNICODE_HELPER_USE_EUC_JP)
+#include "eucjp.inc"
+#endif  //  defined(UNICODE_HELPER_USE_EUC_JP)
+#if         defined(UNICODE_HELPER_USE_GBK)
+#include "gbk.inc"
+#endif  //  defined(UNICODE_HELPER_USE_GBK)
+#if         defined(UNICODE_HELPER_USE_BIG5)
+#include "big5.inc"
+#endif  //  defined(UNICODE_HELPER_USE_BIG5)
+#if         defined(UNICODE_HELPER_USE_CP949)
+#include "cp949.inc"
+#endif  //  defined(UNICODE_HELPER_USE_CP949)
+
+//  組み込みの表をビルドから外したコードページ用(すべて1[byte]の文字で、対応する文字は無い)
+static uint8_t const            gEmptyTrail[ 256]= { 0U};
+
+#if         defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+
+#define UNICODE_HELPER_CODEPAGE_TABLE( in_label)                                     \
+    { &in_label##_trail[ 0],                                                        \
+      0, 0, 0, 0,                                                                   \
+      &in_label##_c2ucRun[ 0],                                                      \
+      (uint32_t)( sizeof(in_label##_c2ucRun)/ sizeof(in_label##_c2ucRun[0])),       \
+      &in_label##_c2ucRunDest[ 0],                                                  \
+      &in_label##_uc2cRun[ 0],                                                      \
+      (uint32_t)( sizeof(in_label##_uc2cRun)/ sizeof(in_label##_uc2cRun[0])),       \
+      &in_label##_uc2cRunDest[ 0]}
+
+#else   //  defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+
+#define UNICODE_HELPER_CODEPAGE_TABLE( in_label)                                     \
+    { &in_label##_trail[ 0],                                                        \
+      &in_label##_c2ucRow[ 0],                                                      \
+      &in_label##_c2ucTable[ 0],                                                    \
+      &in_label##_uc2cRow[ 0],                                                      \
+      &in_label##_uc2cTable[ 0],                                                    \
+      0, 0UL, 0, 0, 0UL, 0}
+
+#endif  //  defined(UNICODE_HELPER_CODEPAGE_TABLE_COMPACT)
+
+//  二段の表も区間も無いので、何も対応しない
+#define UNICODE_HELPER_CODEPAGE_EMPTY   { &gEmptyTrail[ 0], 0, 0, 0, 0, 0, 0UL, 0, 0, 0UL, 0}
+
+//  codepageIndexの並びの組み込みの表
+unicodeHelperCodepageView const gCodepageTable[ codepage_num]= {
+#if         defined(UNICODE_HELPER_USE_CP932)
+    UNICODE_HELPER_CODEPAGE_TABLE( cp932),
+#else   //  defined(UNICODE_HELPER_USE_CP932)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_CP932)
+#if         defined(UNICODE_HELPER_USE_SHIFT_JIS)
+    UNICODE_HELPER_CODEPAGE_TABLE( shiftjis),
+#else   //  defined(UNICODE_HELPER_USE_SHIFT_JIS)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_SHIFT_JIS)
+#if         defined(UNICODE_HELPER_USE_EUC_JP)
+    UNICODE_HELPER_CODEPAGE_TABLE( eucjp),
+#else   //  defined(UNICODE_HELPER_USE_EUC_JP)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_EUC_JP)
+#if         defined(UNICODE_HELPER_USE_GBK)
+    UNICODE_HELPER_CODEPAGE_TABLE( gbk),
+#else   //  defined(UNICODE_HELPER_USE_GBK)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_GBK)
+#if         defined(UNICODE_HELPER_USE_BIG5)
+    UNICODE_HELPER_CODEPAGE_TABLE( big5),
+#else   //  defined(UNICODE_HELPER_USE_BIG5)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_BIG5)
+#if         defined(UNICODE_HELPER_USE_CP949)
+    UNICODE_HELPER_CODEPAGE_TABLE( cp949),
+#else   //  defined(UNICODE_HELPER_USE_CP949)
+    UNICODE_HELPER_CODEPAGE_EMPTY,
+#endif  //  defined(UNICODE_HELPER_USE_CP949)
+};
+
+#undef  UNICODE_HELPER_CODEPAGE_TABLE
+#undef  UNICODE_HELPER_CODEPAGE_EMPTY
+
+//  codepageIndexの並びの結び付けた表(静的領域なので最初は0)
+std::atomic<unicodeHelperTable const*>  gCodepageBound[ codepage_num];
+
+//  codepageIndexの並びの表の名前(CMakeLists.txtでconvunicodeorgに渡すラベル。表のファイルの先頭に入る)
+static char const*const         gCodepageName[ codepage_num]= {
+    "cp932",
+    "shiftjis",
+    "eucjp",
+    "gbk",
+    "big5",
+    "cp949",
+};
+
+//  表で引くコードページの、今使っている表を得る
+UNICODEHELPER_EXTERN_C unicodeHelperCodepageView const* unicodeHelper_codepageView( unicodeHelperEncoding const in_encoding)
+{
+    codepageIndex               cp;
+    if( unicodeHelper_codepageIndex( &cp, in_encoding)== 0) return  0;
+
+    return  unicodeHelper_codepageViewAt( cp);
+}
+
+//  cp932のコードをunicodeに変換
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_cp932ToUnicode( uint16_t const in_cp932)
+{
+    return  unicodeHelper_codepageToUnicodeAt( codepage_cp932, in_cp932);
+}
+
+//  unicodeをcp932のコードに変換
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_unicodeToCP932( uint16_t const in_unicode)
+{
+    return  unicodeHelper_unicodeToCodepageAt( codepage_cp932, in_unicode);
+}
+
+//  表で引くコードページのコードをunicodeに変換
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_codepageToUnicode( unicodeHelperEncoding const   in_encoding,
+                                                                 uint16_t const                in_code)
+{
+    codepageIndex               cp;
+    if( unicodeHelper_codepageIndex( &cp, in_encoding)== 0) return  0U;
+
+    return  unicodeHelper_codepageToUnicodeAt( cp, in_code);
+}
+
+//  unicodeを表で引くコードページのコードに変換
+UNICODEHELPER_EXTERN_C uint16_t unicodeHelper_unicodeToCodepage( unicodeHelperEncoding const   in_encoding,
+                                                                 uint16_t const                in_unicode)
+{
+    codepageIndex               cp;
+    if( unicodeHelper_codepageIndex( &cp, in_encoding)== 0) return  0U;
+
+    return  unicodeHelper_unicodeToCodepageAt( cp, in_unicode);
+}
+
+//  読み込んだ表をエンコードに結び付ける
+UNICODEHELPER_EXTERN_C signed int   unicodeHelperBindTable( unicodeHelperEncoding const     in_encoding,
+                                                            unicodeHelperTable const*const  in_table)
+{
+    codepageIndex               cp;
+    if( unicodeHelper_codepageIndex( &cp, in_encoding)== 0) return  0;
+
+    //  別のエンコード用に作った表を結び付けると、以降の変換が黙って違う文字になる
+    if( in_table!= 0&& strcmp( in_table->name, gCodepageName[ cp])!= 0)  return  0;
+
+    gCodepageBound[ cp].store( in_table, std::memory_order_release);
+    return  -1;
+}
+
+//  表を解放する前に、結び付けたままなら組み込みの表に戻す
+void    unicodeHelper_unbindTable( unicodeHelperTable const*const  in_table)
+{
+    for( uint32_t idx= 0UL; idx< (uint32_t)codepage_num; idx++)
+    {
+        unicodeHelperTable const*   pExpected= in_table;
+        gCodepageBound[ idx].compare_exchange_strong( pExpected, 0, std::memory_order_acq_rel);
+    }
+}
+
+//  End of Source [text/unicodeHelperCodepage.cpp]
@@ -0,0 +1,103 @@
+/// @file   text/unicodeHelperCodepage.h
+/// @brief  表で引くコードページ(1[byte]と2[byte]の文字が混ざるもの)の一文字単位のデコード/エンコード(ライブラリ内部用)
+/// @note   戻り値の決まりはunicodeHelperCodec.hと同じ
+#ifndef             TEXT_UNICODE_HELPER_CODEPAGE_H___
+#define             TEXT_UNICODE_HELPER_CODEPAGE_H___
+
+#include "unicodeHelper.h"
+#include "unicodeHelperCodec.h"
+#include "unicodeHelperTable.h"
+#include "text/unicodeHelperConfig.h"
+#include <stddef.h>
+#include <atomic>
+
+//  表で引くコードページの並び
+typedef enum {
+    codepage_cp932              = (0),
+    codepage_shiftJIS           = (1),
+    codepage_eucJP              = (2),
+    codepage_gbk                = (3),
+    codepage_big5               = (4),
+    codepage_cp949              = (5),
+    codepage_num                = (6),
+} codepageIndex;
+
+//  コードページの組み込みの表(convunicodeorgが出力したもの)
+//  持ち方はUNICODE_HELPER_CODEPAGE_TABLE_PROFILEで選ぶ(Speed:二段の表を直接引く Compact:区間の二分探索)
+//  使わない方の表は0にしておく
+//  組み込みの表(ビルドから外したものは何も対応しない表)
+extern unicodeHelperCodepageView const          gCodepageTable[ codepage_num];
+
+//  unicodeHelperBindTable()で結び付けた表(0なら組み込みの表を使う)
+extern std::atomic<unicodeHelperTable const*>   gCodepageBound[ codepage_num];
+
+//  エンコードから表で引くコードページの並びの位置を得る(表で引くものでなければ0を返す)
+static inline signed int    unicodeHelper_codepageIndex( codepageIndex*const           out_cp,
+                                                         unicodeHelperEncoding const    in_encoding)
+{
+    switch( in_encoding)
+    {
+    case    unicodeHelperEncoding_cp932:    *out_cp= codepage_cp932;    return  -1;
+    case    unicodeHelperEncoding_shiftJIS: *out_cp= codepage_shiftJIS; return  -1;
+    case    unicodeHelperEncoding_eucJP:    *out_cp= codepage_eucJP;    return  -1;
+    case    unicodeHelperEncoding_gbk:      *out_cp= codepage_gbk;      return  -1;
+    case    unicodeHelperEncoding_big5:     *out_cp= codepage_big5;     return  -1;
+    case    unicodeHelperEncoding_cp949:    *out_cp= codepage_cp949;    return  -1;
+    default:                                break;
+    }
+    return  0;
+}
+
+//  今使っている表を得る(結び付けた表があればそれ、無ければ組み込みの表)
+static inline unicodeHelperCodepageView const*  unicodeHelper_codepageViewAt( codepageIndex const   in_cp)
+{
+    unicodeHelperTable const*const  pBound= gCodepageBound[ in_cp].load( std::memory_order_acquire);
+    return  ( pBound!= 0)? &pBound->view: &gCodepageTable[ in_cp];
+}
+
+//  コードページのコードをunicodeに変換(0は対応する文字が無い)
+static inline uint16_t  unicodeHelper_codepageToUnicodeAt( codepageIndex const  in_cp,
+                                                           uint16_t const       in_code)
+{
+    return  unicodeHelper_viewToUnicode( unicodeHelper_codepageViewAt( in_cp), in_code);
+}
+
+//  unicodeをコードページのコードに変換(0は対応する文字が無い)
+static inline uint16_t  unicodeHelper_unicodeToCodepageAt( codepageIndex const  in_cp,
+                                                           uint16_t const       in_unicode)
+{
+    return  unicodeHelper_viewToCode( unicodeHelper_codepageViewAt( in_cp), in_unicode);
+}
+
+//  先頭byteごとに続くbyte数の表(256要素)を得る
+static inline uint8_t const*    unicodeHelper_codepageTrail( codepageIndex const    in_cp)
+{
+    return  unicodeHelper_codepageViewAt( in_cp)->_trail;
+}
+
+//  先頭byteから、その文字のサイズ([byte])を得る
+static inline uint32_t  unicodeHelper_sizeCodepage( codepageIndex const in_cp,
+                                                    uint8_t const       in_uc1st)
+{
+    return  unicodeHelper_sizeCodepageView( unicodeHelper_codepageViewAt( in_cp), in_uc1st);
+}
+
+//  コードページで一文字デコード
+template< codepageIndex in_cp>
+static inline signed int    unicodeHelper_decodeCodepage( uint32_t*const        out_unicode,
+                                                          uint8_t const*const   in_src,
+                                                          size_t const          in_size)
+{
+    return  unicodeHelper_decodeCodepageView( out_unicode, in_src, in_size, unicodeHelper_codepageViewAt( in_cp));
+}
+
+//  コードページで一文字エンコード
+template< codepageIndex in_cp>
+static inline signed int    unicodeHelper_encodeCodepage( uint8_t*const     out_dst,
+                                                          uint32_t const    in_unicode)
+{
+    return  unicodeHelper_encodeCodepageView( out_dst, in_unicode, unicodeHelper_codepageViewAt( in_cp));
+}
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_CODEPAGE_H___
+//  End of Source [text/unicodeHelperCodepage.h]
@@ -0,0 +1,68 @@
+/// @file   text/unicodeHelperInternal.h
+/// @brief  unicodeHelperのライブラリ内部でだけ共有する宣言
+#ifndef             TEXT_UNICODE_HELPER_INTERNAL_H___
+#define             TEXT_UNICODE_HELPER_INTERNAL_H___
+
+#include "unicodeHelper.h"
+
+//  メモリ上の変換が止まった理由
+typedef enum {
+    convertStop_complete        = (0),  //  入力を全部変換した
+    convertStop_shortInput      = (1),  //  入力の最後で文字が切れている
+    convertStop_shortOutput     = (2),  //  出力先が足りない
+    convertStop_invalid         = (3),  //  不正な入力か、出力先のエンコードに無い文字
+} convertStop;
+
+//  メモリ上で変換する関数の型
+typedef convertStop(*convertBufferFunc)( uint8_t*const           /*  出力先 */,
+                                         size_t const            /*  出力先のサイズ([byte]) */,
+                                         size_t*const            /*  入力:書き込み開始ofs 出力:書き込み後のofs */,
+                                         uint8_t const*const     /*  入力元 */,
+                                         size_t const            /*  入力元のサイズ([byte]) */,
+                                         size_t*const            /*  入力:読み込み開始ofs 出力:読み込み後のofs */);
+
+//  ベクトル命令(が使えなければまとめて処理するスカラー版)の変換関数へのポインタ取得
+//  専用の関数が無い組み合わせは0を返すので、一文字単位の汎用版を使う
+convertBufferFunc   unicodeHelper_simdGetConvertBufferFunc( unicodeHelperEncoding const  in_ecDst,
+                                                            unicodeHelperEncoding const  in_ecSrc);
+
+//  メモリ上のデータを検証する関数の型
+//  最初に不正な文字の位置([byte])を返す(全部正しければ入力元のサイズ)
+typedef size_t(*validateFunc)( uint8_t const*const  /*  入力元 */,
+                               size_t const         /*  入力元のサイズ([byte]) */);
+
+//  ベクトル命令(が使えなければまとめて処理するスカラー版)の検証関数へのポインタ取得
+//  専用の関数が無いエンコーディングは0を返すので、一文字単位の汎用版を使う
+validateFunc    unicodeHelper_simdGetValidateFunc( unicodeHelperEncoding const in_encoding);
+
+//  メモリ上のデータを変換した場合の出力サイズを数える関数の型
+//  変換できる入力のサイズ([byte])を返し(全部変換できれば入力元のサイズ)、そこまでの出力サイズ([byte])を格納する
+typedef size_t(*measureFunc)( size_t*const          /*  出力サイズ([byte])の格納先 */,
+                              uint8_t const*const   /*  入力元 */,
+                              size_t const          /*  入力元のサイズ([byte]) */);
+
+//  ベクトル命令(が使えなければまとめて処理するスカラー版)の出力サイズを数える関数へのポインタ取得
+//  専用の関数が無い組み合わせは0を返すので、一文字単位の汎用版を使う
+measureFunc unicodeHelper_simdGetMeasureFunc( unicodeHelperEncoding const  in_ecDst,
+                                              unicodeHelperEncoding const  in_ecSrc);
+
+//  エンコーディング判定用に数えたbyteの種類ごとの個数
+typedef struct {
+    size_t                      _zeroEven;      //  偶数番目(先頭から0,2,4...)の0x00
+    size_t                      _zeroOdd;       //  奇数番目の0x00
+    size_t                      _high;          //  0x80以上
+    size_t                      _control;       //  0x00、\t\n\v\f\r、ESC以外の0x1f以下
+    size_t                      _repeatEven;    //  偶数番目で2[byte]先と同じbyte
+    size_t                      _repeatOdd;     //  奇数番目で2[byte]先と同じbyte
+} byteHistogram;
+
+//  ベクトル命令(が使えなければスカラー版)でbyteの種類ごとの個数を一度に数える
+void    unicodeHelper_simdByteHistogram( byteHistogram*const   out_histogram,
+                                         uint8_t const*const   in_src,
+                                         size_t const          in_srcLen);
+
+//  in_tableがどれかのエンコードに結び付いていれば外す(unicodeHelperUnloadTable()用)
+void    unicodeHelper_unbindTable( unicodeHelperTable const*const  in_table);
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_INTERNAL_H___
+//  End of Source [text/unicodeHelperInternal.h]
@@ -0,0 +1,1652 @@
+/// @file   text/unicodeHelperSimd.cpp
+/// @brief  まとめて処理する変換カーネル(x86ではSSE4.1/AVX2、それ以外はスカラー版)
+#include "unicodeHelper.h"
+#include "unicodeHelperCodec.h"
+#include "unicodeHelperInternal.h"
+#include "text/unicodeHelperConfig.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if         defined(UNICODE_HELPER_USE_SIMD) && ( defined(__GNUC__) || defined(__clang__)) && ( defined(__x86_64__) || defined(__i386__))
+#define UNICODE_HELPER_SIMD_X86     1
+#include <immintrin.h>
+#endif  //  defined(UNICODE_HELPER_USE_SIMD) && ...
+
+#if         defined(UNICODE_HELPER_SIMD_X86)
+//  使用する命令セット
+typedef enum {
+    simdLevel_none              = (0),  //  スカラー版
+    simdLevel_sse41             = (1),  //  SSE4.1
+    simdLevel_avx2              = (2),  //  AVX2
+} simdLevel;
+
+//  実行中のcpuで使える命令セットを調べる
+//  環境変数UNICODE_HELPER_SIMD(none/sse41/avx2)で上限を指定できる(計測と確認用)
+static simdLevel    unicodeHelper_detectSimdLevel( void)
+{
+    simdLevel                   level= simdLevel_none;
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "sse4.1"))  level= simdLevel_sse41;
+    if( __builtin_cpu_supports( "avx2"))    level= simdLevel_avx2;
+
+    char const*const            pLimit= getenv( "UNICODE_HELPER_SIMD");
+    if( pLimit!= (char const*)0)
+    {
+        if( strcmp( pLimit, "none")== 0)                            level= simdLevel_none;
+        if( strcmp( pLimit, "sse41")== 0&& level> simdLevel_sse41)  level= simdLevel_sse41;
+    }
+    return  level;
+}
+
+//  使用する命令セット(最初の呼び出しで一度だけ調べる)
+static simdLevel    unicodeHelper_simdLevel( void)
+{
+    static simdLevel const      level= unicodeHelper_detectSimdLevel();
+    return  level;
+}
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+
+//  utf-8からutf-16へ一文字ずつ変換(まとめて処理できない所の後始末用)
+//  in_untilに達するか、変換が止まるまで進める
+template< unicodeHelperByteOrder in_order>
+static convertStop  unicodeHelper_utf8ToUTF16Step( uint8_t*const        out_dst,
+                                                   size_t const         in_dstCap,
+                                                   size_t*const         io_written,
+                                                   uint8_t const*const  in_src,
+                                                   size_t const         in_srcLen,
+                                                   size_t*const         io_consumed,
+                                                   size_t const         in_until)
+{
+    size_t                      idxDst= *io_written;
+    size_t                      idxSrc= *io_consumed;
+    convertStop                 result= convertStop_complete;
+
+    while( idxSrc< in_until)
+    {
+        uint32_t                    unicode;
+        signed int const            szIn= unicodeHelper_decodeUTF8( &unicode, in_src+ idxSrc, (size_t)( in_srcLen- idxSrc));
+        if( szIn<= 0)
+        {
+            result                          = ( szIn== 0)? convertStop_shortInput: convertStop_invalid;
+            break;
+        }
+        size_t const                szOut= ( unicode< 0x00010000UL)? 2UL: 4UL;
+        if( (size_t)( in_dstCap- idxDst)< szOut)
+        {
+            result                          = convertStop_shortOutput;
+            break;
+        }
+        unicodeHelper_encodeUTF16( out_dst+ idxDst, unicode, in_order);
+        idxDst                          += szOut;
+        idxSrc                          += (size_t)szIn;
+    }
+
+    *io_written                     = idxDst;
+    *io_consumed                    = idxSrc;
+    return  result;
+}
+
+//  utf-8からutf-16へ変換(スカラー版。ASCIIは8[byte]ずつまとめて判定)
+template< unicodeHelperByteOrder in_order>
+static convertStop  unicodeHelper_utf8ToUTF16Scalar( uint8_t*const         out_dst,
+                                                     size_t const           in_dstCap,
+                                                     size_t*const           io_written,
+                                                     uint8_t const*const    in_src,
+                                                     size_t const           in_srcLen,
+                                                     size_t*const           io_consumed)
+{
+    static uint64_t const       maskNonASCII= 0x8080808080808080ULL;
+
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 8UL
+               && (size_t)( in_dstCap- idxDst)>= 16UL)
+        {
+            uint64_t                    word;
+            memcpy( &word, in_src+ idxSrc, sizeof(word));
+            if( ( word& maskNonASCII)!= 0ULL)   break;
+
+            for( size_t i= 0UL; i< 8UL; i++)
+            {
+                unicodeHelper_pokeWord( out_dst+ idxDst+ i* 2UL, (uint16_t)in_src[ idxSrc+ i], in_order);
+            }
+            idxSrc                          += 8UL;
+            idxDst                          += 16UL;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ASCII以外を含む8[byte]は一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 8UL)? (size_t)( idxSrc+ 8UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf8ToUTF16Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+//  utf-16からutf-8へ一文字ずつ変換(まとめて処理できない所の後始末用)
+//  in_untilに達するか、変換が止まるまで進める
+template< unicodeHelperByteOrder in_order>
+static convertStop  unicodeHelper_utf16ToUTF8Step( uint8_t*const        out_dst,
+                                                   size_t const         in_dstCap,
+                                                   size_t*const         io_written,
+                                                   uint8_t const*const  in_src,
+                                                   size_t const         in_srcLen,
+                                                   size_t*const         io_consumed,
+                                                   size_t const         in_until)
+{
+    size_t                      idxDst= *io_written;
+    size_t                      idxSrc= *io_consumed;
+    convertStop                 result= convertStop_complete;
+
+    while( idxSrc< in_until)
+    {
+        uint32_t                    unicode;
+        signed int const            szIn= unicodeHelper_decodeUTF16( &unicode, in_src+ idxSrc, (size_t)( in_srcLen- idxSrc), in_order);
+        if( szIn<= 0)
+        {
+            result                          = ( szIn== 0)? convertStop_shortInput: convertStop_invalid;
+            break;
+        }
+        if( unicode< 0x00000080UL
+            && idxDst< in_dstCap)
+        {
+            out_dst[ idxDst]                = (uint8_t)unicode;
+            idxDst                          += 1UL;
+        } else {
+            uint8_t                     buf[ 4];
+            signed int const            szOut= unicodeHelper_encodeUTF8( &buf[ 0], unicode);
+            if( (size_t)( in_dstCap- idxDst)< (size_t)szOut)
+            {
+                result                          = convertStop_shortOutput;
+                break;
+            }
+            memcpy( out_dst+ idxDst, &buf[ 0], (size_t)szOut);
+            idxDst                          += (size_t)szOut;
+        }
+        idxSrc                          += (size_t)szIn;
+    }
+
+    *io_written                     = idxDst;
+    *io_consumed                    = idxSrc;
+    return  result;
+}
+
+//  utf-16からutf-8へ変換(スカラー版。ASCIIは4word(8[byte])ずつまとめて判定)
+template< unicodeHelperByteOrder in_order>
+static convertStop  unicodeHelper_utf16ToUTF8Scalar( uint8_t*const         out_dst,
+                                                     size_t const           in_dstCap,
+                                                     size_t*const           io_written,
+                                                     uint8_t const*const    in_src,
+                                                     size_t const           in_srcLen,
+                                                     size_t*const           io_consumed)
+{
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 8UL
+               && (size_t)( in_dstCap- idxDst)>= 4UL)
+        {
+            uint16_t const              uw0= unicodeHelper_peekWord( in_src+ idxSrc,       in_order);
+            uint16_t const              uw1= unicodeHelper_peekWord( in_src+ idxSrc+ 2UL,  in_order);
+            uint16_t const              uw2= unicodeHelper_peekWord( in_src+ idxSrc+ 4UL,  in_order);
+            uint16_t const              uw3= unicodeHelper_peekWord( in_src+ idxSrc+ 6UL,  in_order);
+            if( (uint16_t)( ( uw0| uw1| uw2| uw3)& 0xff80U)!= 0U)   break;
+
+            out_dst[ idxDst]                = (uint8_t)uw0;
+            out_dst[ idxDst+ 1UL]           = (uint8_t)uw1;
+            out_dst[ idxDst+ 2UL]           = (uint8_t)uw2;
+            out_dst[ idxDst+ 3UL]           = (uint8_t)uw3;
+            idxSrc                          += 8UL;
+            idxDst                          += 4UL;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ASCII以外を含む4wordは一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 8UL)? (size_t)( idxSrc+ 8UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf16ToUTF8Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+//  utf-8を検証(スカラー版。ASCIIは8[byte]ずつまとめて判定)
+static size_t   unicodeHelper_validateUTF8Scalar( uint8_t const*const   in_src,
+                                                  size_t const          in_srcLen)
+{
+    size_t                      idx= 0UL;
+    for(;;)
+    {
+        while( (size_t)( in_srcLen- idx)>= 8UL)
+        {
+            uint64_t                    block;
+            memcpy( &block, in_src+ idx, sizeof( block));
+            if( ( block& 0x8080808080808080ULL)!= 0ULL) break;
+            idx                             += 8UL;
+        }
+        if( idx>= in_srcLen)    return  in_srcLen;
+
+        //  ASCII以外を含む8[byte]は一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idx)> 8UL)? (size_t)( idx+ 8UL): in_srcLen;
+        while( idx< until)
+        {
+            if( in_src[ idx]< 0x80U)
+            {
+                idx                             += 1UL;
+                continue;
+            }
+            uint32_t                    unicode;
+            signed int const            szIn= unicodeHelper_decodeUTF8( &unicode, in_src+ idx, (size_t)( in_srcLen- idx));
+            if( szIn<= 0)   return  idx;
+            idx                             += (size_t)szIn;
+        }
+    }
+}
+
+//  utf-16を一文字ずつ検証し、最初に不正な文字の位置([byte])を返す(全部正しければin_srcLen)
+//  in_startは文字の先頭であること
+template< unicodeHelperByteOrder in_order>
+static size_t   unicodeHelper_validateUTF16Scalar( uint8_t const*const  in_src,
+                                                   size_t const         in_srcLen,
+                                                   size_t const         in_start)
+{
+    size_t                      idx= in_start;
+    while( (size_t)( in_srcLen- idx)>= 2UL)
+    {
+        uint16_t const              uw= unicodeHelper_peekWord( in_src+ idx, in_order);
+        if( (uint16_t)( uw& 0xf800U)!= 0xd800U)
+        {
+            idx                             += 2UL;
+            continue;
+        }
+        uint32_t                    unicode;
+        signed int const            szIn= unicodeHelper_decodeUTF16( &unicode, in_src+ idx, (size_t)( in_srcLen- idx), in_order);
+        if( szIn<= 0)   return  idx;
+        idx                             += (size_t)szIn;
+    }
+    return  ( idx< in_srcLen)? idx: in_srcLen;
+}
+
+//  utf-16を検証(スカラー版)
+template< unicodeHelperByteOrder in_order>
+static size_t   unicodeHelper_validateUTF16Start( uint8_t const*const   in_src,
+                                                  size_t const          in_srcLen)
+{
+    return  unicodeHelper_validateUTF16Scalar<in_order>( in_src, in_srcLen, 0UL);
+}
+
+//  正しいと分かっている入力を変換した場合の出力サイズ([byte])を数える関数の型
+typedef size_t(*countFunc)( uint8_t const*const /*  入力元 */,
+                            size_t const        /*  入力元のサイズ([byte]) */);
+
+//  出力が入力と同じサイズになる場合(utf-8からutf-8、utf-16からutf-16)
+static size_t   unicodeHelper_countSame( uint8_t const*const    /*  in_src */,
+                                         size_t const           in_srcLen)
+{
+    return  in_srcLen;
+}
+
+//  utf-8をutf-16にした場合のサイズを数える(スカラー版)
+//  継続byte以外が一文字2[byte]、4[byte]文字の先頭byteはサロゲートの分さらに2[byte]
+static size_t   unicodeHelper_countUTF8ToUTF16Scalar( uint8_t const*const   in_src,
+                                                      size_t const          in_srcLen)
+{
+    size_t                      size= 0UL;
+    for( size_t idx= 0UL; idx< in_srcLen; idx++)
+    {
+        uint8_t const               uc= in_src[ idx];
+        if( (uint8_t)( uc& 0xc0U)!= 0x80U)  size+= 2UL;
+        if( uc>= 0xf0U)                     size+= 2UL;
+    }
+    return  size;
+}
+
+//  utf-16をutf-8にした場合のサイズを数える(スカラー版)
+//  サロゲートは一つ2[byte](対で4[byte])
+template< unicodeHelperByteOrder in_order>
+static size_t   unicodeHelper_countUTF16ToUTF8Scalar( uint8_t const*const   in_src,
+                                                      size_t const          in_srcLen)
+{
+    size_t                      size= 0UL;
+    for( size_t idx= 0UL; (size_t)( idx+ 2UL)<= in_srcLen; idx+= 2UL)
+    {
+        uint16_t const              uw= unicodeHelper_peekWord( in_src+ idx, in_order);
+        if( uw< 0x0080U)                                size+= 1UL;
+        else if( uw< 0x0800U)                           size+= 2UL;
+        else if( (uint16_t)( uw& 0xf800U)== 0xd800U)    size+= 2UL;
+        else                                            size+= 3UL;
+    }
+    return  size;
+}
+
+//  検証してから、変換できる所までの出力サイズを数える
+template< validateFunc in_validate, countFunc in_count>
+static size_t   unicodeHelper_measureCounted( size_t*const          out_size,
+                                              uint8_t const*const   in_src,
+                                              size_t const          in_srcLen)
+{
+    size_t const                szValid= in_validate( in_src, in_srcLen);
+    *out_size                       = in_count( in_src, szValid);
+    return  szValid;
+}
+
+//  byteの種類ごとの個数をin_idxから数えて足す(スカラー版。偶数奇数は入力の先頭から数える)
+static void unicodeHelper_byteHistogramScalar( byteHistogram*const  io_histogram,
+                                               uint8_t const*const  in_src,
+                                               size_t const         in_srcLen,
+                                               size_t const         in_idx)
+{
+    for( size_t idx= in_idx; idx< in_srcLen; idx++)
+    {
+        uint8_t const               uc= in_src[ idx];
+        if( (size_t)( idx+ 2UL)< in_srcLen&& in_src[ idx+ 2UL]== uc)
+        {
+            if( ( idx& 1UL)== 0UL)  io_histogram->_repeatEven++;
+            else                    io_histogram->_repeatOdd++;
+        }
+        if( uc== 0x00U)
+        {
+            if( ( idx& 1UL)== 0UL)  io_histogram->_zeroEven++;
+            else                    io_histogram->_zeroOdd++;
+        } else if( uc>= 0x80U) {
+            io_histogram->_high++;
+        } else if( uc< 0x20U
+                   && ( uc< 0x09U|| uc> 0x0dU)
+                   && uc!= 0x1bU) {
+            io_histogram->_control++;
+        }
+    }
+}
+
+#if         defined(UNICODE_HELPER_SIMD_X86)
+
+//  8lane分のuint16_tを詰める時のpshufb用テーブル
+typedef struct {
+    uint8_t                     _shuffle[ 256][ 16];    //  lane選択用のマスクごとのシャッフル
+    uint8_t                     _count[ 256];           //  lane選択用のマスクごとの選択数
+} compressTable;
+
+//  compressTableを作る
+static constexpr compressTable  unicodeHelper_makeCompressTable( void)
+{
+    compressTable               table= {};
+    for( unsigned int mask= 0U; mask< 256U; mask++)
+    {
+        unsigned int                num= 0U;
+        for( unsigned int lane= 0U; lane< 8U; lane++)
+        {
+            if( ( mask& ( 1U<< lane))!= 0U)
+            {
+                table._shuffle[ mask][ num* 2U]         = (uint8_t)( lane* 2U);
+                table._shuffle[ mask][ num* 2U+ 1U]     = (uint8_t)( lane* 2U+ 1U);
+                num++;
+            }
+        }
+        for( unsigned int i= num* 2U; i< 16U; i++)
+        {
+            table._shuffle[ mask][ i]       = 0x80U;
+        }
+        table._count[ mask]             = (uint8_t)num;
+    }
+    return  table;
+}
+
+//  8lane分のuint16_tを詰める時のpshufb用テーブル
+static constexpr compressTable  gCompressTable= unicodeHelper_makeCompressTable();
+
+//  x86(little endian)上で、指定のバイトオーダーがbig endianか
+template< unicodeHelperByteOrder in_order>
+static inline bool  unicodeHelper_isBigEndianOrder( void)
+{
+    return  in_order== unicodeHelperByteOrder_be;
+}
+
+//  in_vの各byteがin_c以上(符号無し)かどうかのマスク
+__attribute__((target("sse4.1")))
+static inline unsigned int  unicodeHelper_maskGE( __m128i const in_v, uint8_t const in_c)
+{
+    return  (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( in_v, _mm_set1_epi8( (char)in_c)), in_v));
+}
+
+//  uint16_tのlaneのbyteを入れ替える(big endianにする)
+__attribute__((target("sse4.1")))
+static inline __m128i   unicodeHelper_swapWord( __m128i const in_v)
+{
+    return  _mm_shuffle_epi8( in_v, _mm_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+}
+
+//  ASCIIの16[byte]をutf-16の32[byte]に広げて書き込む
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static inline void  unicodeHelper_widenASCII16( uint8_t*const out_dst, __m128i const in_v)
+{
+    __m128i const               zero= _mm_setzero_si128();
+    if( unicodeHelper_isBigEndianOrder<in_order>())
+    {
+        _mm_storeu_si128( (__m128i*)( out_dst),       _mm_unpacklo_epi8( zero, in_v));
+        _mm_storeu_si128( (__m128i*)( out_dst+ 16),   _mm_unpackhi_epi8( zero, in_v));
+    } else {
+        _mm_storeu_si128( (__m128i*)( out_dst),       _mm_unpacklo_epi8( in_v, zero));
+        _mm_storeu_si128( (__m128i*)( out_dst+ 16),   _mm_unpackhi_epi8( in_v, zero));
+    }
+}
+
+//  各laneを1-3[byte]のutf-8の先頭とみなしてunicodeを組み立てる
+//  in_b0/in_b1/in_b2はその位置と続く2[byte]をuint16_tに広げたもの
+__attribute__((target("sse4.1")))
+static inline __m128i   unicodeHelper_assembleUTF8( __m128i const in_b0,
+                                                    __m128i const in_b1,
+                                                    __m128i const in_b2)
+{
+    __m128i const               c1= _mm_and_si128( in_b1, _mm_set1_epi16( 0x003f));
+    __m128i const               c2= _mm_and_si128( in_b2, _mm_set1_epi16( 0x003f));
+    __m128i const               cp2= _mm_or_si128( _mm_slli_epi16( _mm_and_si128( in_b0, _mm_set1_epi16( 0x001f)), 6), c1);
+    __m128i const               cp3= _mm_or_si128( _mm_or_si128( _mm_slli_epi16( _mm_and_si128( in_b0, _mm_set1_epi16( 0x000f)), 12),
+                                                                 _mm_slli_epi16( c1, 6)),
+                                                   c2);
+    __m128i const               is3= _mm_cmpgt_epi16( in_b0, _mm_set1_epi16( 0x00df));
+    __m128i const               isASCII= _mm_cmplt_epi16( in_b0, _mm_set1_epi16( 0x0080));
+
+    return  _mm_blendv_epi8( _mm_blendv_epi8( cp2, cp3, is3), in_b0, isASCII);
+}
+
+//  先頭16[byte]のどこかにASCII以外を含むutf-8をベクトルのままutf-16にする
+//  in_srcは18[byte]、out_dstは32[byte]触れるものとする
+//  4[byte]の文字を含む・不正なシーケンス等、ここで扱えない場合は0を返す
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static inline signed int    unicodeHelper_utf8ToUTF16Block16( uint8_t*const         out_dst,
+                                                              size_t*const          out_szOut,
+                                                              uint8_t const*const   in_src,
+                                                              size_t*const          out_szIn)
+{
+    __m128i const               v0= _mm_loadu_si128( (__m128i const*)( in_src));
+    __m128i const               v1= _mm_loadu_si128( (__m128i const*)( in_src+ 1));
+    __m128i const               v2= _mm_loadu_si128( (__m128i const*)( in_src+ 2));
+
+    //  byteの分類(ビットマスク)
+    unsigned int const          ge80= (unsigned int)_mm_movemask_epi8( v0);
+    unsigned int const          geC0= unicodeHelper_maskGE( v0, 0xc0U);
+    unsigned int const          geC2= unicodeHelper_maskGE( v0, 0xc2U);
+    unsigned int const          geE0= unicodeHelper_maskGE( v0, 0xe0U);
+    unsigned int const          geF0= unicodeHelper_maskGE( v0, 0xf0U);
+
+    //  冗長な2[byte]表現の先頭と、4[byte]以上の先頭はここでは扱わない
+    if( ( ( geC0& ~geC2)| geF0)!= 0U)   return  0;
+
+    //  続く2[byte](16,17[byte]目)の継続byteもマスクに含める
+    unsigned int const          contV2= (unsigned int)_mm_movemask_epi8( v2)& ~unicodeHelper_maskGE( v2, 0xc0U);
+    unsigned int const          cont= ( ge80& ~geC0)| ( ( contV2>> 14)<< 16);
+    unsigned int const          lead2= geC2& ~geE0;
+    unsigned int const          lead3= geE0;
+
+    //  先頭byteから求めた継続byteの位置と、実際の継続byteの位置が一致するか
+    unsigned int const          expected= ( lead2<< 1)| ( lead3<< 1)| ( lead3<< 2);
+    unsigned int const          overhang= ( ( lead3& 0x8000U)!= 0U)? 2U:
+                                          ( ( ( lead3& 0x4000U)| ( lead2& 0x8000U))!= 0U)? 1U: 0U;
+    unsigned int const          maskChecked= (unsigned int)( ( 1U<< ( 16U+ overhang))- 1U);
+    if( ( ( cont^ expected)& maskChecked)!= 0U)     return  0;
+
+    //  0xe0の次は0xa0以上(冗長表現)、0xedの次は0xa0未満(サロゲート)
+    unsigned int const          next80to9F= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( v1, _mm_set1_epi8( (char)0x9f)),
+                                                                                             _mm_set1_epi8( (char)0x9f)));
+    unsigned int const          isE0= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( v0, _mm_set1_epi8( (char)0xe0)));
+    unsigned int const          isED= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( v0, _mm_set1_epi8( (char)0xed)));
+    if( ( isE0& next80to9F)!= 0U
+        || ( isED& ~next80to9F& 0xffffU)!= 0U)
+    {
+        return  0;
+    }
+
+    //  全laneを先頭byteとみなして組み立ててから、先頭byteのlaneだけ詰める
+    __m128i const               zero= _mm_setzero_si128();
+    __m128i                     cpLo= unicodeHelper_assembleUTF8( _mm_unpacklo_epi8( v0, zero),
+                                                                  _mm_unpacklo_epi8( v1, zero),
+                                                                  _mm_unpacklo_epi8( v2, zero));
+    __m128i                     cpHi= unicodeHelper_assembleUTF8( _mm_unpackhi_epi8( v0, zero),
+                                                                  _mm_unpackhi_epi8( v1, zero),
+                                                                  _mm_unpackhi_epi8( v2, zero));
+    if( unicodeHelper_isBigEndianOrder<in_order>())
+    {
+        cpLo                            = unicodeHelper_swapWord( cpLo);
+        cpHi                            = unicodeHelper_swapWord( cpHi);
+    }
+
+    unsigned int const          lead= ~cont& 0xffffU;
+    unsigned int const          leadLo= lead& 0x00ffU;
+    unsigned int const          leadHi= lead>> 8;
+    size_t const                szLo= (size_t)( gCompressTable._count[ leadLo]* 2U);
+    _mm_storeu_si128( (__m128i*)( out_dst),
+                      _mm_shuffle_epi8( cpLo, _mm_loadu_si128( (__m128i const*)&gCompressTable._shuffle[ leadLo][ 0])));
+    _mm_storeu_si128( (__m128i*)( out_dst+ szLo),
+                      _mm_shuffle_epi8( cpHi, _mm_loadu_si128( (__m128i const*)&gCompressTable._shuffle[ leadHi][ 0])));
+
+    *out_szOut                      = (size_t)( szLo+ gCompressTable._count[ leadHi]* 2U);
+    *out_szIn                       = (size_t)( 16U+ overhang);
+    return  -1;
+}
+
+//  utf-8からutf-16へ変換(SSE4.1版。16[byte]ずつ処理)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static convertStop  unicodeHelper_utf8ToUTF16SSE41( uint8_t*const          out_dst,
+                                                    size_t const            in_dstCap,
+                                                    size_t*const            io_written,
+                                                    uint8_t const*const     in_src,
+                                                    size_t const            in_srcLen,
+                                                    size_t*const            io_consumed)
+{
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 18UL
+               && (size_t)( in_dstCap- idxDst)>= 32UL)
+        {
+            __m128i const               v= _mm_loadu_si128( (__m128i const*)( in_src+ idxSrc));
+            if( _mm_movemask_epi8( v)== 0)
+            {
+                unicodeHelper_widenASCII16<in_order>( out_dst+ idxDst, v);
+                idxSrc                          += 16UL;
+                idxDst                          += 32UL;
+                continue;
+            }
+
+            size_t                      szIn;
+            size_t                      szOut;
+            if( unicodeHelper_utf8ToUTF16Block16<in_order>( out_dst+ idxDst, &szOut, in_src+ idxSrc, &szIn)== 0)  break;
+            idxSrc                          += szIn;
+            idxDst                          += szOut;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ベクトルで扱えなかった16[byte]は一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 16UL)? (size_t)( idxSrc+ 16UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf8ToUTF16Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+//  utf-8からutf-16へ変換(AVX2版。ASCIIは32[byte]ずつ、それ以外は16[byte]ずつ処理)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("avx2")))
+static convertStop  unicodeHelper_utf8ToUTF16AVX2( uint8_t*const           out_dst,
+                                                   size_t const             in_dstCap,
+                                                   size_t*const             io_written,
+                                                   uint8_t const*const      in_src,
+                                                   size_t const             in_srcLen,
+                                                   size_t*const             io_consumed)
+{
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 18UL
+               && (size_t)( in_dstCap- idxDst)>= 32UL)
+        {
+            if( (size_t)( in_srcLen- idxSrc)>= 32UL
+                && (size_t)( in_dstCap- idxDst)>= 64UL)
+            {
+                __m256i const               v= _mm256_loadu_si256( (__m256i const*)( in_src+ idxSrc));
+                if( _mm256_movemask_epi8( v)== 0)
+                {
+                    __m256i                     lo= _mm256_cvtepu8_epi16( _mm256_castsi256_si128( v));
+                    __m256i                     hi= _mm256_cvtepu8_epi16( _mm256_extracti128_si256( v, 1));
+                    if( unicodeHelper_isBigEndianOrder<in_order>())
+                    {
+                        __m256i const               swap= _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                                            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+                        lo                              = _mm256_shuffle_epi8( lo, swap);
+                        hi                              = _mm256_shuffle_epi8( hi, swap);
+                    }
+                    _mm256_storeu_si256( (__m256i*)( out_dst+ idxDst),       lo);
+                    _mm256_storeu_si256( (__m256i*)( out_dst+ idxDst+ 32),   hi);
+                    idxSrc                          += 32UL;
+                    idxDst                          += 64UL;
+                    continue;
+                }
+            }
+
+            __m128i const               v= _mm_loadu_si128( (__m128i const*)( in_src+ idxSrc));
+            if( _mm_movemask_epi8( v)== 0)
+            {
+                unicodeHelper_widenASCII16<in_order>( out_dst+ idxDst, v);
+                idxSrc                          += 16UL;
+                idxDst                          += 32UL;
+                continue;
+            }
+
+            size_t                      szIn;
+            size_t                      szOut;
+            if( unicodeHelper_utf8ToUTF16Block16<in_order>( out_dst+ idxDst, &szOut, in_src+ idxSrc, &szIn)== 0)  break;
+            idxSrc                          += szIn;
+            idxDst                          += szOut;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ベクトルで扱えなかった16[byte]は一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 16UL)? (size_t)( idxSrc+ 16UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf8ToUTF16Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+
+//  4lane分のutf-8(laneごとに0-3[byte])を詰める時のpshufb用テーブル
+typedef struct {
+    uint8_t                     _shuffle[ 256][ 16];    //  laneごとの長さコード(2[bit]x4)ごとのシャッフル
+    uint8_t                     _count[ 256];           //  laneごとの長さコードごとの出力サイズ([byte])
+} utf8PackTable;
+
+//  utf8PackTableを作る(長さコードは0:1[byte] 1:2[byte] 2:3[byte] 3:出力しない)
+static constexpr utf8PackTable  unicodeHelper_makeUTF8PackTable( void)
+{
+    utf8PackTable               table= {};
+    for( unsigned int pattern= 0U; pattern< 256U; pattern++)
+    {
+        unsigned int                num= 0U;
+        for( unsigned int lane= 0U; lane< 4U; lane++)
+        {
+            unsigned int const          code= ( pattern>> ( lane* 2U))& 3U;
+            unsigned int const          len= ( code== 3U)? 0U: code+ 1U;
+            for( unsigned int i= 0U; i< len; i++)
+            {
+                table._shuffle[ pattern][ num]  = (uint8_t)( lane* 4U+ i);
+                num++;
+            }
+        }
+        for( unsigned int i= num; i< 16U; i++)
+        {
+            table._shuffle[ pattern][ i]    = 0x80U;
+        }
+        table._count[ pattern]          = (uint8_t)num;
+    }
+    return  table;
+}
+
+//  4lane分のutf-8を詰める時のpshufb用テーブル
+static constexpr utf8PackTable  gUTF8PackTable= unicodeHelper_makeUTF8PackTable();
+
+//  4[bit]を1[bit]おきに広げる
+static inline unsigned int  unicodeHelper_spreadBits4( unsigned int const in_bits)
+{
+    return  ( in_bits& 1U)| ( ( in_bits& 2U)<< 1)| ( ( in_bits& 4U)<< 2)| ( ( in_bits& 8U)<< 3);
+}
+
+//  8lane分のuint16_tの比較結果を1lane 1[bit]のマスクにする
+__attribute__((target("sse4.1")))
+static inline unsigned int  unicodeHelper_laneMask16( __m128i const in_cmp)
+{
+    return  (unsigned int)_mm_movemask_epi8( _mm_packs_epi16( in_cmp, in_cmp))& 0xffU;
+}
+
+//  4lane(uint32_tに広げたutf-16)をutf-8にして詰めて書き込み、書いたサイズ([byte])を返す
+//  in_prevは各laneの一つ前のutf-16(下位サロゲートの組み立て用)
+__attribute__((target("sse4.1")))
+static inline size_t    unicodeHelper_utf16ToUTF8Lane4( uint8_t*const      out_dst,
+                                                        __m128i const      in_u,
+                                                        __m128i const      in_prev,
+                                                        unsigned int const in_pattern)
+{
+    __m128i const               m3f= _mm_set1_epi32( 0x3f);
+    __m128i const               m80= _mm_set1_epi32( 0x80);
+
+    //  2[byte] : 110xxxxx 10xxxxxx
+    __m128i const               t2= _mm_or_si128( _mm_or_si128( _mm_srli_epi32( in_u, 6), _mm_set1_epi32( 0xc0)),
+                                                  _mm_slli_epi32( _mm_or_si128( _mm_and_si128( in_u, m3f), m80), 8));
+    //  3[byte] : 1110xxxx 10xxxxxx 10xxxxxx
+    __m128i const               t3= _mm_or_si128( _mm_or_si128( _mm_or_si128( _mm_srli_epi32( in_u, 12), _mm_set1_epi32( 0xe0)),
+                                                                _mm_slli_epi32( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( in_u, 6), m3f), m80), 8)),
+                                                  _mm_slli_epi32( _mm_or_si128( _mm_and_si128( in_u, m3f), m80), 16));
+    //  上位サロゲート : 11110xxx 10xxxxxx (unicodeの上位11[bit]から)
+    __m128i const               hi= _mm_add_epi32( _mm_and_si128( in_u, _mm_set1_epi32( 0x03ff)), _mm_set1_epi32( 0x0040));
+    __m128i const               tH= _mm_or_si128( _mm_or_si128( _mm_srli_epi32( hi, 8), _mm_set1_epi32( 0xf0)),
+                                                  _mm_slli_epi32( _mm_or_si128( _mm_and_si128( _mm_srli_epi32( hi, 2), m3f), m80), 8));
+    //  下位サロゲート : 10xxxxxx 10xxxxxx (一つ前の上位サロゲートの下位2[bit]を使う)
+    __m128i const               tL= _mm_or_si128( _mm_or_si128( _mm_or_si128( _mm_slli_epi32( _mm_and_si128( in_prev, _mm_set1_epi32( 3)), 4),
+                                                                              _mm_and_si128( _mm_srli_epi32( in_u, 6), _mm_set1_epi32( 0x0f))),
+                                                                m80),
+                                                  _mm_slli_epi32( _mm_or_si128( _mm_and_si128( in_u, m3f), m80), 8));
+
+    __m128i const               isASCII= _mm_cmplt_epi32( in_u, _mm_set1_epi32( 0x0080));
+    __m128i const               is2= _mm_cmplt_epi32( in_u, _mm_set1_epi32( 0x0800));
+    __m128i const               isSurrogate= _mm_cmpeq_epi32( _mm_and_si128( in_u, _mm_set1_epi32( 0xf800)), _mm_set1_epi32( 0xd800));
+    __m128i const               isHigh= _mm_cmpeq_epi32( _mm_and_si128( in_u, _mm_set1_epi32( 0xfc00)), _mm_set1_epi32( 0xd800));
+
+    __m128i                     t= _mm_blendv_epi8( t3, t2, is2);
+    t                               = _mm_blendv_epi8( t, in_u, isASCII);
+    t                               = _mm_blendv_epi8( t, _mm_blendv_epi8( tL, tH, isHigh), isSurrogate);
+
+    _mm_storeu_si128( (__m128i*)out_dst,
+                      _mm_shuffle_epi8( t, _mm_loadu_si128( (__m128i const*)&gUTF8PackTable._shuffle[ in_pattern][ 0])));
+    return  (size_t)gUTF8PackTable._count[ in_pattern];
+}
+
+//  ASCII以外を含む8word(16[byte])をベクトルのままutf-8にする
+//  in_srcは16[byte]、out_dstは32[byte]触れるものとする
+//  ペアになっていないサロゲートがある場合は0を返す
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static inline signed int    unicodeHelper_utf16ToUTF8Block8( uint8_t*const          out_dst,
+                                                             size_t*const           out_szOut,
+                                                             size_t*const           out_szIn,
+                                                             __m128i const          in_v)
+{
+    //  laneの分類(1lane 1[bit])
+    unsigned int const          ge80= unicodeHelper_laneMask16(
+                                          _mm_cmpeq_epi16( _mm_and_si128( in_v, _mm_set1_epi16( (short)0xff80)), _mm_setzero_si128()))^ 0xffU;
+    unsigned int const          ge800= unicodeHelper_laneMask16(
+                                          _mm_cmpeq_epi16( _mm_and_si128( in_v, _mm_set1_epi16( (short)0xf800)), _mm_setzero_si128()))^ 0xffU;
+    unsigned int const          surrogate= unicodeHelper_laneMask16(
+                                          _mm_cmpeq_epi16( _mm_and_si128( in_v, _mm_set1_epi16( (short)0xf800)), _mm_set1_epi16( (short)0xd800)));
+    unsigned int const          high= unicodeHelper_laneMask16(
+                                          _mm_cmpeq_epi16( _mm_and_si128( in_v, _mm_set1_epi16( (short)0xfc00)), _mm_set1_epi16( (short)0xd800)));
+    unsigned int const          low= surrogate& ~high;
+
+    //  最後のlaneが上位サロゲートなら次回に回す
+    unsigned int const          drop= high& 0x80U;
+    if( low!= ( ( high& ~drop)<< 1))    return  0;
+
+    //  laneごとの長さコード(0:1[byte] 1:2[byte] 2:3[byte] 3:出力しない)
+    unsigned int const          code0= ( ( ge80& ~ge800)| surrogate| drop)& 0xffU;
+    unsigned int const          code1= ( ( ge800& ~surrogate)| drop)& 0xffU;
+    unsigned int const          patternLo= unicodeHelper_spreadBits4( code0& 0x0fU)| ( unicodeHelper_spreadBits4( code1& 0x0fU)<< 1);
+    unsigned int const          patternHi= unicodeHelper_spreadBits4( code0>> 4)| ( unicodeHelper_spreadBits4( code1>> 4)<< 1);
+
+    __m128i const               prev= _mm_slli_si128( in_v, 2);
+    size_t const                szLo= unicodeHelper_utf16ToUTF8Lane4( out_dst,
+                                                                      _mm_cvtepu16_epi32( in_v),
+                                                                      _mm_cvtepu16_epi32( prev),
+                                                                      patternLo);
+    size_t const                szHi= unicodeHelper_utf16ToUTF8Lane4( out_dst+ szLo,
+                                                                      _mm_cvtepu16_epi32( _mm_srli_si128( in_v, 8)),
+                                                                      _mm_cvtepu16_epi32( _mm_srli_si128( prev, 8)),
+                                                                      patternHi);
+
+    *out_szOut                      = (size_t)( szLo+ szHi);
+    *out_szIn                       = ( drop!= 0U)? 14UL: 16UL;
+    return  -1;
+}
+
+//  utf-16の16[byte]を読み込み、little endianのuint16_tの並びにする
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static inline __m128i   unicodeHelper_loadUTF16x8( uint8_t const*const in_src)
+{
+    __m128i const               v= _mm_loadu_si128( (__m128i const*)in_src);
+    if( unicodeHelper_isBigEndianOrder<in_order>())
+    {
+        return  unicodeHelper_swapWord( v);
+    }
+    return  v;
+}
+
+//  utf-16からutf-8へ変換(SSE4.1版。8wordずつ処理)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static convertStop  unicodeHelper_utf16ToUTF8SSE41( uint8_t*const          out_dst,
+                                                    size_t const            in_dstCap,
+                                                    size_t*const            io_written,
+                                                    uint8_t const*const     in_src,
+                                                    size_t const            in_srcLen,
+                                                    size_t*const            io_consumed)
+{
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 16UL
+               && (size_t)( in_dstCap- idxDst)>= 32UL)
+        {
+            __m128i const               v= unicodeHelper_loadUTF16x8<in_order>( in_src+ idxSrc);
+            if( _mm_testz_si128( v, _mm_set1_epi16( (short)0xff80))!= 0)
+            {
+                _mm_storel_epi64( (__m128i*)( out_dst+ idxDst), _mm_packus_epi16( v, v));
+                idxSrc                          += 16UL;
+                idxDst                          += 8UL;
+                continue;
+            }
+
+            size_t                      szIn;
+            size_t                      szOut;
+            if( unicodeHelper_utf16ToUTF8Block8<in_order>( out_dst+ idxDst, &szOut, &szIn, v)== 0)    break;
+            idxSrc                          += szIn;
+            idxDst                          += szOut;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ベクトルで扱えなかった8wordは一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 16UL)? (size_t)( idxSrc+ 16UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf16ToUTF8Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+//  utf-16からutf-8へ変換(AVX2版。ASCIIは16wordずつ、それ以外は8wordずつ処理)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("avx2")))
+static convertStop  unicodeHelper_utf16ToUTF8AVX2( uint8_t*const           out_dst,
+                                                   size_t const             in_dstCap,
+                                                   size_t*const             io_written,
+                                                   uint8_t const*const      in_src,
+                                                   size_t const             in_srcLen,
+                                                   size_t*const             io_consumed)
+{
+    for(;;)
+    {
+        size_t                      idxDst= *io_written;
+        size_t                      idxSrc= *io_consumed;
+        while( (size_t)( in_srcLen- idxSrc)>= 16UL
+               && (size_t)( in_dstCap- idxDst)>= 32UL)
+        {
+            if( (size_t)( in_srcLen- idxSrc)>= 32UL
+                && (size_t)( in_dstCap- idxDst)>= 64UL)
+            {
+                __m256i                     v= _mm256_loadu_si256( (__m256i const*)( in_src+ idxSrc));
+                if( unicodeHelper_isBigEndianOrder<in_order>())
+                {
+                    v                               = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                                                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+                }
+                if( _mm256_testz_si256( v, _mm256_set1_epi16( (short)0xff80))!= 0)
+                {
+                    __m128i const               packed= _mm_packus_epi16( _mm256_castsi256_si128( v), _mm256_extracti128_si256( v, 1));
+                    _mm_storeu_si128( (__m128i*)( out_dst+ idxDst), packed);
+                    idxSrc                          += 32UL;
+                    idxDst                          += 16UL;
+                    continue;
+                }
+
+                //  前半の8word、続けて後半の8wordを処理(前半の最後が上位サロゲートなら後半は次の周回で読み直す)
+                size_t                      szIn;
+                size_t                      szOut;
+                if( unicodeHelper_utf16ToUTF8Block8<in_order>( out_dst+ idxDst, &szOut, &szIn, _mm256_castsi256_si128( v))== 0)    break;
+                idxSrc                          += szIn;
+                idxDst                          += szOut;
+                if( szIn!= 16UL)    continue;
+                if( unicodeHelper_utf16ToUTF8Block8<in_order>( out_dst+ idxDst, &szOut, &szIn, _mm256_extracti128_si256( v, 1))== 0)    break;
+                idxSrc                          += szIn;
+                idxDst                          += szOut;
+                continue;
+            }
+
+            __m128i const               v= unicodeHelper_loadUTF16x8<in_order>( in_src+ idxSrc);
+            if( _mm_testz_si128( v, _mm_set1_epi16( (short)0xff80))!= 0)
+            {
+                _mm_storel_epi64( (__m128i*)( out_dst+ idxDst), _mm_packus_epi16( v, v));
+                idxSrc                          += 16UL;
+                idxDst                          += 8UL;
+                continue;
+            }
+
+            size_t                      szIn;
+            size_t                      szOut;
+            if( unicodeHelper_utf16ToUTF8Block8<in_order>( out_dst+ idxDst, &szOut, &szIn, v)== 0)    break;
+            idxSrc                          += szIn;
+            idxDst                          += szOut;
+        }
+        *io_written                     = idxDst;
+        *io_consumed                    = idxSrc;
+        if( idxSrc>= in_srcLen)     return  convertStop_complete;
+
+        //  ベクトルで扱えなかった8wordは一文字ずつ
+        size_t const                until= ( (size_t)( in_srcLen- idxSrc)> 16UL)? (size_t)( idxSrc+ 16UL): in_srcLen;
+        convertStop const           stop= unicodeHelper_utf16ToUTF8Step<in_order>( out_dst, in_dstCap, io_written,
+                                                                                    in_src, in_srcLen, io_consumed,
+                                                                                    until);
+        if( stop!= convertStop_complete)    return  stop;
+    }
+}
+
+//  utf-8検証用のエラー種別(pshufbで引く表の各bit)
+static uint8_t const            utf8ErrTooShort     = 0x01U;    //  先頭byteの後に続きが無い
+static uint8_t const            utf8ErrTooLong      = 0x02U;    //  ASCIIの後に続きがある
+static uint8_t const            utf8ErrOverlong3    = 0x04U;    //  E0 80-9F
+static uint8_t const            utf8ErrTooLarge     = 0x08U;    //  F4 90-BF, F5-FF
+static uint8_t const            utf8ErrSurrogate    = 0x10U;    //  ED A0-BF
+static uint8_t const            utf8ErrOverlong2    = 0x20U;    //  C0-C1
+static uint8_t const            utf8ErrTooLarge1000 = 0x40U;    //  F5-FF 80-8F
+static uint8_t const            utf8ErrOverlong4    = 0x40U;    //  F0 80-8F
+static uint8_t const            utf8ErrTwoConts     = 0x80U;    //  続きが二つ並んでいる(3,4[byte]目以外は不正)
+static uint8_t const            utf8ErrCarry        = utf8ErrTooShort| utf8ErrTooLong| utf8ErrTwoConts;
+
+//  一つ前のbyteの上位4[bit]から引く表
+#define UNICODE_HELPER_UTF8_TABLE_PREV_HIGH                                                         \
+    (char)utf8ErrTooLong, (char)utf8ErrTooLong, (char)utf8ErrTooLong, (char)utf8ErrTooLong,         \
+    (char)utf8ErrTooLong, (char)utf8ErrTooLong, (char)utf8ErrTooLong, (char)utf8ErrTooLong,         \
+    (char)utf8ErrTwoConts, (char)utf8ErrTwoConts, (char)utf8ErrTwoConts, (char)utf8ErrTwoConts,     \
+    (char)( utf8ErrTooShort| utf8ErrOverlong2),                                                     \
+    (char)( utf8ErrTooShort),                                                                       \
+    (char)( utf8ErrTooShort| utf8ErrOverlong3| utf8ErrSurrogate),                                   \
+    (char)( utf8ErrTooShort| utf8ErrTooLarge| utf8ErrTooLarge1000| utf8ErrOverlong4)
+
+//  一つ前のbyteの下位4[bit]から引く表
+#define UNICODE_HELPER_UTF8_TABLE_PREV_LOW                                                          \
+    (char)( utf8ErrCarry| utf8ErrOverlong3| utf8ErrOverlong2| utf8ErrOverlong4),                    \
+    (char)( utf8ErrCarry| utf8ErrOverlong2),                                                        \
+    (char)( utf8ErrCarry),                                                                          \
+    (char)( utf8ErrCarry),                                                                          \
+    (char)( utf8ErrCarry| utf8ErrTooLarge),                                                         \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000| utf8ErrSurrogate),                  \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000),                                    \
+    (char)( utf8ErrCarry| utf8ErrTooLarge| utf8ErrTooLarge1000)
+
+//  今のbyteの上位4[bit]から引く表
+#define UNICODE_HELPER_UTF8_TABLE_CUR_HIGH                                                          \
+    (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort,     \
+    (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort,     \
+    (char)( utf8ErrTooLong| utf8ErrOverlong2| utf8ErrTwoConts| utf8ErrOverlong3| utf8ErrTooLarge1000| utf8ErrOverlong4), \
+    (char)( utf8ErrTooLong| utf8ErrOverlong2| utf8ErrTwoConts| utf8ErrOverlong3| utf8ErrTooLarge),  \
+    (char)( utf8ErrTooLong| utf8ErrOverlong2| utf8ErrTwoConts| utf8ErrSurrogate| utf8ErrTooLarge),  \
+    (char)( utf8ErrTooLong| utf8ErrOverlong2| utf8ErrTwoConts| utf8ErrSurrogate| utf8ErrTooLarge),  \
+    (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort, (char)utf8ErrTooShort
+
+//  utf-8を一文字ずつ検証し、最初に不正な文字の位置([byte])を返す(全部正しければin_srcLen)
+//  in_startは文字の先頭であること
+static size_t   unicodeHelper_validateUTF8Step( uint8_t const*const in_src,
+                                                size_t const        in_srcLen,
+                                                size_t const        in_start)
+{
+    size_t                      idx= in_start;
+    while( idx< in_srcLen)
+    {
+        if( in_src[ idx]< 0x80U)
+        {
+            idx                             += 1UL;
+            continue;
+        }
+        uint32_t                    unicode;
+        signed int const            szIn= unicodeHelper_decodeUTF8( &unicode, in_src+ idx, (size_t)( in_srcLen- idx));
+        if( szIn<= 0)   break;
+        idx                             += (size_t)szIn;
+    }
+    return  idx;
+}
+
+//  ベクトルで不正が見つかったブロックを一文字ずつ調べ直し、最初に不正な文字の位置([byte])を返す
+//  in_blockStartより前は(ブロックをまたぐ最後の一文字を除いて)正しいものとする
+static size_t   unicodeHelper_validateUTF8Resume( uint8_t const*const   in_src,
+                                                  size_t const          in_srcLen,
+                                                  size_t const          in_blockStart)
+{
+    size_t                      start= in_blockStart;
+    for( size_t back= 1UL; back<= 3UL&& back<= in_blockStart; back++)
+    {
+        uint8_t const               c= in_src[ in_blockStart- back];
+        if( (uint8_t)( c& 0xc0U)!= 0x80U)
+        {
+            if( c>= 0xc0U)  start= (size_t)( in_blockStart- back);
+            break;
+        }
+    }
+    return  unicodeHelper_validateUTF8Step( in_src, in_srcLen, start);
+}
+
+//  16[byte]分のutf-8の不正を調べる(不正なbyteの位置が0以外になる)
+//  in_prevは一つ前の16[byte]
+__attribute__((target("sse4.1")))
+static inline __m128i   unicodeHelper_utf8ErrorSSE41( __m128i const in_v,
+                                                      __m128i const in_prev)
+{
+    __m128i const               m0f= _mm_set1_epi8( 0x0f);
+    __m128i const               prev1= _mm_alignr_epi8( in_v, in_prev, 15);
+    __m128i const               prev2= _mm_alignr_epi8( in_v, in_prev, 14);
+    __m128i const               prev3= _mm_alignr_epi8( in_v, in_prev, 13);
+
+    __m128i const               prevHigh= _mm_shuffle_epi8( _mm_setr_epi8( UNICODE_HELPER_UTF8_TABLE_PREV_HIGH),
+                                                            _mm_and_si128( _mm_srli_epi16( prev1, 4), m0f));
+    __m128i const               prevLow= _mm_shuffle_epi8( _mm_setr_epi8( UNICODE_HELPER_UTF8_TABLE_PREV_LOW),
+                                                           _mm_and_si128( prev1, m0f));
+    __m128i const               curHigh= _mm_shuffle_epi8( _mm_setr_epi8( UNICODE_HELPER_UTF8_TABLE_CUR_HIGH),
+                                                           _mm_and_si128( _mm_srli_epi16( in_v, 4), m0f));
+    __m128i const               special= _mm_and_si128( _mm_and_si128( prevHigh, prevLow), curHigh);
+
+    //  3,4[byte]の文字の3,4[byte]目は続きが二つ並んでいてよい
+    __m128i const               must23= _mm_or_si128( _mm_subs_epu8( prev2, _mm_set1_epi8( (char)( 0xe0U- 0x80U))),
+                                                      _mm_subs_epu8( prev3, _mm_set1_epi8( (char)( 0xf0U- 0x80U))));
+    return  _mm_xor_si128( _mm_and_si128( must23, _mm_set1_epi8( (char)0x80U)), special);
+}
+
+//  utf-8を検証(SSE4.1版。16[byte]ずつ処理)
+__attribute__((target("sse4.1")))
+static size_t   unicodeHelper_validateUTF8SSE41( uint8_t const*const    in_src,
+                                                 size_t const           in_srcLen)
+{
+    //  最後の3[byte]で文字が終わっていないかを見るための上限
+    __m128i const               incompleteMax= _mm_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                              (char)( 0xf0U- 1U), (char)( 0xe0U- 1U), (char)( 0xc0U- 1U));
+    __m128i                     prev= _mm_setzero_si128();
+    __m128i                     prevIncomplete= _mm_setzero_si128();
+    size_t                      idx= 0UL;
+
+    for(;;)
+    {
+        __m128i                     v;
+        if( (size_t)( in_srcLen- idx)>= 16UL)
+        {
+            v                               = _mm_loadu_si128( (__m128i const*)( in_src+ idx));
+        } else {
+            //  最後は0で埋めて調べる(文字が切れていればここで不正になる。残りが無くても前の文字の切れ目を調べる)
+            uint8_t                     buf[ 16]= { 0 };
+            if( idx< in_srcLen) memcpy( &buf[ 0], in_src+ idx, (size_t)( in_srcLen- idx));
+            v                               = _mm_loadu_si128( (__m128i const*)&buf[ 0]);
+        }
+
+        __m128i                     err;
+        if( _mm_movemask_epi8( v)== 0)
+        {
+            err                             = prevIncomplete;
+            prevIncomplete                  = _mm_setzero_si128();
+        } else {
+            err                             = unicodeHelper_utf8ErrorSSE41( v, prev);
+            prevIncomplete                  = _mm_subs_epu8( v, incompleteMax);
+        }
+        if( _mm_testz_si128( err, err)== 0) return  unicodeHelper_validateUTF8Resume( in_src, in_srcLen, idx);
+        if( (size_t)( in_srcLen- idx)< 16UL)    return  in_srcLen;
+
+        prev                            = v;
+        idx                             += 16UL;
+    }
+}
+
+//  32[byte]分のutf-8の不正を調べる(不正なbyteの位置が0以外になる)
+//  in_prevは一つ前の32[byte]
+__attribute__((target("avx2")))
+static inline __m256i   unicodeHelper_utf8ErrorAVX2( __m256i const  in_v,
+                                                     __m256i const  in_prev)
+{
+    __m256i const               m0f= _mm256_set1_epi8( 0x0f);
+    __m256i const               shifted= _mm256_permute2x128_si256( in_prev, in_v, 0x21);
+    __m256i const               prev1= _mm256_alignr_epi8( in_v, shifted, 15);
+    __m256i const               prev2= _mm256_alignr_epi8( in_v, shifted, 14);
+    __m256i const               prev3= _mm256_alignr_epi8( in_v, shifted, 13);
+
+    __m256i const               prevHigh= _mm256_shuffle_epi8( _mm256_setr_epi8( UNICODE_HELPER_UTF8_TABLE_PREV_HIGH, UNICODE_HELPER_UTF8_TABLE_PREV_HIGH),
+                                                               _mm256_and_si256( _mm256_srli_epi16( prev1, 4), m0f));
+    __m256i const               prevLow= _mm256_shuffle_epi8( _mm256_setr_epi8( UNICODE_HELPER_UTF8_TABLE_PREV_LOW, UNICODE_HELPER_UTF8_TABLE_PREV_LOW),
+                                                              _mm256_and_si256( prev1, m0f));
+    __m256i const               curHigh= _mm256_shuffle_epi8( _mm256_setr_epi8( UNICODE_HELPER_UTF8_TABLE_CUR_HIGH, UNICODE_HELPER_UTF8_TABLE_CUR_HIGH),
+                                                              _mm256_and_si256( _mm256_srli_epi16( in_v, 4), m0f));
+    __m256i const               special= _mm256_and_si256( _mm256_and_si256( prevHigh, prevLow), curHigh);
+
+    //  3,4[byte]の文字の3,4[byte]目は続きが二つ並んでいてよい
+    __m256i const               must23= _mm256_or_si256( _mm256_subs_epu8( prev2, _mm256_set1_epi8( (char)( 0xe0U- 0x80U))),
+                                                         _mm256_subs_epu8( prev3, _mm256_set1_epi8( (char)( 0xf0U- 0x80U))));
+    return  _mm256_xor_si256( _mm256_and_si256( must23, _mm256_set1_epi8( (char)0x80U)), special);
+}
+
+//  utf-8を検証(AVX2版。32[byte]ずつ処理)
+__attribute__((target("avx2")))
+static size_t   unicodeHelper_validateUTF8AVX2( uint8_t const*const     in_src,
+                                                size_t const            in_srcLen)
+{
+    //  最後の3[byte]で文字が終わっていないかを見るための上限
+    __m256i const               incompleteMax= _mm256_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                                 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                                 (char)( 0xf0U- 1U), (char)( 0xe0U- 1U), (char)( 0xc0U- 1U));
+    __m256i                     prev= _mm256_setzero_si256();
+    __m256i                     prevIncomplete= _mm256_setzero_si256();
+    size_t                      idx= 0UL;
+
+    for(;;)
+    {
+        __m256i                     v;
+        if( (size_t)( in_srcLen- idx)>= 32UL)
+        {
+            v                               = _mm256_loadu_si256( (__m256i const*)( in_src+ idx));
+        } else {
+            //  最後は0で埋めて調べる(文字が切れていればここで不正になる。残りが無くても前の文字の切れ目を調べる)
+            uint8_t                     buf[ 32]= { 0 };
+            if( idx< in_srcLen) memcpy( &buf[ 0], in_src+ idx, (size_t)( in_srcLen- idx));
+            v                               = _mm256_loadu_si256( (__m256i const*)&buf[ 0]);
+        }
+
+        __m256i                     err;
+        if( _mm256_movemask_epi8( v)== 0)
+        {
+            err                             = prevIncomplete;
+            prevIncomplete                  = _mm256_setzero_si256();
+        } else {
+            err                             = unicodeHelper_utf8ErrorAVX2( v, prev);
+            prevIncomplete                  = _mm256_subs_epu8( v, incompleteMax);
+        }
+        if( _mm256_testz_si256( err, err)== 0)  return  unicodeHelper_validateUTF8Resume( in_src, in_srcLen, idx);
+        if( (size_t)( in_srcLen- idx)< 32UL)    return  in_srcLen;
+
+        prev                            = v;
+        idx                             += 32UL;
+    }
+}
+
+//  utf-16を検証(SSE4.1版。8wordずつ処理)
+//  サロゲートの位置を1word 2[bit]のマスクにして、上位の直後に下位があるかを調べる
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static size_t   unicodeHelper_validateUTF16SSE41( uint8_t const*const   in_src,
+                                                  size_t const          in_srcLen)
+{
+    unsigned int                carry= 0U;  //  直前のwordが上位サロゲートなら3
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 16UL)
+    {
+        __m128i const               v= unicodeHelper_loadUTF16x8<in_order>( in_src+ idx);
+        __m128i const               surrogate= _mm_cmpeq_epi16( _mm_and_si128( v, _mm_set1_epi16( (short)0xf800)), _mm_set1_epi16( (short)0xd800));
+        if( carry== 0U&& _mm_testz_si128( surrogate, surrogate)!= 0)
+        {
+            idx                             += 16UL;
+            continue;
+        }
+
+        unsigned int const          high= (unsigned int)_mm_movemask_epi8(
+                                          _mm_cmpeq_epi16( _mm_and_si128( v, _mm_set1_epi16( (short)0xfc00)), _mm_set1_epi16( (short)0xd800)));
+        unsigned int const          low= (unsigned int)_mm_movemask_epi8( surrogate)& ~high;
+        if( low!= ( ( ( high<< 2)| carry)& 0xffffU))    break;
+        carry                           = high>> 14;
+        idx                             += 16UL;
+    }
+
+    //  残りと不正があったところは一文字ずつ(直前の上位サロゲートから)
+    return  unicodeHelper_validateUTF16Scalar<in_order>( in_src, in_srcLen, ( carry!= 0U)? (size_t)( idx- 2UL): idx);
+}
+
+//  utf-16を検証(AVX2版。16wordずつ処理)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("avx2")))
+static size_t   unicodeHelper_validateUTF16AVX2( uint8_t const*const    in_src,
+                                                 size_t const           in_srcLen)
+{
+    unsigned int                carry= 0U;  //  直前のwordが上位サロゲートなら3
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 32UL)
+    {
+        __m256i                     v= _mm256_loadu_si256( (__m256i const*)( in_src+ idx));
+        if( unicodeHelper_isBigEndianOrder<in_order>())
+        {
+            v                               = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                                                       1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+        }
+        __m256i const               surrogate= _mm256_cmpeq_epi16( _mm256_and_si256( v, _mm256_set1_epi16( (short)0xf800)), _mm256_set1_epi16( (short)0xd800));
+        if( carry== 0U&& _mm256_testz_si256( surrogate, surrogate)!= 0)
+        {
+            idx                             += 32UL;
+            continue;
+        }
+
+        unsigned int const          high= (unsigned int)_mm256_movemask_epi8(
+                                          _mm256_cmpeq_epi16( _mm256_and_si256( v, _mm256_set1_epi16( (short)0xfc00)), _mm256_set1_epi16( (short)0xd800)));
+        unsigned int const          low= (unsigned int)_mm256_movemask_epi8( surrogate)& ~high;
+        if( low!= ( ( high<< 2)| carry))    break;
+        carry                           = high>> 30;
+        idx                             += 32UL;
+    }
+
+    //  残りと不正があったところは一文字ずつ(直前の上位サロゲートから)
+    return  unicodeHelper_validateUTF16Scalar<in_order>( in_src, in_srcLen, ( carry!= 0U)? (size_t)( idx- 2UL): idx);
+}
+
+//  utf-8をutf-16にした場合のサイズを数える(SSE4.1版。16[byte]ずつ継続byteと4[byte]文字の先頭byteを数える)
+__attribute__((target("sse4.1")))
+static size_t   unicodeHelper_countUTF8ToUTF16SSE41( uint8_t const*const    in_src,
+                                                     size_t const           in_srcLen)
+{
+    size_t                      numLead= 0UL;
+    size_t                      numFour= 0UL;
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 16UL)
+    {
+        __m128i const               v= _mm_loadu_si128( (__m128i const*)( in_src+ idx));
+        //  0x80-0xBFは符号付きで-64より小さい
+        unsigned int const          cont= (unsigned int)_mm_movemask_epi8( _mm_cmpgt_epi8( _mm_set1_epi8( (char)-64), v));
+        unsigned int const          four= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( v, _mm_set1_epi8( (char)0xf0)), v));
+        numLead                         += (size_t)( 16U- (unsigned int)__builtin_popcount( cont));
+        numFour                         += (size_t)__builtin_popcount( four);
+        idx                             += 16UL;
+    }
+
+    return  (size_t)( ( numLead+ numFour)* 2UL)+ unicodeHelper_countUTF8ToUTF16Scalar( in_src+ idx, (size_t)( in_srcLen- idx));
+}
+
+//  utf-8をutf-16にした場合のサイズを数える(AVX2版。32[byte]ずつ)
+__attribute__((target("avx2,popcnt")))
+static size_t   unicodeHelper_countUTF8ToUTF16AVX2( uint8_t const*const     in_src,
+                                                    size_t const            in_srcLen)
+{
+    size_t                      numLead= 0UL;
+    size_t                      numFour= 0UL;
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 32UL)
+    {
+        __m256i const               v= _mm256_loadu_si256( (__m256i const*)( in_src+ idx));
+        unsigned int const          cont= (unsigned int)_mm256_movemask_epi8( _mm256_cmpgt_epi8( _mm256_set1_epi8( (char)-64), v));
+        unsigned int const          four= (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_max_epu8( v, _mm256_set1_epi8( (char)0xf0)), v));
+        numLead                         += (size_t)( 32U- (unsigned int)__builtin_popcount( cont));
+        numFour                         += (size_t)__builtin_popcount( four);
+        idx                             += 32UL;
+    }
+
+    return  (size_t)( ( numLead+ numFour)* 2UL)+ unicodeHelper_countUTF8ToUTF16Scalar( in_src+ idx, (size_t)( in_srcLen- idx));
+}
+
+//  utf-16をutf-8にした場合のサイズを数える(SSE4.1版。8wordずつ範囲ごとに数える)
+//  一word 1[byte]に、0x80以上で1、0x800以上でサロゲート以外なら1を足す(movemaskは1wordで2[bit])
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("sse4.1")))
+static size_t   unicodeHelper_countUTF16ToUTF8SSE41( uint8_t const*const    in_src,
+                                                     size_t const           in_srcLen)
+{
+    size_t                      sizeBits= 0UL;
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 16UL)
+    {
+        __m128i const               v= unicodeHelper_loadUTF16x8<in_order>( in_src+ idx);
+        __m128i const               hi5= _mm_and_si128( v, _mm_set1_epi16( (short)0xf800));
+        unsigned int const          ascii= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( v, _mm_set1_epi16( (short)0xff80)), _mm_setzero_si128()));
+        unsigned int const          below800= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi16( hi5, _mm_setzero_si128()));
+        unsigned int const          surrogate= (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi16( hi5, _mm_set1_epi16( (short)0xd800)));
+        sizeBits                        += (size_t)( 48U- (unsigned int)__builtin_popcount( ascii)
+                                                        - (unsigned int)__builtin_popcount( below800| surrogate));
+        idx                             += 16UL;
+    }
+
+    return  (size_t)( sizeBits/ 2UL)+ unicodeHelper_countUTF16ToUTF8Scalar<in_order>( in_src+ idx, (size_t)( in_srcLen- idx));
+}
+
+//  utf-16をutf-8にした場合のサイズを数える(AVX2版。16wordずつ)
+template< unicodeHelperByteOrder in_order>
+__attribute__((target("avx2,popcnt")))
+static size_t   unicodeHelper_countUTF16ToUTF8AVX2( uint8_t const*const     in_src,
+                                                    size_t const            in_srcLen)
+{
+    size_t                      sizeBits= 0UL;
+    size_t                      idx= 0UL;
+
+    while( (size_t)( in_srcLen- idx)>= 32UL)
+    {
+        __m256i                     v= _mm256_loadu_si256( (__m256i const*)( in_src+ idx));
+        if( unicodeHelper_isBigEndianOrder<in_order>())
+        {
+            v                               = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                                                       1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+        }
+        __m256i const               hi5= _mm256_and_si256( v, _mm256_set1_epi16( (short)0xf800));
+        unsigned int const          ascii= (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi16( _mm256_and_si256( v, _mm256_set1_epi16( (short)0xff80)), _mm256_setzero_si256()));
+        unsigned int const          below800= (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi16( hi5, _mm256_setzero_si256()));
+        unsigned int const          surrogate= (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi16( hi5, _mm256_set1_epi16( (short)0xd800)));
+        sizeBits                        += (size_t)( 96U- (unsigned int)__builtin_popcount( ascii)
+                                                        - (unsigned int)__builtin_popcount( below800| surrogate));
+        idx                             += 32UL;
+    }
+
+    return  (size_t)( sizeBits/ 2UL)+ unicodeHelper_countUTF16ToUTF8Scalar<in_order>( in_src+ idx, (size_t)( in_srcLen- idx));
+}
+
+//  byteごとに数えたカウンタを合計する(SSE4.1版)
+__attribute__((target("sse4.1")))
+static inline size_t    unicodeHelper_sumBytesSSE41( __m128i const in_v)
+{
+    __m128i const               sad= _mm_sad_epu8( in_v, _mm_setzero_si128());
+    return  (size_t)( (uint32_t)_mm_extract_epi32( sad, 0)+ (uint32_t)_mm_extract_epi32( sad, 2));
+}
+
+//  byteの種類ごとの個数を数える(SSE4.1版)
+//  byteごとのカウンタに比較結果(-1)を引いて数え、あふれる前(255回ごと)にまとめて合計する
+//  2[byte]先と比べるので、最後の2[byte]はスカラー版で数える
+__attribute__((target("sse4.1")))
+static void unicodeHelper_byteHistogramSSE41( byteHistogram*const   out_histogram,
+                                              uint8_t const*const   in_src,
+                                              size_t const          in_srcLen)
+{
+    __m128i const               evenMask= _mm_set1_epi16( (short)0x00ff);
+    size_t const                sizeVector= ( in_srcLen< 2UL)? 0UL: (size_t)( ( in_srcLen- 2UL)& ~(size_t)15UL);
+    size_t                      idx= 0UL;
+
+    while( idx< sizeVector)
+    {
+        __m128i                     accZeroEven= _mm_setzero_si128();
+        __m128i                     accZeroOdd= _mm_setzero_si128();
+        __m128i                     accHigh= _mm_setzero_si128();
+        __m128i                     accControl= _mm_setzero_si128();
+        __m128i                     accRepeatEven= _mm_setzero_si128();
+        __m128i                     accRepeatOdd= _mm_setzero_si128();
+        size_t const                end= ( (size_t)( sizeVector- idx)> 255UL* 16UL)? (size_t)( idx+ 255UL* 16UL): sizeVector;
+        for( ; idx< end; idx+= 16UL)
+        {
+            __m128i const               v= _mm_loadu_si128( (__m128i const*)( in_src+ idx));
+            __m128i const               isZero= _mm_cmpeq_epi8( v, _mm_setzero_si128());
+            __m128i const               isLow= _mm_cmpeq_epi8( _mm_min_epu8( v, _mm_set1_epi8( 0x1f)), v);
+            __m128i const               fromTab= _mm_sub_epi8( v, _mm_set1_epi8( 0x09));
+            __m128i const               isSpace= _mm_cmpeq_epi8( _mm_min_epu8( fromTab, _mm_set1_epi8( 0x04)), fromTab);
+            __m128i const               isText= _mm_or_si128( _mm_or_si128( isZero, isSpace), _mm_cmpeq_epi8( v, _mm_set1_epi8( 0x1b)));
+            accZeroEven                     = _mm_sub_epi8( accZeroEven, _mm_and_si128( isZero, evenMask));
+            accZeroOdd                      = _mm_sub_epi8( accZeroOdd, _mm_andnot_si128( evenMask, isZero));
+            accHigh                         = _mm_sub_epi8( accHigh, _mm_cmplt_epi8( v, _mm_setzero_si128()));
+            accControl                      = _mm_sub_epi8( accControl, _mm_andnot_si128( isText, isLow));
+            __m128i const               isRepeat= _mm_cmpeq_epi8( v, _mm_loadu_si128( (__m128i const*)( in_src+ idx+ 2UL)));
+            accRepeatEven                   = _mm_sub_epi8( accRepeatEven, _mm_and_si128( isRepeat, evenMask));
+            accRepeatOdd                    = _mm_sub_epi8( accRepeatOdd, _mm_andnot_si128( evenMask, isRepeat));
+        }
+        out_histogram->_zeroEven        += unicodeHelper_sumBytesSSE41( accZeroEven);
+        out_histogram->_zeroOdd         += unicodeHelper_sumBytesSSE41( accZeroOdd);
+        out_histogram->_high            += unicodeHelper_sumBytesSSE41( accHigh);
+        out_histogram->_control         += unicodeHelper_sumBytesSSE41( accControl);
+        out_histogram->_repeatEven      += unicodeHelper_sumBytesSSE41( accRepeatEven);
+        out_histogram->_repeatOdd       += unicodeHelper_sumBytesSSE41( accRepeatOdd);
+    }
+
+    unicodeHelper_byteHistogramScalar( out_histogram, in_src, in_srcLen, idx);
+}
+
+//  byteごとに数えたカウンタを合計する(AVX2版)
+__attribute__((target("avx2")))
+static inline size_t    unicodeHelper_sumBytesAVX2( __m256i const in_v)
+{
+    __m256i const               sad= _mm256_sad_epu8( in_v, _mm256_setzero_si256());
+    __m128i const               sum= _mm_add_epi64( _mm256_castsi256_si128( sad), _mm256_extracti128_si256( sad, 1));
+    return  (size_t)( (uint32_t)_mm_extract_epi32( sum, 0)+ (uint32_t)_mm_extract_epi32( sum, 2));
+}
+
+//  byteの種類ごとの個数を数える(AVX2版。32[byte]ずつ)
+__attribute__((target("avx2")))
+static void unicodeHelper_byteHistogramAVX2( byteHistogram*const    out_histogram,
+                                             uint8_t const*const    in_src,
+                                             size_t const           in_srcLen)
+{
+    __m256i const               evenMask= _mm256_set1_epi16( (short)0x00ff);
+    size_t const                sizeVector= ( in_srcLen< 2UL)? 0UL: (size_t)( ( in_srcLen- 2UL)& ~(size_t)31UL);
+    size_t                      idx= 0UL;
+
+    while( idx< sizeVector)
+    {
+        __m256i                     accZeroEven= _mm256_setzero_si256();
+        __m256i                     accZeroOdd= _mm256_setzero_si256();
+        __m256i                     accHigh= _mm256_setzero_si256();
+        __m256i                     accControl= _mm256_setzero_si256();
+        __m256i                     accRepeatEven= _mm256_setzero_si256();
+        __m256i                     accRepeatOdd= _mm256_setzero_si256();
+        size_t const                end= ( (size_t)( sizeVector- idx)> 255UL* 32UL)? (size_t)( idx+ 255UL* 32UL): sizeVector;
+        for( ; idx< end; idx+= 32UL)
+        {
+            __m256i const               v= _mm256_loadu_si256( (__m256i const*)( in_src+ idx));
+            __m256i const               isZero= _mm256_cmpeq_epi8( v, _mm256_setzero_si256());
+            __m256i const               isLow= _mm256_cmpeq_epi8( _mm256_min_epu8( v, _mm256_set1_epi8( 0x1f)), v);
+            __m256i const               fromTab= _mm256_sub_epi8( v, _mm256_set1_epi8( 0x09));
+            __m256i const               isSpace= _mm256_cmpeq_epi8( _mm256_min_epu8( fromTab, _mm256_set1_epi8( 0x04)), fromTab);
+            __m256i const               isText= _mm256_or_si256( _mm256_or_si256( isZero, isSpace), _mm256_cmpeq_epi8( v, _mm256_set1_epi8( 0x1b)));
+            accZeroEven                     = _mm256_sub_epi8( accZeroEven, _mm256_and_si256( isZero, evenMask));
+            accZeroOdd                      = _mm256_sub_epi8( accZeroOdd, _mm256_andnot_si256( evenMask, isZero));
+            accHigh                         = _mm256_sub_epi8( accHigh, _mm256_cmpgt_epi8( _mm256_setzero_si256(), v));
+            accControl                      = _mm256_sub_epi8( accControl, _mm256_andnot_si256( isText, isLow));
+            __m256i const               isRepeat= _mm256_cmpeq_epi8( v, _mm256_loadu_si256( (__m256i const*)( in_src+ idx+ 2UL)));
+            accRepeatEven                   = _mm256_sub_epi8( accRepeatEven, _mm256_and_si256( isRepeat, evenMask));
+            accRepeatOdd                    = _mm256_sub_epi8( accRepeatOdd, _mm256_andnot_si256( evenMask, isRepeat));
+        }
+        out_histogram->_zeroEven        += unicodeHelper_sumBytesAVX2( accZeroEven);
+        out_histogram->_zeroOdd         += unicodeHelper_sumBytesAVX2( accZeroOdd);
+        out_histogram->_high            += unicodeHelper_sumBytesAVX2( accHigh);
+        out_histogram->_control         += unicodeHelper_sumBytesAVX2( accControl);
+        out_histogram->_repeatEven      += unicodeHelper_sumBytesAVX2( accRepeatEven);
+        out_histogram->_repeatOdd       += unicodeHelper_sumBytesAVX2( accRepeatOdd);
+    }
+
+    unicodeHelper_byteHistogramScalar( out_histogram, in_src, in_srcLen, idx);
+}
+
+#undef  UNICODE_HELPER_UTF8_TABLE_PREV_HIGH
+#undef  UNICODE_HELPER_UTF8_TABLE_PREV_LOW
+#undef  UNICODE_HELPER_UTF8_TABLE_CUR_HIGH
+
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+
+//  命令セットに合わせたutf-8からutf-16への変換関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static convertBufferFunc    unicodeHelper_selectUTF8ToUTF16( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_utf8ToUTF16AVX2<in_order>;
+    case    simdLevel_sse41:    return  unicodeHelper_utf8ToUTF16SSE41<in_order>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_utf8ToUTF16Scalar<in_order>;
+}
+
+//  命令セットに合わせたutf-16からutf-8への変換関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static convertBufferFunc    unicodeHelper_selectUTF16ToUTF8( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_utf16ToUTF8AVX2<in_order>;
+    case    simdLevel_sse41:    return  unicodeHelper_utf16ToUTF8SSE41<in_order>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_utf16ToUTF8Scalar<in_order>;
+}
+
+//  命令セットに合わせたutf-16の検証関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static validateFunc unicodeHelper_selectValidateUTF16( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_validateUTF16AVX2<in_order>;
+    case    simdLevel_sse41:    return  unicodeHelper_validateUTF16SSE41<in_order>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_validateUTF16Start<in_order>;
+}
+
+//  命令セットに合わせたutf-8の検証関数を選ぶ
+static validateFunc unicodeHelper_selectValidateUTF8( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_validateUTF8AVX2;
+    case    simdLevel_sse41:    return  unicodeHelper_validateUTF8SSE41;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_validateUTF8Scalar;
+}
+
+//  命令セットに合わせたutf-8からutf-16の出力サイズを数える関数を選ぶ
+static measureFunc  unicodeHelper_selectMeasureUTF8ToUTF16( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8AVX2, unicodeHelper_countUTF8ToUTF16AVX2>;
+    case    simdLevel_sse41:    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8SSE41, unicodeHelper_countUTF8ToUTF16SSE41>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8Scalar, unicodeHelper_countUTF8ToUTF16Scalar>;
+}
+
+//  命令セットに合わせたutf-8からutf-8の出力サイズを数える関数を選ぶ
+static measureFunc  unicodeHelper_selectMeasureUTF8ToUTF8( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8AVX2, unicodeHelper_countSame>;
+    case    simdLevel_sse41:    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8SSE41, unicodeHelper_countSame>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF8Scalar, unicodeHelper_countSame>;
+}
+
+//  命令セットに合わせたutf-16からutf-8の出力サイズを数える関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static measureFunc  unicodeHelper_selectMeasureUTF16ToUTF8( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16AVX2<in_order>, unicodeHelper_countUTF16ToUTF8AVX2<in_order> >;
+    case    simdLevel_sse41:    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16SSE41<in_order>, unicodeHelper_countUTF16ToUTF8SSE41<in_order> >;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16Start<in_order>, unicodeHelper_countUTF16ToUTF8Scalar<in_order> >;
+}
+
+//  命令セットに合わせたutf-16からutf-16の出力サイズを数える関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static measureFunc  unicodeHelper_selectMeasureUTF16ToUTF16( void)
+{
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16AVX2<in_order>, unicodeHelper_countSame>;
+    case    simdLevel_sse41:    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16SSE41<in_order>, unicodeHelper_countSame>;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    return  unicodeHelper_measureCounted< unicodeHelper_validateUTF16Start<in_order>, unicodeHelper_countSame>;
+}
+
+//  utf-16が入力の場合の出力サイズを数える関数を選ぶ
+template< unicodeHelperByteOrder in_order>
+static measureFunc  unicodeHelper_selectMeasureUTF16( unicodeHelperEncoding const in_ecDst)
+{
+    switch( in_ecDst)
+    {
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_selectMeasureUTF16ToUTF8<in_order>();
+    case    unicodeHelperEncoding_utf16arch:
+    case    unicodeHelperEncoding_utf16le:
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectMeasureUTF16ToUTF16<in_order>();
+    default:                                    break;
+    }
+    return  (measureFunc)0;
+}
+
+convertBufferFunc   unicodeHelper_simdGetConvertBufferFunc( unicodeHelperEncoding const  in_ecDst,
+                                                            unicodeHelperEncoding const  in_ecSrc)
+{
+    if( in_ecSrc== unicodeHelperEncoding_utf8)
+    {
+        switch( in_ecDst)
+        {
+        case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_selectUTF8ToUTF16<unicodeHelperByteOrder_arch>();
+        case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_selectUTF8ToUTF16<unicodeHelperByteOrder_le>();
+        case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectUTF8ToUTF16<unicodeHelperByteOrder_be>();
+        default:                                    break;
+        }
+    }
+    if( in_ecDst== unicodeHelperEncoding_utf8)
+    {
+        switch( in_ecSrc)
+        {
+        case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_selectUTF16ToUTF8<unicodeHelperByteOrder_arch>();
+        case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_selectUTF16ToUTF8<unicodeHelperByteOrder_le>();
+        case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectUTF16ToUTF8<unicodeHelperByteOrder_be>();
+        default:                                    break;
+        }
+    }
+
+    return  (convertBufferFunc)0;
+}
+
+measureFunc unicodeHelper_simdGetMeasureFunc( unicodeHelperEncoding const  in_ecDst,
+                                              unicodeHelperEncoding const  in_ecSrc)
+{
+    switch( in_ecSrc)
+    {
+    case    unicodeHelperEncoding_utf8:
+        switch( in_ecDst)
+        {
+        case    unicodeHelperEncoding_utf8:         return  unicodeHelper_selectMeasureUTF8ToUTF8();
+        case    unicodeHelperEncoding_utf16arch:
+        case    unicodeHelperEncoding_utf16le:
+        case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectMeasureUTF8ToUTF16();
+        default:                                    break;
+        }
+        break;
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_selectMeasureUTF16<unicodeHelperByteOrder_arch>( in_ecDst);
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_selectMeasureUTF16<unicodeHelperByteOrder_le>( in_ecDst);
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectMeasureUTF16<unicodeHelperByteOrder_be>( in_ecDst);
+    default:                                    break;
+    }
+
+    return  (measureFunc)0;
+}
+
+void    unicodeHelper_simdByteHistogram( byteHistogram*const   out_histogram,
+                                         uint8_t const*const   in_src,
+                                         size_t const          in_srcLen)
+{
+    out_histogram->_zeroEven        = 0UL;
+    out_histogram->_zeroOdd         = 0UL;
+    out_histogram->_high            = 0UL;
+    out_histogram->_control         = 0UL;
+    out_histogram->_repeatEven      = 0UL;
+    out_histogram->_repeatOdd       = 0UL;
+
+#if         defined(UNICODE_HELPER_SIMD_X86)
+    switch( unicodeHelper_simdLevel())
+    {
+    case    simdLevel_avx2:     unicodeHelper_byteHistogramAVX2( out_histogram, in_src, in_srcLen);     return;
+    case    simdLevel_sse41:    unicodeHelper_byteHistogramSSE41( out_histogram, in_src, in_srcLen);    return;
+    default:                    break;
+    }
+#endif  //  defined(UNICODE_HELPER_SIMD_X86)
+    unicodeHelper_byteHistogramScalar( out_histogram, in_src, in_srcLen, 0UL);
+}
+
+validateFunc    unicodeHelper_simdGetValidateFunc( unicodeHelperEncoding const in_encoding)
+{
+    switch( in_encoding)
+    {
+    case    unicodeHelperEncoding_utf8:         return  unicodeHelper_selectValidateUTF8();
+    case    unicodeHelperEncoding_utf16arch:    return  unicodeHelper_selectValidateUTF16<unicodeHelperByteOrder_arch>();
+    case    unicodeHelperEncoding_utf16le:      return  unicodeHelper_selectValidateUTF16<unicodeHelperByteOrder_le>();
+    case    unicodeHelperEncoding_utf16be:      return  unicodeHelper_selectValidateUTF16<unicodeHelperByteOrder_be>();
+    default:                                    break;
+    }
+
+    return  (validateFunc)0;
+}
+
+//  End of Source [text/unicodeHelperSimd.cpp]
@@ -0,0 +1,337 @@
+/// @file   text/unicodeHelperString.h
+/// @brief  std::string/std::u16string/std::u32string間の変換(C++17)
+/// @note   出力先はunicodeHelperBoundSize()の上限(大きい入力で上限が緩い場合はunicodeHelperMeasure()で数えた
+/// サイズ)で一度だけ広げ、unicodeHelperConvertBuffer()で直接書き込んでから実際のサイズに縮める。
+/// append〜()は呼び出し側の文字列の後ろに足すので、clear()した文字列を渡せば確保済みの領域を使い回せる。
+/// std::u16stringは実行中のcpuに添ったエンディアン(utf16arch)、std::u32stringはutf-32として扱う。
+/// 入力の先頭のBOMは出力しない。
+#ifndef             TEXT_UNICODE_HELPER_STRING_H___
+#define             TEXT_UNICODE_HELPER_STRING_H___
+
+#include "unicodeHelper.h"
+#include "unicodeHelperTemplate.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace   unicodeHelper
+{
+
+/// @fn unicodeHelper::append
+/// @brief  メモリ上のデータをエンコード変更して文字列の後ろに足す
+/// @param  io_dst      出力先(std::stringかstd::u16string。in_ecDstの出力が要素のサイズで割り切れること)
+/// @param  in_ecDst    出力先エンコード
+/// @param  in_src      入力元
+/// @param  in_srcLen   入力元のサイズ([byte])
+/// @param  in_ecSrc    入力元エンコード
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @retval 0   全部は変換出来なかった(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+/// @note   上限が入力の2倍を超える(コードページからutf-8)64[MiB]以上の入力は、
+/// 確保しすぎないようにunicodeHelperMeasure()で数えてから確保する(それより小さければ数える方が遅い)。
+template< typename in_String>
+inline signed int   append( in_String*const             io_dst,
+                            unicodeHelperEncoding const in_ecDst,
+                            void const*const            in_src,
+                            size_t const                in_srcLen,
+                            unicodeHelperEncoding const in_ecSrc,
+                            uint32_t const              in_flags= unicodeHelperConvertFlag_none)
+{
+    typedef typename in_String::value_type  charType;
+
+    uint8_t const*const         pSrc= static_cast<uint8_t const*>( in_src);
+    size_t const                szOld= io_dst->size();
+    size_t                      capacity= unicodeHelperBoundSize( in_srcLen, in_ecDst, in_ecSrc, in_flags);
+    if( capacity> in_srcLen* 2&& in_srcLen>= 64* 1024* 1024)
+    {
+        unicodeHelperMeasure( &capacity, pSrc, in_srcLen, in_ecDst, in_ecSrc, in_flags);
+    }
+
+    io_dst->resize( szOld+ ( capacity+ sizeof(charType)- 1)/ sizeof(charType));
+    size_t                      written= 0;
+    signed int const            result= unicodeHelperConvertBuffer( reinterpret_cast<uint8_t*>( io_dst->data()+ szOld), capacity, &written,
+                                                                    pSrc, in_srcLen, static_cast<size_t*>( 0),
+                                                                    in_ecDst, in_ecSrc, in_flags);
+    io_dst->resize( szOld+ written/ sizeof(charType));
+    return  result;
+}
+
+/// @fn unicodeHelper::appendDecoded
+/// @brief  utf-8かutf-16のbyte列をutf-32にしてstd::u32stringの後ろに足す
+/// @tparam in_Src  入力元エンコードの型(utf8、utf16arch/le/be)
+/// @retval 0   不正な入力か、最後で文字が切れている(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+template< typename in_Src>
+inline signed int   appendDecoded( std::u32string*const     io_dst,
+                                   void const*const         in_src,
+                                   size_t const             in_srcLen)
+{
+    //  一文字はutf-8なら1[byte]以上、utf-16なら2[byte]以上
+    size_t const                szUnit= std::is_same<in_Src, utf8>::value? 1: 2;
+    uint8_t const*const         pSrc= static_cast<uint8_t const*>( in_src);
+    size_t const                szOld= io_dst->size();
+    io_dst->resize( szOld+ in_srcLen/ szUnit);
+
+    char32_t*const              pDst= io_dst->data()+ szOld;
+    size_t                      idx= 0;
+    size_t                      num= 0;
+    signed int                  result= -1;
+    uint32_t                    unicode;
+
+    //  BOMがあったらスキップ
+    signed int const            szTop= codec<in_Src>::decode( &unicode, pSrc, in_srcLen);
+    if( szTop> 0&& unicode== 0x0000feffUL)  idx= (size_t)szTop;
+
+    while( idx< in_srcLen)
+    {
+        signed int const            szIn= codec<in_Src>::decode( &unicode, pSrc+ idx, (size_t)( in_srcLen- idx));
+        if( szIn<= 0)
+        {
+            result                          = 0;
+            break;
+        }
+        pDst[ num++]                    = (char32_t)unicode;
+        idx                             += (size_t)szIn;
+    }
+
+    io_dst->resize( szOld+ num);
+    return  result;
+}
+
+/// @fn unicodeHelper::appendEncoded
+/// @brief  utf-32をutf-8かutf-16にして文字列の後ろに足す
+/// @tparam in_Dst  出力先エンコードの型(utf8、utf16arch/le/be)
+/// @retval 0   サロゲートかU+10FFFFより大きい値があった(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+template< typename in_Dst, typename in_String>
+inline signed int   appendEncoded( in_String*const          io_dst,
+                                   std::u32string_view      in_src)
+{
+    typedef typename in_String::value_type  charType;
+
+    //  一文字はutf-8でもutf-16でも4[byte]以下
+    size_t const                szOld= io_dst->size();
+    io_dst->resize( szOld+ in_src.size()* 4/ sizeof(charType));
+
+    uint8_t*const               pDst= reinterpret_cast<uint8_t*>( io_dst->data()+ szOld);
+    size_t                      idx= 0;
+    size_t                      written= 0;
+    signed int                  result= -1;
+
+    //  BOMがあったらスキップ
+    if( in_src.empty()== false&& in_src[ 0]== 0x0000feffUL)    idx= 1;
+
+    for( ; idx< in_src.size(); idx++)
+    {
+        uint32_t const              unicode= (uint32_t)in_src[ idx];
+        signed int const            szOut= ( (uint32_t)( unicode& 0xfffff800UL)!= 0x0000d800UL)? codec<in_Dst>::encode( pDst+ written, unicode): 0;
+        if( szOut== 0)
+        {
+            result                          = 0;
+            break;
+        }
+        written                         += (size_t)szOut;
+    }
+
+    io_dst->resize( szOld+ written/ sizeof(charType));
+    return  result;
+}
+
+/// @fn unicodeHelper::appendUTF8
+/// @brief  utf-8にしてstd::stringの後ろに足す
+/// @param  io_dst      出力先
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @retval 0   全部は変換出来なかった(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+inline signed int   appendUTF8( std::string*const           io_dst,
+                                std::string_view const      in_src,
+                                unicodeHelperEncoding const in_ecSrc)
+{
+    return  append( io_dst, unicodeHelperEncoding_utf8, in_src.data(), in_src.size(), in_ecSrc);
+}
+
+inline signed int   appendUTF8( std::string*const           io_dst,
+                                std::u16string_view const   in_src)
+{
+    return  append( io_dst, unicodeHelperEncoding_utf8, in_src.data(), in_src.size()* sizeof(char16_t), unicodeHelperEncoding_utf16arch);
+}
+
+inline signed int   appendUTF8( std::string*const           io_dst,
+                                std::u32string_view const   in_src)
+{
+    return  appendEncoded<utf8>( io_dst, in_src);
+}
+
+/// @fn unicodeHelper::appendUTF16
+/// @brief  utf-16(utf16arch)にしてstd::u16stringの後ろに足す
+/// @param  io_dst      出力先
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @retval 0   全部は変換出来なかった(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+inline signed int   appendUTF16( std::u16string*const           io_dst,
+                                 std::string_view const         in_src,
+                                 unicodeHelperEncoding const    in_ecSrc= unicodeHelperEncoding_utf8)
+{
+    return  append( io_dst, unicodeHelperEncoding_utf16arch, in_src.data(), in_src.size(), in_ecSrc);
+}
+
+inline signed int   appendUTF16( std::u16string*const           io_dst,
+                                 std::u32string_view const      in_src)
+{
+    return  appendEncoded<utf16arch>( io_dst, in_src);
+}
+
+/// @fn unicodeHelper::appendUTF32
+/// @brief  utf-32にしてstd::u32stringの後ろに足す
+/// @param  io_dst      出力先
+/// @param  in_src      入力元(std::stringはutf-8)
+/// @retval 0   全部は変換出来なかった(*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+inline signed int   appendUTF32( std::u32string*const           io_dst,
+                                 std::string_view const         in_src)
+{
+    return  appendDecoded<utf8>( io_dst, in_src.data(), in_src.size());
+}
+
+inline signed int   appendUTF32( std::u32string*const           io_dst,
+                                 std::u16string_view const      in_src)
+{
+    return  appendDecoded<utf16arch>( io_dst, in_src.data(), in_src.size()* sizeof(char16_t));
+}
+
+/// @fn unicodeHelper::appendCP932
+/// @brief  cp932にしてstd::stringの後ろに足す
+/// @param  io_dst      出力先
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @retval 0   全部は変換出来なかった(cp932に無い文字も含む。*io_dstには変換できたところまでが足される)
+/// @retval その他  全部変換出来た
+inline signed int   appendCP932( std::string*const              io_dst,
+                                 std::string_view const         in_src,
+                                 unicodeHelperEncoding const    in_ecSrc= unicodeHelperEncoding_utf8)
+{
+    return  append( io_dst, unicodeHelperEncoding_cp932, in_src.data(), in_src.size(), in_ecSrc);
+}
+
+inline signed int   appendCP932( std::string*const              io_dst,
+                                 std::u16string_view const      in_src)
+{
+    return  append( io_dst, unicodeHelperEncoding_cp932, in_src.data(), in_src.size()* sizeof(char16_t), unicodeHelperEncoding_utf16arch);
+}
+
+/// @fn unicodeHelper::toUTF8
+/// @brief  utf-8のstd::stringに変換
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @param  out_result  成否の格納先(不要ならNULL。値はappendUTF8()の戻り値と同じ)
+/// @return 変換した文字列(失敗した場合は変換できたところまで)
+inline std::string  toUTF8( std::string_view const      in_src,
+                            unicodeHelperEncoding const in_ecSrc,
+                            signed int*const            out_result= 0)
+{
+    std::string                 result;
+    signed int const            isDone= appendUTF8( &result, in_src, in_ecSrc);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+inline std::string  toUTF8( std::u16string_view const   in_src,
+                            signed int*const            out_result= 0)
+{
+    std::string                 result;
+    signed int const            isDone= appendUTF8( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+inline std::string  toUTF8( std::u32string_view const   in_src,
+                            signed int*const            out_result= 0)
+{
+    std::string                 result;
+    signed int const            isDone= appendUTF8( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+/// @fn unicodeHelper::toUTF16
+/// @brief  utf-16(utf16arch)のstd::u16stringに変換
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @param  out_result  成否の格納先(不要ならNULL。値はappendUTF16()の戻り値と同じ)
+/// @return 変換した文字列(失敗した場合は変換できたところまで)
+inline std::u16string   toUTF16( std::string_view const         in_src,
+                                 unicodeHelperEncoding const    in_ecSrc= unicodeHelperEncoding_utf8,
+                                 signed int*const               out_result= 0)
+{
+    std::u16string              result;
+    signed int const            isDone= appendUTF16( &result, in_src, in_ecSrc);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+inline std::u16string   toUTF16( std::u32string_view const      in_src,
+                                 signed int*const               out_result= 0)
+{
+    std::u16string              result;
+    signed int const            isDone= appendUTF16( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+/// @fn unicodeHelper::toUTF32
+/// @brief  utf-32のstd::u32stringに変換
+/// @param  in_src      入力元(std::stringはutf-8)
+/// @param  out_result  成否の格納先(不要ならNULL。値はappendUTF32()の戻り値と同じ)
+/// @return 変換した文字列(失敗した場合は変換できたところまで)
+inline std::u32string   toUTF32( std::string_view const         in_src,
+                                 signed int*const               out_result= 0)
+{
+    std::u32string              result;
+    signed int const            isDone= appendUTF32( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+inline std::u32string   toUTF32( std::u16string_view const      in_src,
+                                 signed int*const               out_result= 0)
+{
+    std::u32string              result;
+    signed int const            isDone= appendUTF32( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+/// @fn unicodeHelper::toCP932
+/// @brief  cp932のstd::stringに変換
+/// @param  in_src      入力元(std::stringの場合はin_ecSrcで指定したエンコード)
+/// @param  in_ecSrc    入力元エンコード
+/// @param  out_result  成否の格納先(不要ならNULL。値はappendCP932()の戻り値と同じ)
+/// @return 変換した文字列(失敗した場合は変換できたところまで)
+inline std::string  toCP932( std::string_view const         in_src,
+                             unicodeHelperEncoding const    in_ecSrc= unicodeHelperEncoding_utf8,
+                             signed int*const               out_result= 0)
+{
+    std::string                 result;
+    signed int const            isDone= appendCP932( &result, in_src, in_ecSrc);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+inline std::string  toCP932( std::u16string_view const      in_src,
+                             signed int*const               out_result= 0)
+{
+    std::string                 result;
+    signed int const            isDone= appendCP932( &result, in_src);
+    if( out_result!= 0) *out_result= isDone;
+    return  result;
+}
+
+}   //  namespace   unicodeHelper
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_STRING_H___
+//  End of Source [text/unicodeHelperString.h]
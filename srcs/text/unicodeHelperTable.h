@@ -0,0 +1,94 @@
+/// @file   text/unicodeHelperTable.h
+/// @brief  convunicodeorgが出力する表の型と引き方(ライブラリ内部と計測ツール用)
+#ifndef             TEXT_UNICODE_HELPER_TABLE_H___
+#define             TEXT_UNICODE_HELPER_TABLE_H___
+
+#include "unicodeHelperCodec.h"
+#include <stdint.h>
+
+//  コードと対応先の対(コード順に並べて二分探索)
+typedef struct {
+    uint16_t                    source;
+    uint16_t                    destination;
+} s2d;
+
+//  連続したコードの区間(convunicodeorgが出力する組み込みの表はこの名前で書く)
+typedef unicodeHelperRun        s2dRun;
+
+//  実行時に読み込む表のファイル(convunicodeorgが出力する)の先頭
+//  各表はtableFileAlign[byte]境界に置かれ、数値はすべてlittle endian
+typedef struct {
+    char                        magic[ 8];      //  tableFileMagic
+    uint32_t                    version;        //  tableFileVersion
+    uint32_t                    byteOrder;      //  tableFileByteOrder(読み込む側と並びが違えば値が変わる)
+    uint32_t                    fileSize;       //  ファイル全体のサイズ([byte])
+    uint32_t                    numC2ucRows;    //  コード->unicodeの表の行数
+    uint32_t                    numUc2cRows;    //  unicode->コードの表の行数
+    uint32_t                    ofsC2ucRow;     //  コード->unicodeの行の番号(uint8_t[256])の位置([byte])
+    uint32_t                    ofsC2ucTable;   //  コード->unicodeの表(uint16_t[行数* 256])の位置([byte])
+    uint32_t                    ofsUc2cRow;     //  unicode->コードの行の番号の位置([byte])
+    uint32_t                    ofsUc2cTable;   //  unicode->コードの表の位置([byte])
+    uint32_t                    ofsTrail;       //  先頭byteごとに続くbyte数(uint8_t[256])の位置([byte])
+    char                        name[ 16];      //  表の名前(0終端)
+} tableFileHeader;
+
+static char const               tableFileMagic[ 8]= "UHTABLE";
+static uint32_t const           tableFileVersion= 2UL;
+static uint32_t const           tableFileByteOrder= 0x01020304UL;
+static uint32_t const           tableFileAlign= 64UL;
+
+//  unicodeHelperLoadTable()で読み込んだ表(中身はmapしたファイルを直接指す)
+struct unicodeHelperTable_ {
+    void const*                 map;            //  mapしたファイルの先頭
+    size_t                      mapSize;        //  mapしたサイズ([byte])
+    unicodeHelperCodepageView   view;           //  表(二段の表だけで、区間の表は持たない)
+    char const*                 name;           //  表の名前(tableFileHeaderのname。convunicodeorgに渡したラベル)
+};
+
+//  テーブル内にあるsourceと一致するdestinationを返す
+static inline uint16_t  unicodeHelper_search( s2d const*const   in_table,
+                                              uint32_t const    in_num,
+                                              uint16_t const    in_source,
+                                              uint16_t const    in_unHitDest)
+{
+    s2d const*                  pTableTop( in_table);
+    uint32_t                    numCur( in_num);
+    static uint32_t const       bsGran= 10UL;
+
+    for(;;)
+    {
+        if( numCur< bsGran)
+        {
+            s2d const*const             tableTerm( pTableTop+ numCur);
+            for( s2d const* pCur= pTableTop; pCur!= tableTerm; pCur++)
+            {
+                uint16_t const              srcCur( pCur->source);
+
+                if( srcCur< in_source)  continue;
+                if( srcCur> in_source)  break;
+
+                return  pCur->destination;
+            }
+            break;
+        } else {
+            uint32_t                    idxMdl( static_cast<uint32_t>( numCur>> 1));
+            s2d const*const             pCur( static_cast<s2d const*>( pTableTop+ idxMdl));
+            uint16_t const              srcCur( pCur->source);
+
+            if( srcCur< in_source)
+            {
+                pTableTop                       = pCur+ 1;
+                numCur                          = static_cast<uint32_t>( numCur- static_cast<uint32_t>( idxMdl+ 1UL));
+            } else if( srcCur> in_source)
+            {
+                numCur                          = idxMdl;
+            } else {
+                return  pCur->destination;
+            }
+        }
+    }
+    return  in_unHitDest;
+}
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_TABLE_H___
+//  End of Source [text/unicodeHelperTable.h]
@@ -0,0 +1,147 @@
+/// @file   text/unicodeHelperTableFile.cpp
+/// @brief  convunicodeorgが出力した表のファイルを実行時に読み込む
+#include "unicodeHelper.h"
+#include "unicodeHelperInternal.h"
+#include "unicodeHelperTable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if         defined(__unix__) || defined(__APPLE__)
+#define UNICODE_HELPER_TABLE_MMAP   1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  //  defined(__unix__) || defined(__APPLE__)
+
+#if         defined(UNICODE_HELPER_TABLE_MMAP)
+
+//  in_ofsからin_size[byte]がファイルに収まり、境界も合っているか
+static bool unicodeHelper_isTableRangeOk( uint32_t const    in_ofs,
+                                          uint32_t const    in_size,
+                                          uint32_t const    in_fileSize)
+{
+    return  ( in_ofs% tableFileAlign)== 0UL
+            && in_ofs>= (uint32_t)sizeof(tableFileHeader)
+            && in_ofs<= in_fileSize
+            && in_size<= (uint32_t)( in_fileSize- in_ofs);
+}
+
+//  in_numより小さい値だけが並んでいるか(行の番号や、先頭byteに続くbyte数の確認用)
+static bool unicodeHelper_isTableIndexOk( uint8_t const*const   in_index,
+                                          uint32_t const        in_num)
+{
+    for( uint32_t idx= 0UL; idx< 256UL; idx++)
+    {
+        if( (uint32_t)in_index[ idx]>= in_num)  return  false;
+    }
+    return  true;
+}
+
+//  mapしたファイルの先頭を確かめ、表の位置を埋める
+static bool unicodeHelper_setupTable( unicodeHelperTable*const  out_table,
+                                      uint8_t const*const       in_map,
+                                      size_t const              in_mapSize)
+{
+    if( in_mapSize< sizeof(tableFileHeader))    return  false;
+
+    tableFileHeader const*const pHeader= (tableFileHeader const*)in_map;
+    if( memcmp( pHeader->magic, tableFileMagic, sizeof(tableFileMagic))!= 0
+        || pHeader->version!= tableFileVersion
+        || pHeader->byteOrder!= tableFileByteOrder
+        || (size_t)pHeader->fileSize!= in_mapSize
+        || pHeader->numC2ucRows== 0UL || pHeader->numC2ucRows> 256UL
+        || pHeader->numUc2cRows== 0UL || pHeader->numUc2cRows> 256UL
+        || memchr( pHeader->name, 0, sizeof(pHeader->name))== 0)
+    {
+        return  false;
+    }
+
+    uint32_t const              fileSize= pHeader->fileSize;
+    if( unicodeHelper_isTableRangeOk( pHeader->ofsC2ucRow,   256UL,                                          fileSize)== false
+        || unicodeHelper_isTableRangeOk( pHeader->ofsC2ucTable, (uint32_t)( pHeader->numC2ucRows* 256UL* 2UL), fileSize)== false
+        || unicodeHelper_isTableRangeOk( pHeader->ofsUc2cRow,   256UL,                                          fileSize)== false
+        || unicodeHelper_isTableRangeOk( pHeader->ofsUc2cTable, (uint32_t)( pHeader->numUc2cRows* 256UL* 2UL), fileSize)== false
+        || unicodeHelper_isTableRangeOk( pHeader->ofsTrail,     256UL,                                          fileSize)== false)
+    {
+        return  false;
+    }
+
+    uint8_t const*const         pC2ucRow= in_map+ pHeader->ofsC2ucRow;
+    uint8_t const*const         pUc2cRow= in_map+ pHeader->ofsUc2cRow;
+    uint8_t const*const         pTrail= in_map+ pHeader->ofsTrail;
+    if( unicodeHelper_isTableIndexOk( pC2ucRow, pHeader->numC2ucRows)== false
+        || unicodeHelper_isTableIndexOk( pUc2cRow, pHeader->numUc2cRows)== false
+        || unicodeHelper_isTableIndexOk( pTrail, 2UL)== false)
+    {
+        return  false;
+    }
+
+    out_table->map                  = in_map;
+    out_table->mapSize              = in_mapSize;
+    memset( &out_table->view, 0, sizeof(out_table->view));
+    out_table->view._trail          = pTrail;
+    out_table->view._c2ucRow        = pC2ucRow;
+    out_table->view._c2ucTable      = (uint16_t const*)( in_map+ pHeader->ofsC2ucTable);
+    out_table->view._uc2cRow        = pUc2cRow;
+    out_table->view._uc2cTable      = (uint16_t const*)( in_map+ pHeader->ofsUc2cTable);
+    out_table->name                 = pHeader->name;
+    return  true;
+}
+
+#endif  //  defined(UNICODE_HELPER_TABLE_MMAP)
+
+//  表のファイルを読み込み専用でmapする
+UNICODEHELPER_EXTERN_C unicodeHelperTable const*    unicodeHelperLoadTable( char const*const   in_path)
+{
+#if         defined(UNICODE_HELPER_TABLE_MMAP)
+    if( in_path== 0)    return  0;
+
+    int const                   fd= open( in_path, O_RDONLY| O_CLOEXEC);
+    if( fd< 0)  return  0;
+
+    struct stat                 st;
+    if( fstat( fd, &st)!= 0
+        || st.st_size< (off_t)sizeof(tableFileHeader)
+        || (uint64_t)st.st_size> (uint64_t)UINT32_MAX)
+    {
+        close( fd);
+        return  0;
+    }
+
+    size_t const                mapSize= (size_t)st.st_size;
+    void*const                  pMap= mmap( 0, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close( fd);
+    if( pMap== MAP_FAILED)  return  0;
+
+    unicodeHelperTable*const    pTable= (unicodeHelperTable*)malloc( sizeof(unicodeHelperTable));
+    if( pTable== 0
+        || unicodeHelper_setupTable( pTable, (uint8_t const*)pMap, mapSize)== false)
+    {
+        free( pTable);
+        munmap( pMap, mapSize);
+        return  0;
+    }
+    return  pTable;
+#else   //  defined(UNICODE_HELPER_TABLE_MMAP)
+    (void)in_path;
+    return  0;
+#endif  //  defined(UNICODE_HELPER_TABLE_MMAP)
+}
+
+//  読み込んだ表を解放
+UNICODEHELPER_EXTERN_C void     unicodeHelperUnloadTable( unicodeHelperTable const*const   in_table)
+{
+#if         defined(UNICODE_HELPER_TABLE_MMAP)
+    if( in_table== 0)   return;
+
+    unicodeHelper_unbindTable( in_table);
+    munmap( (void*)in_table->map, in_table->mapSize);
+    free( (void*)in_table);
+#else   //  defined(UNICODE_HELPER_TABLE_MMAP)
+    (void)in_table;
+#endif  //  defined(UNICODE_HELPER_TABLE_MMAP)
+}
+
+//  End of Source [text/unicodeHelperTableFile.cpp]
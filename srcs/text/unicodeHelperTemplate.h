@@ -0,0 +1,394 @@
+/// @file   text/unicodeHelperTemplate.h
+/// @brief  エンコーディングを型で指定する、ヘッダだけのC++17の変換と文字単位の走査
+/// @note   入出力のエンコーディングをコンパイル時に決めるので、一文字ごとの関数ポインタ経由の呼び出しが無く、
+/// デコードとエンコードが一つのループに展開される。utf-16のバイトオーダーはテンプレートの引数。
+/// 扱うのはunicodeHelperCodec.hにデコード/エンコードがあるutf-8、utf-16(arch/le/be)、cp932だけで、
+/// それ以外の表で引くコードページはunicodeHelperConvertBuffer()などの実行時に選ぶ関数を使う。
+/// cp932の表はunicodeHelper::convert()の呼び出しやunicodeHelper::codepoints()の範囲ごとに一度だけ得て、文字ごとにはその場で引く。
+/// unicodeHelper::codepoints()は変換したコピーを作らずに、ライブラリ内の読み込みと同じデコード関数で一文字ずつ読む。
+#ifndef             TEXT_UNICODE_HELPER_TEMPLATE_H___
+#define             TEXT_UNICODE_HELPER_TEMPLATE_H___
+
+#include "unicodeHelper.h"
+#include "unicodeHelperCodec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iterator>
+#include <type_traits>
+
+namespace   unicodeHelper
+{
+
+/// @struct utf8
+/// @brief  utf-8を表す型
+struct  utf8 {};
+
+/// @struct utf16
+/// @brief  utf-16を表す型
+/// @tparam in_order    バイトオーダー
+template< unicodeHelperByteOrder in_order>
+struct  utf16 {};
+
+typedef utf16< unicodeHelperByteOrder_arch> utf16arch;
+typedef utf16< unicodeHelperByteOrder_le>   utf16le;
+typedef utf16< unicodeHelperByteOrder_be>   utf16be;
+
+/// @struct cp932
+/// @brief  cp932を表す型
+struct  cp932 {};
+
+/// @struct codec
+/// @brief  エンコーディングの型ごとの一文字のデコード/エンコード(戻り値はunicodeHelperCodec.hと同じ)
+/// @note   表を引くものは作った時に表を得るので、一度作って使い回す
+template< typename in_Encoding>
+struct  codec;
+
+template<>
+struct  codec< utf8>
+{
+    static constexpr unicodeHelperEncoding  encoding= unicodeHelperEncoding_utf8;
+
+    static inline signed int    decode( uint32_t*const      out_unicode,
+                                        uint8_t const*const in_src,
+                                        size_t const        in_size)
+    {
+        return  unicodeHelper_decodeUTF8( out_unicode, in_src, in_size);
+    }
+
+    static inline signed int    encode( uint8_t*const   out_dst,
+                                        uint32_t const  in_unicode)
+    {
+        return  unicodeHelper_encodeUTF8( out_dst, in_unicode);
+    }
+};
+
+template< unicodeHelperByteOrder in_order>
+struct  codec< utf16< in_order> >
+{
+    static constexpr unicodeHelperEncoding  encoding= ( in_order== unicodeHelperByteOrder_le)? unicodeHelperEncoding_utf16le:
+                                                      ( in_order== unicodeHelperByteOrder_be)? unicodeHelperEncoding_utf16be:
+                                                                                               unicodeHelperEncoding_utf16arch;
+
+    static inline signed int    decode( uint32_t*const      out_unicode,
+                                        uint8_t const*const in_src,
+                                        size_t const        in_size)
+    {
+        return  unicodeHelper_decodeUTF16( out_unicode, in_src, in_size, in_order);
+    }
+
+    static inline signed int    encode( uint8_t*const   out_dst,
+                                        uint32_t const  in_unicode)
+    {
+        return  unicodeHelper_encodeUTF16( out_dst, in_unicode, in_order);
+    }
+};
+
+template<>
+struct  codec< cp932>
+{
+    static constexpr unicodeHelperEncoding  encoding= unicodeHelperEncoding_cp932;
+
+    unicodeHelperCodepageView const*    _view;  //  作った時に使っていた表
+
+    codec( void)
+    : _view( unicodeHelper_codepageView( unicodeHelperEncoding_cp932))
+    {
+    }
+
+    inline signed int   decode( uint32_t*const      out_unicode,
+                                uint8_t const*const in_src,
+                                size_t const        in_size) const
+    {
+        return  unicodeHelper_decodeCodepageView( out_unicode, in_src, in_size, _view);
+    }
+
+    inline signed int   encode( uint8_t*const   out_dst,
+                                uint32_t const  in_unicode) const
+    {
+        return  unicodeHelper_encodeCodepageView( out_dst, in_unicode, _view);
+    }
+};
+
+/// @class  byteSpan
+/// @brief  入力のbyte列(ポインタとサイズ。中身は持たない)
+class   byteSpan
+{
+public:
+    uint8_t const*              _data;
+    size_t                      _size;
+
+    constexpr byteSpan( void)
+    : _data( 0)
+    , _size( 0)
+    {
+    }
+
+    constexpr byteSpan( void const*const    in_data,
+                        size_t const        in_size)
+    : _data( static_cast<uint8_t const*>( in_data))
+    , _size( in_size)
+    {
+    }
+
+    //  data()とsize()を持つ連続した入れ物(std::vector<uint8_t>、std::string、std::string_viewなど)
+    template< typename in_Container,
+              typename= decltype( std::data( std::declval<in_Container const&>())),
+              typename= decltype( std::size( std::declval<in_Container const&>()))>
+    constexpr byteSpan( in_Container const& in_container)
+    : _data( reinterpret_cast<uint8_t const*>( std::data( in_container)))
+    , _size( std::size( in_container)* sizeof(*std::data( in_container)))
+    {
+    }
+
+    constexpr uint8_t const*    data( void) const   { return  _data; }
+    constexpr size_t            size( void) const   { return  _size; }
+};
+
+/// @struct convertResult
+/// @brief  unicodeHelper::convert()の結果
+template< typename in_OutputIt>
+struct  convertResult
+{
+    in_OutputIt                 _out;           //  出力し終えた次の位置
+    size_t                      _consumed;      //  入力から読み込んだサイズ([byte])
+    signed int                  _result;        //  0:全部は変換出来なかった(不正な入力、最後で文字が切れている、出力先のエンコードに無い文字) その他:全部変換出来た
+};
+
+/// @fn unicodeHelper::convert
+/// @brief  in_Srcのbyte列をin_Dstに変換し、出力イテレータにbyte単位で書く
+/// @tparam in_Src  入力元エンコードの型(utf8、utf16arch/le/be、cp932)
+/// @tparam in_Dst  出力先エンコードの型
+/// @param  in_src  入力元
+/// @param  in_out  出力先(uint8_tを代入できる出力イテレータ。uint8_t*ならそのまま書く)
+/// @param  in_flags    unicodeHelperConvertFlagの論理和
+/// @return 出力し終えた位置と、読み込んだサイズと、成否
+/// @note   結果はunicodeHelperConvertBuffer()に十分な出力先を渡した場合と同じ(入力の先頭のBOMは出力しない)。
+/// 出力先の大きさは調べないので、uint8_t*に書く場合はunicodeHelperMeasure()などで確保しておくこと。
+/// 入力がutf-8でASCIIが続く所は、一文字ずつデコードせずにまとめて書く。
+template< typename in_Src, typename in_Dst, typename in_OutputIt>
+inline convertResult<in_OutputIt>   convert( byteSpan const     in_src,
+                                             in_OutputIt        in_out,
+                                             uint32_t const     in_flags= unicodeHelperConvertFlag_none)
+{
+    typedef codec<in_Src>       codecSrc;
+    typedef codec<in_Dst>       codecDst;
+    codecSrc const              cSrc= codecSrc();
+    codecDst const              cDst= codecDst();
+
+    uint8_t const*const         pSrc= in_src.data();
+    size_t const                szSrc= in_src.size();
+    size_t                      idx= 0;
+    convertResult<in_OutputIt>  result= { in_out, 0, -1};
+
+    //  BOMの出力が必要なら出力
+    uint8_t                     buf[ 4];
+    if( (uint32_t)( in_flags& unicodeHelperConvertFlag_withBOM)!= 0UL)
+    {
+        signed int const            szBOM= cDst.encode( &buf[ 0], 0x0000feffUL);
+        if( szBOM== 0)
+        {
+            result._result                  = 0;
+            return  result;
+        }
+        for( signed int i= 0; i< szBOM; i++)    *result._out++= buf[ i];
+    }
+
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szTop= cSrc.decode( &unicode, pSrc, szSrc);
+    if( szTop> 0&& unicode== 0x0000feffUL)  idx= (size_t)szTop;
+
+    while( idx< szSrc)
+    {
+        //  utf-8のASCIIは、出力先もutf-8ならそのまま、utf-16なら広げてまとめて書く
+        if constexpr( std::is_same<in_Src, utf8>::value
+                      && ( std::is_same<in_Dst, utf8>::value
+                           || codecDst::encoding== unicodeHelperEncoding_utf16le
+                           || codecDst::encoding== unicodeHelperEncoding_utf16be
+                           || codecDst::encoding== unicodeHelperEncoding_utf16arch))
+        {
+            size_t                      end= idx;
+            while( end< szSrc&& pSrc[ end]< 0x80U)  end++;
+            for( ; idx< end; idx++)
+            {
+                if constexpr( std::is_same<in_Dst, utf8>::value)
+                {
+                    *result._out++= pSrc[ idx];
+                } else {
+                    cDst.encode( &buf[ 0], (uint32_t)pSrc[ idx]);
+                    *result._out++= buf[ 0];
+                    *result._out++= buf[ 1];
+                }
+            }
+            if( idx>= szSrc)    break;
+        }
+
+        signed int const            szIn= cSrc.decode( &unicode, pSrc+ idx, (size_t)( szSrc- idx));
+        if( szIn<= 0)
+        {
+            result._result                  = 0;
+            break;
+        }
+        signed int const            szOut= cDst.encode( &buf[ 0], unicode);
+        if( szOut== 0)
+        {
+            result._result                  = 0;
+            break;
+        }
+        for( signed int i= 0; i< szOut; i++)    *result._out++= buf[ i];
+        idx                             += (size_t)szIn;
+    }
+
+    result._consumed                = idx;
+    return  result;
+}
+
+/// @class  codepointIterator
+/// @brief  エンコードされたbyte列を、進める時に一文字ずつデコードするイテレータ
+/// @tparam in_Encoding エンコーディングの型(utf8、utf16arch/le/be、cp932)
+/// @note   *itは文字のunicode。不正な文字は0xfffdを返し、utf-8とcp932は1[byte]、utf-16は2[byte]進める
+/// (最後で切れている文字は残りをまとめて0xfffd一つ)。it.position()でその文字のbyte列での位置が分かる。
+/// 何も確保しないので、std::count()やstd::find()などにそのまま渡せる。
+template< typename in_Encoding>
+class   codepointIterator
+{
+public:
+    typedef std::forward_iterator_tag   iterator_category;
+    typedef char32_t            value_type;
+    typedef ptrdiff_t           difference_type;
+    typedef char32_t const*     pointer;
+    typedef char32_t const&     reference;
+
+    constexpr codepointIterator( void)
+    : _pos( 0)
+    , _end( 0)
+    , _size( 0)
+    , _unicode( 0)
+    , _codec()
+    {
+    }
+
+    codepointIterator( uint8_t const*const              in_pos,
+                       uint8_t const*const              in_end,
+                       codec<in_Encoding> const&        in_codec)
+    : _pos( in_pos)
+    , _end( in_end)
+    , _size( 0)
+    , _unicode( 0)
+    , _codec( in_codec)
+    {
+        decode();
+    }
+
+    reference           operator*( void) const  { return  _unicode; }
+    pointer             operator->( void) const { return  &_unicode; }
+
+    codepointIterator&  operator++( void)
+    {
+        _pos                            += _size;
+        decode();
+        return  *this;
+    }
+
+    codepointIterator   operator++( int)
+    {
+        codepointIterator const     result= *this;
+        ++( *this);
+        return  result;
+    }
+
+    bool    operator==( codepointIterator const& in_rhs) const  { return  _pos== in_rhs._pos; }
+    bool    operator!=( codepointIterator const& in_rhs) const  { return  _pos!= in_rhs._pos; }
+
+    //  今の文字の先頭の位置と、そのサイズ([byte])
+    uint8_t const*      position( void) const   { return  _pos; }
+    size_t              size( void) const       { return  _size; }
+
+private:
+    uint8_t const*              _pos;           //  今の文字の先頭
+    uint8_t const*              _end;           //  入力の最後
+    size_t                      _size;          //  今の文字のサイズ([byte])
+    char32_t                    _unicode;       //  今の文字
+    codec<in_Encoding>          _codec;         //  範囲を作った時のデコード
+
+    //  今の位置の文字をデコード
+    void    decode( void)
+    {
+        if( _pos== _end)
+        {
+            _size                           = 0;
+            return;
+        }
+
+        uint32_t                    unicode;
+        size_t const                szRest= (size_t)( _end- _pos);
+        signed int const            szIn= _codec.decode( &unicode, _pos, szRest);
+        if( szIn> 0)
+        {
+            _unicode                        = (char32_t)unicode;
+            _size                           = (size_t)szIn;
+        } else {
+            //  不正な文字は一単位、切れている文字は残り全部を飛ばす
+            size_t const                szUnit= ( codec<in_Encoding>::encoding== unicodeHelperEncoding_utf8
+                                                  || codec<in_Encoding>::encoding== unicodeHelperEncoding_cp932)? 1: 2;
+            _unicode                        = (char32_t)0x0000fffdUL;
+            _size                           = ( szIn< 0&& szRest>= szUnit)? szUnit: szRest;
+        }
+    }
+};
+
+/// @class  codepointRange
+/// @brief  unicodeHelper::codepoints()が返す、byte列を文字単位で見る範囲(入力は持たない)
+template< typename in_Encoding>
+class   codepointRange
+{
+public:
+    typedef codepointIterator<in_Encoding>  iterator;
+    typedef codepointIterator<in_Encoding>  const_iterator;
+
+    codepointRange( uint8_t const*const             in_begin,
+                    uint8_t const*const             in_end,
+                    codec<in_Encoding> const&       in_codec)
+    : _begin( in_begin)
+    , _end( in_end)
+    , _codec( in_codec)
+    {
+    }
+
+    iterator    begin( void) const  { return  iterator( _begin, _end, _codec); }
+    iterator    end( void) const    { return  iterator( _end, _end, _codec); }
+    bool        empty( void) const  { return  _begin== _end; }
+
+private:
+    uint8_t const*              _begin;
+    uint8_t const*              _end;
+    codec<in_Encoding>          _codec;         //  範囲を作った時のデコード(cp932は表も一度だけ得る)
+};
+
+/// @fn unicodeHelper::codepoints
+/// @brief  in_Encodingのbyte列を、コピーせずに文字単位で見る範囲を返す
+/// @tparam in_Encoding 入力元エンコードの型(utf8、utf16arch/le/be、cp932)
+/// @param  in_src  入力元(範囲を使い終わるまで残しておくこと)
+/// @return 範囲(先頭のBOMは含まない)
+/// @note   for( char32_t const c : unicodeHelper::codepoints<unicodeHelper::utf8>( str))のように使う。
+/// 文字数はstd::distance()、区切りはstd::find()とposition()で探せる。
+template< typename in_Encoding>
+inline codepointRange<in_Encoding>  codepoints( byteSpan const in_src)
+{
+    uint8_t const*const         pBegin= in_src.data();
+    uint8_t const*const         pEnd= pBegin+ in_src.size();
+
+    codec<in_Encoding> const    cSrc= codec<in_Encoding>();
+
+    //  BOMがあったらスキップ
+    uint32_t                    unicode;
+    signed int const            szTop= cSrc.decode( &unicode, pBegin, in_src.size());
+    if( szTop> 0&& unicode== 0x0000feffUL)  return  codepointRange<in_Encoding>( pBegin+ szTop, pEnd, cSrc);
+    return  codepointRange<in_Encoding>( pBegin, pEnd, cSrc);
+}
+
+}   //  namespace   unicodeHelper
+
+#endif  //  ndef    TEXT_UNICODE_HELPER_TEMPLATE_H___
+//  End of Source [text/unicodeHelperTemplate.h]
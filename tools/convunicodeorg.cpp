@@ -1,7 +1,10 @@
 /// @file   convunicodeorg.cpp
 /// @brief  unicode.orgで配布されている.TXTをc用のテーブル化する
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <functional>
 #include <iterator>
@@ -25,6 +28,27 @@ public:
     }
 };
 
+/// @class  genOption
+/// @brief  元ファイルの読み方と表の作り方の指定
+class   genOption
+{
+public:
+    uint32_t                    column;     //  コードが何列目にあるか(unicodeはその次の列)
+    uint16_t                    orMask;     //  コードに論理和する値(JIS0208.TXTの区点からEUCを作る時など)
+    uint16_t                    avoidFirst; //  同じunicodeに複数のコードが対応する場合に避けるコードの範囲
+    uint16_t                    avoidLast;  //  (avoidFirst> avoidLastなら避けない)
+    std::vector<c2uc>           extra;      //  元ファイルに無い対応(制御文字やEUCの半角カナなど)
+
+    genOption()
+    : column(     1UL)
+    , orMask(     0U)
+    , avoidFirst( 1U)
+    , avoidLast(  0U)
+    , extra()
+    {
+    }
+};
+
 //  十六進数の一文字をパース(16は十六進数以外が渡された)
 static uint16_t parseHexAlphabet( char const in_alp)
 {
@@ -115,7 +139,11 @@ static size_t   skipBlank( char const*const in_src, //  ソース
 }
 
 //  元ファイルを読み込み、ユニコード対 対応コードのvectorで返す
-static bool readTable( std::vector<c2uc>*io_dst, char const*const in_pathIn)
+//  コードの列だけで"DBCS LEAD BYTE"と書かれた行は、2[byte]文字の先頭byteとして覚える
+static bool readTable( std::vector<c2uc>*           io_dst,
+                       std::vector<bool>*const      io_lead,    //  256要素
+                       char const*const             in_pathIn,
+                       genOption const&             in_option)
 {
     std::ifstream               fs( in_pathIn, std::ios::in);
 
@@ -126,22 +154,38 @@ static bool readTable( std::vector<c2uc>*io_dst, char const*const in_pathIn)
             std::string                 lb;
             std::getline( fs, lb);
 
-            uint16_t                    code;
+            std::vector<uint16_t>       cols;
             size_t const                szLine( lb.length());
-            size_t                      idx;
-            if( parseHex( &code, &idx, lb.c_str(), szLine, 0)!= false)
+            size_t                      idx( 0);
+            for(;;)
             {
+                uint16_t                    val;
+                if( parseHex( &val, &idx, lb.c_str(), szLine, idx)== false)    break;
+                cols.push_back( val);
                 idx                             = skipBlank( lb.c_str(), szLine, idx);
-                uint16_t                    unicode;
-                if( parseHex( &unicode, &idx, lb.c_str(), szLine, idx)!= false)
-                {
-                    io_dst->push_back( c2uc( code, unicode));
-                }
+            }
+
+            if( cols.size()> in_option.column)
+            {
+                uint16_t const              code( static_cast<uint16_t>( cols[ in_option.column- 1UL]| in_option.orMask));
+                io_dst->push_back( c2uc( code, cols[ in_option.column]));
+            } else if( cols.size()== 1
+                       && cols[ 0]< 0x100U
+                       && lb.find( "DBCS LEAD BYTE")!= std::string::npos)
+            {
+                ( *io_lead)[ cols[ 0]]          = true;
             }
         }
 
         fs.close();
 
+        //  元ファイルにあるコードはそちらを優先
+        std::vector<bool>           hasCode( 0x10000, false);
+        for( std::vector<c2uc>::const_iterator it= io_dst->cbegin(); it!= io_dst->cend(); it++)    hasCode[ it->code]= true;
+        for( std::vector<c2uc>::const_iterator it= in_option.extra.cbegin(); it!= in_option.extra.cend(); it++)
+        {
+            if( hasCode[ it->code]== false) io_dst->push_back( *it);
+        }
         return  true;
     } else {
         fprintf( stderr, "%s can't read.\n", in_pathIn);
@@ -149,9 +193,330 @@ static bool readTable( std::vector<c2uc>*io_dst, char const*const in_pathIn)
     }
 }
 
+//  同じunicodeに複数のコードが対応する場合に、in_lをin_rより優先するか
+//  (-avoidの範囲(cp932ならNEC選定IBM拡張文字の0xED00-0xEEFF)は避け、それ以外は小さいコードを使う)
+static bool preferEncode( uint16_t const in_l, uint16_t const in_r, genOption const& in_option)
+{
+    bool const                  isAvoidL( in_option.avoidFirst<= in_l&& in_l<= in_option.avoidLast);
+    bool const                  isAvoidR( in_option.avoidFirst<= in_r&& in_r<= in_option.avoidLast);
+    if( isAvoidL!= isAvoidR)    return  isAvoidR;
+
+    return  static_cast<bool>( in_l< in_r);
+}
+
+//  上位byteで行を引き、下位byteで列を引く二段の表を作る
+//  行0はすべて0(対応無し)で、上位byteに対応が一つも無い場合はそこを指す
+//  行の番号がuint8_tに入らない場合はfalseを返す
+static bool buildDirectTable( uint8_t*const                 out_rows,   //  256要素
+                              std::vector<uint16_t>*const   out_table,
+                              std::string const&            in_name,
+                              std::vector<uint16_t> const&  in_flat)    //  0x10000要素(0は対応無し)
+{
+    std::vector<uint16_t>&      table( *out_table);
+    table.assign( 256, 0U);
+
+    for( uint32_t high= 0UL; high< 256UL; high++)
+    {
+        std::vector<uint16_t>::const_iterator const itRow( in_flat.cbegin()+ static_cast<std::ptrdiff_t>( high<< 8));
+        if( std::find_if( itRow, itRow+ 256, []( uint16_t const in_val) { return  in_val!= 0U; })== itRow+ 256)
+        {
+            out_rows[ high]                 = 0U;
+        } else {
+            if( ( table.size()>> 8)> 255UL)
+            {
+                fprintf( stderr, "%s: too many rows.\n", in_name.c_str());
+                return  false;
+            }
+            out_rows[ high]                 = static_cast<uint8_t>( table.size()>> 8);
+            table.insert( table.end(), itRow, itRow+ 256);
+        }
+    }
+    return  true;
+}
+
+//  二段の表を出力
+static bool writeDirectTable( size_t*const                  out_bytes,  //  表のサイズ([byte])
+                              std::fstream&                 io_fs,
+                              std::string const&            in_name,
+                              std::vector<uint16_t> const&  in_flat)    //  0x10000要素(0は対応無し)
+{
+    static uint32_t const       numOneline= 8UL;
+    uint8_t                     rows[ 256];
+    std::vector<uint16_t>       table;
+
+    if( buildDirectTable( rows, &table, in_name, in_flat)== false)  return  false;
+
+    io_fs<< "static uint8_t const "<< in_name<< "Row[256]= {"<< std::endl;
+    for( uint32_t high= 0UL; high< 256UL; high++)
+    {
+        if( static_cast<uint32_t>( high% 16UL)== 0UL)   io_fs<< " ";
+        io_fs<< " "<< std::dec<< std::setfill( ' ')<< std::setw( 3)<< static_cast<uint32_t>( rows[ high])<< "U,";
+        if( static_cast<uint32_t>( high% 16UL)== 15UL)  io_fs<< std::endl;
+    }
+    io_fs<< "};"<< std::endl;
+
+    io_fs<< std::endl;
+
+    io_fs<< "static uint16_t const "<< in_name<< "Table[]= {"<< std::endl;
+    for( size_t idx= 0; idx< table.size(); idx++)
+    {
+        if( static_cast<uint32_t>( idx% 256UL)== 0UL)   io_fs<< "  //  row "<< std::dec<< static_cast<uint32_t>( idx>> 8)<< std::endl;
+        if( static_cast<uint32_t>( idx% numOneline)== 0UL)  io_fs<< " ";
+        io_fs<< " 0x"<< std::hex<< std::setfill( '0')<< std::setw( 4)<< table[ idx]<< "U,";
+        if( static_cast<uint32_t>( idx% numOneline)== static_cast<uint32_t>( numOneline- 1UL))  io_fs<< std::endl;
+    }
+    io_fs<< "};"<< std::endl;
+
+    *out_bytes                      = sizeof(rows)+ table.size()* sizeof(uint16_t);
+    return  true;
+}
+
+/// @class  s2dRun
+/// @brief  連続したコードの区間(unicodeHelperTable.hのs2dRunと同じ並び)
+class   s2dRun
+{
+public:
+    uint16_t                    source;     //  区間の先頭のコード
+    uint16_t                    length;     //  区間の長さ(s2dRunLinearが立っていれば対応先も連続)
+    uint16_t                    value;      //  対応先も連続なら先頭の対応先、そうでなければ対応先の並びの位置
+
+    s2dRun( uint16_t const  in_source,
+            uint16_t const  in_length,
+            uint16_t const  in_value)
+    : source( in_source)
+    , length( in_length)
+    , value(  in_value)
+    {
+    }
+};
+
+//  対応先も連続している区間の印
+static uint16_t const           s2dRunLinear= 0x8000U;
+
+//  対応先の並びに入れる区間の最大長
+static uint32_t const           s2dRunLengthMax= 0x7fffUL;
+
+//  区間にまとめる時に、対応の無いコードをこれだけまでは並びに0として入れる
+static uint32_t const           s2dRunGapMax= 2UL;
+
+//  対応先も連続している区間は、これ以上の長さなら並びに入れない
+static uint32_t const           s2dRunLinearMin= 4UL;
+
+//  連続したコードの区間に分けた表を出力
+//  区間の二分探索と、対応先の並びの一回の読み込みで引く
+static bool writeRunTable( size_t*const                 out_bytes,  //  表のサイズ([byte])
+                           size_t*const                 out_numRun, //  区間の数
+                           std::fstream&                io_fs,
+                           std::string const&           in_name,
+                           std::vector<uint16_t> const& in_flat)    //  0x10000要素(0は対応無し)
+{
+    std::vector<s2dRun>         runs;
+    std::vector<uint16_t>       dests;
+    uint32_t                    code( 1UL);
+
+    while( code< 0x10000UL)
+    {
+        if( in_flat[ code]== 0U)
+        {
+            code++;
+            continue;
+        }
+
+        //  対応の無いコードがs2dRunGapMaxまでなら一続きとみなす
+        uint32_t                    term( code+ 1UL);
+        for(;;)
+        {
+            uint32_t                    next( term);
+            while( next< 0x10000UL&& in_flat[ next]== 0U&& static_cast<uint32_t>( next- term)<= s2dRunGapMax)  next++;
+            if( next>= 0x10000UL|| in_flat[ next]== 0U)    break;
+            term                            = next+ 1UL;
+        }
+
+        //  対応先も連続している所は区間だけ、それ以外は対応先の並びに入れる
+        uint32_t                    pending( code);
+        while( code< term)
+        {
+            uint32_t                    linear( code+ 1UL);
+            while( linear< term
+                   && in_flat[ code]!= 0U
+                   && static_cast<uint32_t>( linear- code)< s2dRunLengthMax
+                   && in_flat[ linear]== static_cast<uint16_t>( in_flat[ code]+ ( linear- code)))
+            {
+                linear++;
+            }
+
+            if( in_flat[ code]!= 0U&& static_cast<uint32_t>( linear- code)>= s2dRunLinearMin)
+            {
+                if( pending< code)
+                {
+                    runs.push_back( s2dRun( static_cast<uint16_t>( pending), static_cast<uint16_t>( code- pending), static_cast<uint16_t>( dests.size())));
+                    dests.insert( dests.end(), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( pending), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( code));
+                }
+                runs.push_back( s2dRun( static_cast<uint16_t>( code), static_cast<uint16_t>( ( linear- code)| s2dRunLinear), in_flat[ code]));
+                pending                         = linear;
+            } else if( static_cast<uint32_t>( linear- pending)> s2dRunLengthMax)
+            {
+                runs.push_back( s2dRun( static_cast<uint16_t>( pending), static_cast<uint16_t>( code- pending), static_cast<uint16_t>( dests.size())));
+                dests.insert( dests.end(), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( pending), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( code));
+                pending                         = code;
+            }
+            code                            = linear;
+        }
+        if( pending< term)
+        {
+            runs.push_back( s2dRun( static_cast<uint16_t>( pending), static_cast<uint16_t>( term- pending), static_cast<uint16_t>( dests.size())));
+            dests.insert( dests.end(), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( pending), in_flat.cbegin()+ static_cast<std::ptrdiff_t>( term));
+        }
+
+        if( dests.size()> 0xffffUL)
+        {
+            fprintf( stderr, "%s: too many destinations.\n", in_name.c_str());
+            return  false;
+        }
+    }
+
+    static uint32_t const       numOnelineRun= 4UL;
+    io_fs<< "static s2dRun const "<< in_name<< "Run[]= {"<< std::endl;
+    for( size_t idx= 0; idx< runs.size(); idx++)
+    {
+        if( static_cast<uint32_t>( idx% numOnelineRun)== 0UL)   io_fs<< " ";
+        io_fs<< " { 0x"<< std::hex<< std::setfill( '0')<< std::setw( 4)<< runs[ idx].source;
+        io_fs<< "U, 0x"<< std::hex<< std::setfill( '0')<< std::setw( 4)<< runs[ idx].length;
+        io_fs<< "U, 0x"<< std::hex<< std::setfill( '0')<< std::setw( 4)<< runs[ idx].value<< "U},";
+        if( static_cast<uint32_t>( idx% numOnelineRun)== static_cast<uint32_t>( numOnelineRun- 1UL))   io_fs<< std::endl;
+    }
+    if( static_cast<uint32_t>( runs.size()% numOnelineRun)!= 0UL)  io_fs<< std::endl;
+    io_fs<< "};"<< std::endl;
+
+    io_fs<< std::endl;
+
+    //  空の配列にならないよう、最後に0を一つ置く
+    static uint32_t const       numOneline= 8UL;
+    dests.push_back( 0U);
+    io_fs<< "static uint16_t const "<< in_name<< "RunDest[]= {"<< std::endl;
+    for( size_t idx= 0; idx< dests.size(); idx++)
+    {
+        if( static_cast<uint32_t>( idx% numOneline)== 0UL)  io_fs<< " ";
+        io_fs<< " 0x"<< std::hex<< std::setfill( '0')<< std::setw( 4)<< dests[ idx]<< "U,";
+        if( static_cast<uint32_t>( idx% numOneline)== static_cast<uint32_t>( numOneline- 1UL))  io_fs<< std::endl;
+    }
+    if( static_cast<uint32_t>( dests.size()% numOneline)!= 0UL)    io_fs<< std::endl;
+    io_fs<< "};"<< std::endl;
+
+    *out_bytes                      = runs.size()* sizeof(uint16_t)* 3+ dests.size()* sizeof(uint16_t);
+    *out_numRun                     = runs.size();
+    return  true;
+}
+
+//  二分探索で最悪何回比べるか
+static uint32_t probeCount( size_t const in_num)
+{
+    return  static_cast<uint32_t>( std::ceil( std::log2( static_cast<double>( in_num)+ 1.0)));
+}
+
+//  実行時に読み込む表のファイル(unicodeHelperTable.hのtableFileHeaderと同じ並び)
+static char const               tableFileMagic[ 8]= "UHTABLE";
+static uint32_t const           tableFileVersion= 2UL;
+static uint32_t const           tableFileByteOrder= 0x01020304UL;
+static uint32_t const           tableFileAlign= 64UL;
+static size_t const             tableFileHeaderSize= 64;
+static size_t const             tableFileNameSize= 16;
+
+//  little endianで追記
+static void putLE( std::vector<uint8_t>*const   io_bytes,
+                   uint32_t const               in_value,
+                   uint32_t const               in_size)
+{
+    for( uint32_t idx= 0UL; idx< in_size; idx++)
+    {
+        io_bytes->push_back( static_cast<uint8_t>( in_value>> ( idx* 8UL)));
+    }
+}
+
+//  tableFileAlign[byte]境界まで0を詰める
+static uint32_t alignTableFile( std::vector<uint8_t>*const io_bytes)
+{
+    while( static_cast<uint32_t>( io_bytes->size()% tableFileAlign)!= 0UL)   io_bytes->push_back( 0U);
+    return  static_cast<uint32_t>( io_bytes->size());
+}
+
+//  二段の表をunicodeHelperLoadTable()でそのままmap出来るファイルとして出力
+static bool writeBinaryTable( char const*const              in_pathOut,
+                              char const*const              in_label,
+                              uint8_t const*const           in_trail,   //  256要素
+                              std::vector<uint16_t> const&  in_flatC2uc,
+                              std::vector<uint16_t> const&  in_flatUc2c)
+{
+    uint8_t                     rowsC2uc[ 256];
+    uint8_t                     rowsUc2c[ 256];
+    std::vector<uint16_t>       tableC2uc;
+    std::vector<uint16_t>       tableUc2c;
+    if( buildDirectTable( rowsC2uc, &tableC2uc, std::string( in_label)+ "_c2uc", in_flatC2uc)== false
+        || buildDirectTable( rowsUc2c, &tableUc2c, std::string( in_label)+ "_uc2c", in_flatUc2c)== false)
+    {
+        return  false;
+    }
+
+    //  先に中身を並べて位置を決め、最後に先頭を埋める
+    std::vector<uint8_t>        body( tableFileHeaderSize, 0U);
+    uint32_t const              ofsC2ucRow( alignTableFile( &body));
+    body.insert( body.end(), rowsC2uc, rowsC2uc+ 256);
+    uint32_t const              ofsC2ucTable( alignTableFile( &body));
+    for( std::vector<uint16_t>::const_iterator it= tableC2uc.cbegin(); it!= tableC2uc.cend(); it++)  putLE( &body, *it, 2UL);
+    uint32_t const              ofsUc2cRow( alignTableFile( &body));
+    body.insert( body.end(), rowsUc2c, rowsUc2c+ 256);
+    uint32_t const              ofsUc2cTable( alignTableFile( &body));
+    for( std::vector<uint16_t>::const_iterator it= tableUc2c.cbegin(); it!= tableUc2c.cend(); it++)  putLE( &body, *it, 2UL);
+    uint32_t const              ofsTrail( alignTableFile( &body));
+    body.insert( body.end(), in_trail, in_trail+ 256);
+    uint32_t const              fileSize( alignTableFile( &body));
+
+    std::vector<uint8_t>        header( tableFileMagic, tableFileMagic+ sizeof(tableFileMagic));
+    putLE( &header, tableFileVersion, 4UL);
+    putLE( &header, tableFileByteOrder, 4UL);
+    putLE( &header, fileSize, 4UL);
+    putLE( &header, static_cast<uint32_t>( tableC2uc.size()>> 8), 4UL);
+    putLE( &header, static_cast<uint32_t>( tableUc2c.size()>> 8), 4UL);
+    putLE( &header, ofsC2ucRow, 4UL);
+    putLE( &header, ofsC2ucTable, 4UL);
+    putLE( &header, ofsUc2cRow, 4UL);
+    putLE( &header, ofsUc2cTable, 4UL);
+    putLE( &header, ofsTrail, 4UL);
+    std::string const           name( std::string( in_label).substr( 0, tableFileNameSize- 1));
+    header.insert( header.end(), name.begin(), name.end());
+    header.resize( tableFileHeaderSize, 0U);
+    std::copy( header.begin(), header.end(), body.begin());
+
+    std::fstream                fs( in_pathOut, std::ios::out| std::ios::binary| std::ios::trunc);
+    if( fs.bad()!= false || fs.is_open()== false)
+    {
+        fprintf( stderr, "%s can't write.\n", in_pathOut);
+        return  false;
+    }
+    fs.write( reinterpret_cast<char const*>( body.data()), static_cast<std::streamsize>( body.size()));
+    fs.close();
+
+    printf( "  binary  %6lu bytes  %s (direct index, mmap)\n", static_cast<unsigned long>( body.size()), in_pathOut);
+    return  true;
+}
+
 //  ユニコード対 対応コードのvector(要対応コードによるソート)を.incとして出力
-static bool writeTable( std::vector<c2uc>const& in_sortedSource, char const*const in_pathOut, char const*const in_label)
+//  in_pathBinaryが0でなければ、実行時に読み込む表のファイルも出力
+static bool writeTable( std::vector<c2uc>const& in_sortedSource,
+                        std::vector<bool>const& in_lead,
+                        genOption const&        in_option,
+                        char const*const        in_pathOut,
+                        char const*const        in_label,
+                        char const*const        in_pathBinary)
 {
+    //  先頭byteごとに続くbyte数(元ファイルで先頭byteとされたものと、2[byte]のコードの上位byte)
+    uint8_t                     trail[ 256];
+    for( uint32_t high= 0UL; high< 256UL; high++)  trail[ high]= ( in_lead[ high]!= false)? 1U: 0U;
+    for( std::vector<c2uc>::const_iterator it= in_sortedSource.cbegin(); it!= in_sortedSource.cend(); it++)
+    {
+        if( ( it->code>> 8)!= 0U)   trail[ it->code>> 8]= 1U;
+    }
+
     std::vector<c2uc>           reverse;
     reverse.reserve( in_sortedSource.size());
     std::copy( in_sortedSource.begin(),
@@ -172,7 +537,23 @@ static bool writeTable( std::vector<c2uc>const& in_sortedSource, char const*cons
 
     if( fs.bad()== false)
     {
+        //  表の持ち方ごとに、取り込む側が必要なものだけを有効にする
+        //  UNICODE_HELPER_TABLE_PAIR   : コード順の対(二分探索)
+        //  UNICODE_HELPER_TABLE_DIRECT : 二段の表(直接引く)
+        //  UNICODE_HELPER_TABLE_RUN    : 連続したコードの区間(区間の二分探索)
+        fs<< "static uint8_t const "<< std::string( in_label)<< "_trail[256]= {"<< std::endl;
+        for( uint32_t high= 0UL; high< 256UL; high++)
+        {
+            if( static_cast<uint32_t>( high% 32UL)== 0UL)   fs<< " ";
+            fs<< " "<< std::dec<< static_cast<uint32_t>( trail[ high])<< "U,";
+            if( static_cast<uint32_t>( high% 32UL)== 31UL)  fs<< std::endl;
+        }
+        fs<< "};"<< std::endl;
+
+        fs<< std::endl;
+
         static uint32_t const       numOneline= 4UL;
+        fs<< "#if         defined(UNICODE_HELPER_TABLE_PAIR)"<< std::endl;
         fs<< "static s2d const "<< std::string( in_label)<< "_c2uc[]= {"<< std::endl;
         uint32_t                    idx( 0UL);
         for( std::vector<c2uc>::const_iterator it= in_sortedSource.cbegin(); it!= in_sortedSource.cend(); it++)
@@ -206,10 +587,66 @@ static bool writeTable( std::vector<c2uc>const& in_sortedSource, char const*cons
         }
         if( static_cast<uint32_t>( idx% numOneline)!= 0UL)  fs<< std::endl;
         fs<< "};"<< std::endl;
+        fs<< "#endif  //  defined(UNICODE_HELPER_TABLE_PAIR)"<< std::endl;
+
+        //  一文字をO(1)で引くための二段の表
+        std::vector<uint16_t>       flatC2uc( 0x10000, 0U);
+        for( std::vector<c2uc>::const_iterator it= in_sortedSource.cbegin(); it!= in_sortedSource.cend(); it++)
+        {
+            flatC2uc[ it->code]             = it->unicode;
+        }
+        std::vector<uint16_t>       flatUc2c( 0x10000, 0U);
+        std::vector<bool>           hasUc2c( 0x10000, false);
+        for( std::vector<c2uc>::const_iterator it= reverse.cbegin(); it!= reverse.cend(); it++)
+        {
+            if( hasUc2c[ it->unicode]== false
+                || preferEncode( it->code, flatUc2c[ it->unicode], in_option)!= false)
+            {
+                flatUc2c[ it->unicode]          = it->code;
+                hasUc2c[ it->unicode]           = true;
+            }
+        }
+
+        size_t                      bytesDirectC2uc( 0);
+        size_t                      bytesDirectUc2c( 0);
+        fs<< std::endl;
+        fs<< "#if         defined(UNICODE_HELPER_TABLE_DIRECT)"<< std::endl;
+        bool const                  isDirectC2ucOk( writeDirectTable( &bytesDirectC2uc, fs, std::string( in_label)+ "_c2uc", flatC2uc));
+        fs<< std::endl;
+        bool const                  isDirectUc2cOk( writeDirectTable( &bytesDirectUc2c, fs, std::string( in_label)+ "_uc2c", flatUc2c));
+        fs<< "#endif  //  defined(UNICODE_HELPER_TABLE_DIRECT)"<< std::endl;
+
+        //  連続したコードの区間に圧縮した表
+        size_t                      bytesRunC2uc( 0);
+        size_t                      bytesRunUc2c( 0);
+        size_t                      numRunC2uc( 0);
+        size_t                      numRunUc2c( 0);
+        fs<< std::endl;
+        fs<< "#if         defined(UNICODE_HELPER_TABLE_RUN)"<< std::endl;
+        bool const                  isRunC2ucOk( writeRunTable( &bytesRunC2uc, &numRunC2uc, fs, std::string( in_label)+ "_c2uc", flatC2uc));
+        fs<< std::endl;
+        bool const                  isRunUc2cOk( writeRunTable( &bytesRunUc2c, &numRunUc2c, fs, std::string( in_label)+ "_uc2c", flatUc2c));
+        fs<< "#endif  //  defined(UNICODE_HELPER_TABLE_RUN)"<< std::endl;
 
         fs.close();
 
-        return  true;
+        //  表の持ち方ごとのサイズと引く手間(ビルドのログに出る)
+        size_t const                bytesPair( in_sortedSource.size()* sizeof(uint16_t)* 2);
+        printf( "%s tables (decode / encode):\n", in_label);
+        printf( "  pair    %6lu / %6lu bytes  binary search (max %u / %u probes)\n",
+                static_cast<unsigned long>( bytesPair), static_cast<unsigned long>( bytesPair),
+                probeCount( in_sortedSource.size()), probeCount( reverse.size()));
+        printf( "  Speed   %6lu / %6lu bytes  direct index (2 loads)\n",
+                static_cast<unsigned long>( bytesDirectC2uc), static_cast<unsigned long>( bytesDirectUc2c));
+        printf( "  Compact %6lu / %6lu bytes  binary search over %lu / %lu runs (max %u / %u probes) + 1 load\n",
+                static_cast<unsigned long>( bytesRunC2uc), static_cast<unsigned long>( bytesRunUc2c),
+                static_cast<unsigned long>( numRunC2uc), static_cast<unsigned long>( numRunUc2c),
+                probeCount( numRunC2uc), probeCount( numRunUc2c));
+
+        bool const                  isBinaryOk( in_pathBinary== 0
+                                                || writeBinaryTable( in_pathBinary, in_label, trail, flatC2uc, flatUc2c)!= false);
+
+        return  isDirectC2ucOk&& isDirectUc2cOk&& isRunC2ucOk&& isRunUc2cOk&& isBinaryOk;
     } else {
         fprintf( stderr, "%s can't write.\n", in_pathOut);
         return  false;
@@ -218,12 +655,17 @@ static bool writeTable( std::vector<c2uc>const& in_sortedSource, char const*cons
 }
 
 //  エントリ
-static int  genTable( char const*const in_pathIn, char const*const in_pathOut, char const*const in_label)
+static int  genTable( char const*const in_pathIn,
+                      char const*const in_pathOut,
+                      char const*const in_label,
+                      char const*const in_pathBinary,
+                      genOption const& in_option)
 {
     int                         resp( -1);
     std::vector<c2uc>           source;
+    std::vector<bool>           lead( 256, false);
 
-    if( readTable( &source, in_pathIn)!= false)
+    if( readTable( &source, &lead, in_pathIn, in_option)!= false)
     {
         std::sort( source.begin(),
                    source.end(),
@@ -235,7 +677,7 @@ static int  genTable( char const*const in_pathIn, char const*const in_pathOut, c
                        return   static_cast<bool>( in_l.unicode< in_r.unicode);
                    });
 
-        if( writeTable( source, in_pathOut, in_label)!= false)
+        if( writeTable( source, lead, in_option, in_pathOut, in_label, in_pathBinary)!= false)
         {
             resp                            = 0;
         }
@@ -244,16 +686,83 @@ static int  genTable( char const*const in_pathIn, char const*const in_pathOut, c
     return  resp;
 }
 
+//  "数値:数値(:数値)"をパース(0xで始まれば十六進数)
+static bool parseOptionValues( uint32_t*const   out_vals,
+                               size_t const     in_num,
+                               char const*const in_src)
+{
+    char const*                 pCur( in_src);
+    for( size_t idx= 0; idx< in_num; idx++)
+    {
+        char*                       pEnd;
+        unsigned long const         val( strtoul( pCur, &pEnd, 0));
+        if( pEnd== pCur|| val> 0xffffUL)    return  false;
+        out_vals[ idx]                  = static_cast<uint32_t>( val);
+
+        if( static_cast<size_t>( idx+ 1)== in_num)  return  *pEnd== '\0';
+        if( *pEnd!= ':')    return  false;
+        pCur                            = pEnd+ 1;
+    }
+    return  false;
+}
+
+//  -で始まる指定を読む(読めない指定があればfalse)
+//  -column N               コードがN列目にある(unicodeはその次の列)
+//  -or 0xXXXX              コードに論理和する
+//  -range CODE:UNICODE:NUM CODEからNUM個をUNICODEから順に対応させる(元ファイルにあるコードは元ファイルが優先)
+//  -avoid FIRST:LAST       同じunicodeに複数のコードが対応する場合に避けるコードの範囲
+static bool parseOptions( genOption*const   out_option,
+                          int*const         io_idxArg,
+                          int const         in_argC,
+                          char**            in_argV)
+{
+    while( *io_idxArg< in_argC&& in_argV[ *io_idxArg][ 0]== '-')
+    {
+        std::string const           name( in_argV[ *io_idxArg]);
+        if( static_cast<int>( *io_idxArg+ 1)>= in_argC)    return  false;
+        char const*const            value( in_argV[ *io_idxArg+ 1]);
+        uint32_t                    vals[ 3];
+
+        if( name== "-column"&& parseOptionValues( vals, 1, value)!= false&& vals[ 0]!= 0UL)
+        {
+            out_option->column              = vals[ 0];
+        } else if( name== "-or"&& parseOptionValues( vals, 1, value)!= false)
+        {
+            out_option->orMask              = static_cast<uint16_t>( vals[ 0]);
+        } else if( name== "-range"&& parseOptionValues( vals, 3, value)!= false)
+        {
+            for( uint32_t idx= 0UL; idx< vals[ 2]; idx++)
+            {
+                out_option->extra.push_back( c2uc( static_cast<uint16_t>( vals[ 0]+ idx), static_cast<uint16_t>( vals[ 1]+ idx)));
+            }
+        } else if( name== "-avoid"&& parseOptionValues( vals, 2, value)!= false)
+        {
+            out_option->avoidFirst          = static_cast<uint16_t>( vals[ 0]);
+            out_option->avoidLast           = static_cast<uint16_t>( vals[ 1]);
+        } else {
+            fprintf( stderr, "bad option %s %s\n", name.c_str(), value);
+            return  false;
+        }
+        *io_idxArg                      += 2;
+    }
+    return  true;
+}
+
 
 int main( int in_argC, char** in_argV)
 {
-    if( in_argC== 4)
+    genOption                   option;
+    int                         idxArg( 1);
+    if( parseOptions( &option, &idxArg, in_argC, in_argV)!= false
+        && ( in_argC- idxArg== 3 || in_argC- idxArg== 4))
     {
-        return  genTable( *static_cast<char**>( in_argV+ 1),
-                          *static_cast<char**>( in_argV+ 2),
-                          *static_cast<char**>( in_argV+ 3));
+        return  genTable( *static_cast<char**>( in_argV+ idxArg),
+                          *static_cast<char**>( in_argV+ idxArg+ 1),
+                          *static_cast<char**>( in_argV+ idxArg+ 2),
+                          ( in_argC- idxArg== 4)? *static_cast<char**>( in_argV+ idxArg+ 3): 0,
+                          option);
     } else {
-        fprintf( stderr, "%s [UNICODE.TXT] [variable label] [OUTPUT.inc]\n", *in_argV);
+        fprintf( stderr, "%s (-column N) (-or 0xXXXX) (-range CODE:UNICODE:NUM)... (-avoid FIRST:LAST) [UNICODE.TXT] [OUTPUT.inc] [variable label] ([OUTPUT.uht])\n", *in_argV);
         return  0;
     }
 }
@@ -0,0 +1,2153 @@
+/// @file   unicodeHelperBench.cpp
+/// @brief  unicodeHelperの変換速度を計測する(1[byte]単位/ブロック単位/メモリ上)
+/// @note   unicodeHelperBench [サイズ(KiB)] [コーパス名|all] [入力エンコード名|all] [出力エンコード名|validate|all] [streamのサイズ(GiB)]
+/// 出力エンコード名にvalidateを指定すると検証だけを計測する
+/// 出力エンコード名にshortを指定すると一語ずつの短い文字列の変換で、unicodeHelperConvertBuffer()と変換器(unicodeHelperConverterRun())と
+/// 全部の語を一度に渡すunicodeHelperConvertBatch()を比較する
+/// 出力エンコード名にallocを指定すると一語ずつの変換で、unicodeHelperMeasure()で数えてからmalloc()する場合と
+/// unicodeHelperConvertAlloc()にmalloc()/realloc()、ブロック、前詰めの領域(全部の語の後に一度に戻す)を渡す場合を比較する
+/// 出力エンコード名にmeasureを指定すると、unicodeHelperMeasure()での出力サイズの計測とunicodeHelperConvertBuffer()での変換を比較する
+/// 出力エンコード名にdetectを指定すると、unicodeHelperAnalyzeEncoding()とunicodeHelperDetectEncoding()での判定を比較する(analyzeは候補が一つに絞れた所で読むのをやめる)
+/// 出力エンコード名にstreamを指定すると、コーパスを繰り返して作った4[GiB]を超える入力(既定は5[GiB])を
+/// unicodeHelperConvertBlockProgress()とunicodeHelperAnalyzeEncoding()に流し、途中経過と結果のサイズを確かめる
+/// 出力エンコード名にparallelを指定すると、unicodeHelperConverterRunParallel()のスレッド数ごとの速度を比較する
+/// 出力エンコード名にcsvを指定すると、全エンコーディングの組み合わせのunicodeHelperConvert()/unicodeHelperConvertBlock()/
+/// unicodeHelperConvertBuffer()(shortコーパスは一行ずつの変換器も)と判定の速度を、コミット間で比べられるようにCSVで出力する
+/// 出力エンコード名にiconvを指定すると、同じ入力をunicodeHelperConvert()/unicodeHelperConvertBuffer()/iconv()/std::codecvtで変換し、
+/// 速度の比と出力が同じかを表示する(iconv()はglibcの場合だけ。std::codecvtはutf8とutf16archの間だけ)
+/// 出力エンコード名にtemplateを指定すると、unicodeHelper::convert()(unicodeHelperTemplate.h)とunicodeHelperConvertBuffer()の
+/// 速度と出力が同じかを表示する(utf8/utf16arch/utf16le/utf16be/cp932の間だけ)
+/// 出力エンコード名にstringを指定すると、std::string/std::u16string/std::u32stringの変換(unicodeHelperString.h)を、
+/// 毎回新しい文字列を返す場合/文字列を使い回して足す場合/unicodeHelperConvert()でpush_back()する場合で比較する
+/// 出力エンコード名にcodepointsを指定すると、unicodeHelper::codepoints()でstd::distance()/std::count()/範囲forをした場合と、
+/// utf-32に変換してから数える場合を比較する(utf8/utf16arch/utf16le/utf16be/cp932)
+/// 出力エンコード名にlookupを指定するとcp932の表の持ち方(対の二分探索/Speed/Compact)を比較する
+/// 出力エンコード名にbindを指定すると、カレントディレクトリの表のファイル(cp932.uhtなど)を表で引く全部のエンコードに
+/// unicodeHelperBindTable()で結び付けてみて、名前が同じエンコードにだけ結び付き、変換結果が組み込みの表と同じことを確かめる
+/// 環境変数UNICODE_HELPER_SIMD=none/sse41でベクトル命令の使用を制限して比較できる
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <locale>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "text/unicodeHelper.h"
+#include "text/unicodeHelperCodec.h"
+#include "text/unicodeHelperConfig.h"
+#include "text/unicodeHelperString.h"
+#include "text/unicodeHelperTemplate.h"
+
+#if         defined(__GLIBC__)
+//  比較用にglibcのiconv()を使う
+#define UNICODE_HELPER_BENCH_ICONV  1
+#include <errno.h>
+#include <iconv.h>
+#endif  //  defined(__GLIBC__)
+
+#if         defined(UNICODE_HELPER_USE_CP932)
+//  表の持ち方を比べるので全部取り込む
+#define UNICODE_HELPER_TABLE_PAIR   1
+#define UNICODE_HELPER_TABLE_DIRECT 1
+#define UNICODE_HELPER_TABLE_RUN    1
+#include "text/unicodeHelperTable.h"
+#include "cp932.inc"
+#endif  //  defined(UNICODE_HELPER_USE_CP932)
+
+/// @class  benchStream
+/// @brief  unicodeHelperConvert()にメモリ上の入出力をさせるためのパラメータ
+class   benchStream
+{
+public:
+    uint8_t const*              src;
+    size_t                      srcSize;
+    size_t                      srcIdx;
+    uint8_t*                    dst;
+    size_t                      dstCap;
+    size_t                      dstIdx;
+
+    benchStream( uint8_t const*const    in_src,
+                 size_t const           in_srcSize,
+                 uint8_t*const          in_dst,
+                 size_t const           in_dstCap)
+    : src(     in_src)
+    , srcSize( in_srcSize)
+    , srcIdx(  0)
+    , dst(     in_dst)
+    , dstCap(  in_dstCap)
+    , dstIdx(  0)
+    {
+    }
+};
+
+//  1[byte]読み込み
+static signed int   benchRead( uint8_t*const out_dst, void*const io_arg)
+{
+    benchStream*const           pStream( static_cast<benchStream*>( io_arg));
+    if( pStream->srcIdx< pStream->srcSize)
+    {
+        *out_dst                        = *static_cast<uint8_t const*>( pStream->src+ pStream->srcIdx);
+        pStream->srcIdx++;
+        return  -1;
+    }
+    return  0;
+}
+
+//  1[byte]書き出し
+static signed int   benchWrite( uint8_t const in_src, void*const io_arg)
+{
+    benchStream*const           pStream( static_cast<benchStream*>( io_arg));
+    if( pStream->dstIdx< pStream->dstCap)
+    {
+        *static_cast<uint8_t*>( pStream->dst+ pStream->dstIdx)= in_src;
+        pStream->dstIdx++;
+        return  -1;
+    }
+    return  0;
+}
+
+//  まとめて読み込み
+static size_t   benchReadBlock( uint8_t*const out_dst, size_t const in_size, void*const io_arg)
+{
+    benchStream*const           pStream( static_cast<benchStream*>( io_arg));
+    size_t const                szRead( std::min( in_size, static_cast<size_t>( pStream->srcSize- pStream->srcIdx)));
+    memcpy( out_dst, pStream->src+ pStream->srcIdx, szRead);
+    pStream->srcIdx                 += szRead;
+    return  szRead;
+}
+
+//  まとめて書き出し
+static signed int   benchWriteBlock( uint8_t const*const in_src, size_t const in_size, void*const io_arg)
+{
+    benchStream*const           pStream( static_cast<benchStream*>( io_arg));
+    if( in_size<= static_cast<size_t>( pStream->dstCap- pStream->dstIdx))
+    {
+        memcpy( pStream->dst+ pStream->dstIdx, in_src, in_size);
+        pStream->dstIdx                 += in_size;
+        return  -1;
+    }
+    return  0;
+}
+
+//  捨てる書き出し(検証の代わりに変換していた場合の比較用)
+static signed int   benchDiscardBlock( uint8_t const*const, size_t const, void*const)
+{
+    return  -1;
+}
+
+/// @class  benchEncoding
+/// @brief  計測対象のエンコーディングと表示名
+class   benchEncoding
+{
+public:
+    unicodeHelperEncoding       encoding;
+    char const*                 name;
+};
+
+//  計測対象のエンコーディング
+static benchEncoding const      gBenchEncodings[]= {
+    { unicodeHelperEncoding_utf8,       "utf8"},
+    { unicodeHelperEncoding_utf16arch,  "utf16arch"},
+    { unicodeHelperEncoding_utf16le,    "utf16le"},
+    { unicodeHelperEncoding_utf16be,    "utf16be"},
+    { unicodeHelperEncoding_cp932,      "cp932"},
+    { unicodeHelperEncoding_shiftJIS,   "shiftjis"},
+    { unicodeHelperEncoding_eucJP,      "eucjp"},
+    { unicodeHelperEncoding_gbk,        "gbk"},
+    { unicodeHelperEncoding_big5,       "big5"},
+    { unicodeHelperEncoding_cp949,      "cp949"},
+};
+
+//  表示名(計測対象外のエンコーディングはunknown)
+static char const*  benchEncodingName( unicodeHelperEncoding const in_encoding)
+{
+    for( size_t idx= 0; idx< sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]); idx++)
+    {
+        if( gBenchEncodings[ idx].encoding== in_encoding)   return  gBenchEncodings[ idx].name;
+    }
+    return  "unknown";
+}
+
+/// @class  benchLines
+/// @brief  一語ずつの短い文字列を並べたもの
+class   benchLines
+{
+public:
+    std::vector<uint8_t>        data;   //  全部の語をつなげたもの
+    std::vector<size_t>         ends;   //  各語の終わりのdata中の位置
+
+    size_t  size( void) const
+    {
+        return  data.size();
+    }
+};
+
+//  計測対象のエンコーディングの添字
+static size_t   findBenchEncoding( unicodeHelperEncoding const in_encoding)
+{
+    size_t                      idx( 0);
+    while( gBenchEncodings[ idx].encoding!= in_encoding)    idx++;
+    return  idx;
+}
+
+/// @class  benchCorpus
+/// @brief  コーパスの名前と、それを組み立てる単語の並び
+class   benchCorpus
+{
+public:
+    char const*                 name;
+    char const*const*           words;
+    size_t                      numWords;
+    size_t                      lineMax;    //  0以外なら16〜lineMax[byte]の行に区切る(短い文字列用)
+};
+
+//  ログっぽい英数字と日本語が混じった単語
+static char const*const         gWordsMixed[]= {
+    "GET", "/index.html", "HTTP/1.1", "200", "user=", "session", "timeout", "error:", "0x7f3a",
+    "ログイン", "成功", "失敗", "接続", "切断", "サーバー", "ユーザー", "日本語", "文字列", "変換",
+    "ひらがな", "カタカナ", "漢字", "処理時間", "東京", "大阪", "設定ファイル", "読み込み",
+};
+
+//  ASCIIだけの単語
+static char const*const         gWordsASCII[]= {
+    "GET", "POST", "/index.html", "/api/v1/users", "HTTP/1.1", "200", "404", "user=admin", "session",
+    "timeout", "error:", "0x7f3a", "Content-Type:", "text/plain;", "charset=utf-8", "the", "quick",
+    "brown", "fox", "jumps", "over", "lazy", "dog", "{\"id\":42}",
+};
+
+//  日本語の文章がほとんどの単語
+static char const*const         gWordsJapanese[]= {
+    "吾輩は猫である。", "名前はまだ無い。", "どこで生れたかとんと見当がつかぬ。",
+    "何でも薄暗いじめじめした所で", "ニャーニャー泣いていた事だけは記憶している。",
+    "吾輩はここで始めて人間というものを見た。", "しかもあとで聞くと", "それは書生という",
+    "人間中で一番獰悪な種族であったそうだ。", "設定ファイルの読み込みに失敗しました。",
+    "サーバーとの接続が切断されました。", "東京都千代田区", "（株）", "全角英数ＡＢＣ１２３",
+};
+
+//  絵文字(サロゲートペア)が多い単語
+static char const*const         gWordsEmoji[]= {
+    "\xf0\x9f\x98\x80", "\xf0\x9f\x91\x8d", "\xf0\x9f\x8e\x89", "\xf0\x9f\x8d\xa3",
+    "\xf0\x9f\x99\x8f", "\xf0\x9f\x94\xa5", "\xf0\x9f\x98\x82\xf0\x9f\x98\x82",
+    "ok", "lol", "了解", "ありがとう", "\xf0\xa0\xae\xb7野家",
+};
+
+//  半角カタカナ(cp932の1[byte]文字)が多い単語
+static char const*const         gWordsHalfKana[]= {
+    "ﾃｽﾄ", "ｶﾀｶﾅ", "ﾛｸﾞｲﾝ", "ｾｯｼｮﾝ", "ｴﾗｰ", "ｻｰﾊﾞｰ", "ﾕｰｻﾞｰ", "ﾌｧｲﾙ", "ﾀﾞｳﾝﾛｰﾄﾞ",
+    "ｱｲｳｴｵ", "ｺｰﾄﾞ", "ﾃﾞｰﾀ", "ｶﾌﾞｼｷｶﾞｲｼｬ", "123", "OK", "ｰ",
+};
+
+//  中国語(gbkとbig5の両方にある繁体字)の単語
+static char const*const         gWordsChinese[]= {
+    "伺服器", "連線", "失敗", "使用者", "登入成功", "資料庫", "設定檔", "讀取", "臺北", "香港",
+    "中文字串", "處理時間", "錯誤", "，", "。", "GET", "200",
+};
+
+//  韓国語の単語
+static char const*const         gWordsKorean[]= {
+    "서버", "연결", "실패", "사용자", "로그인", "성공", "데이터베이스", "설정", "파일", "읽기",
+    "서울", "부산", "한국어", "문자열", "변환", "GET", "200",
+};
+
+//  計測するコーパス
+static benchCorpus const        gBenchCorpora[]= {
+    { "mixed",    gWordsMixed,    sizeof(gWordsMixed)/ sizeof(gWordsMixed[0]),       0},
+    { "ascii",    gWordsASCII,    sizeof(gWordsASCII)/ sizeof(gWordsASCII[0]),       0},
+    { "japanese", gWordsJapanese, sizeof(gWordsJapanese)/ sizeof(gWordsJapanese[0]), 0},
+    { "halfkana", gWordsHalfKana, sizeof(gWordsHalfKana)/ sizeof(gWordsHalfKana[0]), 0},
+    { "emoji",    gWordsEmoji,    sizeof(gWordsEmoji)/ sizeof(gWordsEmoji[0]),       0},
+    { "chinese",  gWordsChinese,  sizeof(gWordsChinese)/ sizeof(gWordsChinese[0]),   0},
+    { "korean",   gWordsKorean,   sizeof(gWordsKorean)/ sizeof(gWordsKorean[0]),     0},
+    { "short",    gWordsMixed,    sizeof(gWordsMixed)/ sizeof(gWordsMixed[0]),      64},
+};
+
+//  単語を並べてutf-8のコーパスを作る(乱数は固定シードの線形合同法)
+static std::string  makeCorpus( benchCorpus const& in_corpus, size_t const in_size)
+{
+    std::string                 result;
+    uint32_t                    seed( 12345UL);
+
+    result.reserve( in_size+ 64);
+    size_t                      lineTop( 0);
+    while( result.size()< in_size)
+    {
+        seed                            = static_cast<uint32_t>( seed* 1103515245UL+ 12345UL);
+        char const*const            word( in_corpus.words[ static_cast<size_t>( seed>> 16)% in_corpus.numWords]);
+        if( in_corpus.lineMax== 0)
+        {
+            result                          += word;
+            result                          += ( static_cast<uint32_t>( seed>> 8)% 16UL== 0UL)? "\n": " ";
+            continue;
+        }
+
+        //  lineMax[byte]を超えるなら先に改行し、16[byte]を超えたら適当に改行する
+        if( static_cast<size_t>( result.size()- lineTop+ strlen( word)+ 1)> in_corpus.lineMax)
+        {
+            result                          += "\n";
+            lineTop                         = result.size();
+        } else if( result.size()!= lineTop)
+        {
+            result                          += " ";
+        }
+        result                          += word;
+        if( static_cast<size_t>( result.size()- lineTop)>= 16
+            && static_cast<uint32_t>( seed>> 8)% 4UL== 0UL)
+        {
+            result                          += "\n";
+            lineTop                         = result.size();
+        }
+    }
+
+    return  result;
+}
+
+//  コーパスをin_delimsのどれかで区切り、区切りごとに入力のエンコードへ変換して並べる
+static benchLines   splitBenchLines( std::string const&             in_corpus,
+                                     char const*const               in_delims,
+                                     unicodeHelperEncoding const    in_ecSrc)
+{
+    benchLines                  lines;
+    size_t                      begin( 0);
+    while( begin< in_corpus.size())
+    {
+        size_t const                end( std::min( in_corpus.find_first_of( in_delims, begin), in_corpus.size()));
+        size_t const                sizeLine( static_cast<size_t>( end- begin));
+        size_t const                top( lines.data.size());
+        size_t                      written( 0);
+        lines.data.resize( top+ sizeLine* 2+ 16);
+        unicodeHelperConvertBuffer( lines.data.data()+ top, static_cast<size_t>( lines.data.size()- top), &written,
+                                    reinterpret_cast<uint8_t const*>( in_corpus.data()+ begin), sizeLine, static_cast<size_t*>( 0),
+                                    in_ecSrc, unicodeHelperEncoding_utf8, unicodeHelperConvertFlag_none);
+        lines.data.resize( top+ written);
+        lines.ends.push_back( lines.data.size());
+        begin                           = static_cast<size_t>( end+ 1);
+    }
+    return  lines;
+}
+
+//  utf-8の文字数(継続byte以外の数)
+static size_t   countChars( std::string const& in_corpus)
+{
+    size_t                      num( 0);
+    for( std::string::const_iterator it= in_corpus.cbegin(); it!= in_corpus.cend(); it++)
+    {
+        if( ( static_cast<uint8_t>( *it)& 0xc0U)!= 0x80U)   num++;
+    }
+    return  num;
+}
+
+//  経過時間を秒で返す
+static double   elapsedSec( std::chrono::steady_clock::time_point const& in_begin)
+{
+    return  std::chrono::duration<double>( std::chrono::steady_clock::now()- in_begin).count();
+}
+
+//  unicodeHelperConvert()で変換(戻り値は出力サイズ)
+static size_t   runCallback( std::vector<uint8_t>*const     io_dst,
+                             std::vector<uint8_t> const&    in_src,
+                             unicodeHelperEncoding const    in_ecDst,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    benchStream                 stream( in_src.data(), in_src.size(), io_dst->data(), io_dst->size());
+    unicodeHelperConvert( benchWrite, in_ecDst, 0, benchRead, in_ecSrc, &stream);
+    return  stream.dstIdx;
+}
+
+//  unicodeHelperConvertBlock()で変換(戻り値は出力サイズ)
+static size_t   runBlock( std::vector<uint8_t>*const    io_dst,
+                          std::vector<uint8_t> const&   in_src,
+                          unicodeHelperEncoding const   in_ecDst,
+                          unicodeHelperEncoding const   in_ecSrc)
+{
+    benchStream                 stream( in_src.data(), in_src.size(), io_dst->data(), io_dst->size());
+    unicodeHelperConvertBlock( benchWriteBlock, in_ecDst, 0, benchReadBlock, in_ecSrc, &stream);
+    return  stream.dstIdx;
+}
+
+//  unicodeHelperConvertBuffer()で変換(戻り値は出力サイズ)
+static size_t   runBuffer( std::vector<uint8_t>*const   io_dst,
+                           std::vector<uint8_t> const&  in_src,
+                           unicodeHelperEncoding const  in_ecDst,
+                           unicodeHelperEncoding const  in_ecSrc)
+{
+    size_t                      written( 0);
+    unicodeHelperConvertBuffer( io_dst->data(), io_dst->size(), &written,
+                                in_src.data(), in_src.size(), static_cast<size_t*>( 0),
+                                in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+    return  written;
+}
+
+//  一語ずつunicodeHelperConvertBuffer()で変換(戻り値は出力サイズの合計)
+static size_t   runShortBuffer( std::vector<uint8_t>*const      io_dst,
+                                benchLines const&               in_src,
+                                unicodeHelperEncoding const     in_ecDst,
+                                unicodeHelperEncoding const     in_ecSrc)
+{
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        size_t                      written( 0);
+        unicodeHelperConvertBuffer( io_dst->data(), io_dst->size(), &written,
+                                    in_src.data.data()+ begin, static_cast<size_t>( *it- begin), static_cast<size_t*>( 0),
+                                    in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+        total                           += written;
+        begin                           = *it;
+    }
+    return  total;
+}
+
+//  一語ずつunicodeHelperConvert()で変換(戻り値は出力サイズの合計)
+static size_t   runShortCallback( std::vector<uint8_t>*const    io_dst,
+                                  benchLines const&             in_src,
+                                  unicodeHelperEncoding const   in_ecDst,
+                                  unicodeHelperEncoding const   in_ecSrc)
+{
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        benchStream                 stream( in_src.data.data()+ begin, static_cast<size_t>( *it- begin), io_dst->data(), io_dst->size());
+        unicodeHelperConvert( benchWrite, in_ecDst, 0, benchRead, in_ecSrc, &stream);
+        total                           += stream.dstIdx;
+        begin                           = *it;
+    }
+    return  total;
+}
+
+//  一語ずつ変換器で変換(戻り値は出力サイズの合計)
+static size_t   runShortConverter( std::vector<uint8_t>*const   io_dst,
+                                   benchLines const&            in_src,
+                                   unicodeHelperEncoding const  in_ecDst,
+                                   unicodeHelperEncoding const  in_ecSrc)
+{
+    unicodeHelperConverter const*const  pConverter( unicodeHelperConverterCreate( in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none));
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        size_t                      written( 0);
+        unicodeHelperConverterRun( pConverter, io_dst->data(), io_dst->size(), &written,
+                                   in_src.data.data()+ begin, static_cast<size_t>( *it- begin), static_cast<size_t*>( 0));
+        total                           += written;
+        begin                           = *it;
+    }
+    unicodeHelperConverterDestroy( pConverter);
+    return  total;
+}
+
+/// @class  benchBatch
+/// @brief  unicodeHelperConvertBatch()に渡す語の並びと、結果の格納先(計測の前に一度だけ用意する)
+class   benchBatch
+{
+public:
+    std::vector<unicodeHelperSpan>  spans;
+    size_t                          bytes;
+    mutable std::vector<size_t>     offsets;
+    mutable std::vector<signed int> results;
+
+    explicit benchBatch( benchLines const& in_lines)
+    : spans( in_lines.ends.size())
+    , bytes( in_lines.size())
+    , offsets( in_lines.ends.size()+ 1)
+    , results( in_lines.ends.size())
+    {
+        size_t                      begin( 0);
+        for( size_t i= 0; i< spans.size(); i++)
+        {
+            spans[ i]._data                 = in_lines.data.data()+ begin;
+            spans[ i]._size                 = static_cast<size_t>( in_lines.ends[ i]- begin);
+            begin                           = in_lines.ends[ i];
+        }
+    }
+
+    size_t  size( void) const
+    {
+        return  bytes;
+    }
+};
+
+//  unicodeHelperConvertBatch()で全部の語を一つの出力先に変換(戻り値は出力サイズ)
+static size_t   runShortBatch( std::vector<uint8_t>*const   io_dst,
+                               benchBatch const&            in_src,
+                               unicodeHelperEncoding const  in_ecDst,
+                               unicodeHelperEncoding const  in_ecSrc)
+{
+    size_t const                num( unicodeHelperConvertBatch( io_dst->data(), io_dst->size(), in_src.offsets.data(), in_src.results.data(),
+                                                                in_src.spans.data(), in_src.spans.size(), in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none));
+    return  in_src.offsets[ num];
+}
+
+//  一語ずつ出力サイズを数えてからmalloc()した出力先に変換(戻り値は出力サイズの合計)
+static size_t   runAllocMeasure( std::vector<uint8_t>*const,
+                                 benchLines const&              in_src,
+                                 unicodeHelperEncoding const    in_ecDst,
+                                 unicodeHelperEncoding const    in_ecSrc)
+{
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        uint8_t const*const         pSrc( in_src.data.data()+ begin);
+        size_t const                szSrc( static_cast<size_t>( *it- begin));
+        size_t                      size( 0);
+        unicodeHelperMeasure( &size, pSrc, szSrc, in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+        uint8_t*const               pDst( static_cast<uint8_t*>( malloc( std::max( size, static_cast<size_t>( 1)))));
+        size_t                      written( 0);
+        unicodeHelperConvertBuffer( pDst, size, &written, pSrc, szSrc, static_cast<size_t*>( 0),
+                                    in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+        free( pDst);
+        total                           += written;
+        begin                           = *it;
+    }
+    return  total;
+}
+
+//  一語ずつunicodeHelperConvertAlloc()で変換(in_allocatorで確保したものは毎回解放する。戻り値は出力サイズの合計)
+static size_t   runAllocEach( benchLines const&                 in_src,
+                              unicodeHelperAllocator const&     in_allocator,
+                              unicodeHelperEncoding const       in_ecDst,
+                              unicodeHelperEncoding const       in_ecSrc)
+{
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        uint8_t*                    pDst( static_cast<uint8_t*>( 0));
+        size_t                      written( 0);
+        unicodeHelperConvertAlloc( &in_allocator, &pDst, &written,
+                                   in_src.data.data()+ begin, static_cast<size_t>( *it- begin),
+                                   in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+        size_t                      szFree( 0);
+        in_allocator._resize( in_allocator._arg, pDst, written, &szFree);
+        total                           += written;
+        begin                           = *it;
+    }
+    return  total;
+}
+
+//  一語ずつunicodeHelperConvertAlloc()とmalloc()/realloc()で変換(戻り値は出力サイズの合計)
+static size_t   runAllocHeap( std::vector<uint8_t>*const,
+                              benchLines const&             in_src,
+                              unicodeHelperEncoding const   in_ecDst,
+                              unicodeHelperEncoding const   in_ecSrc)
+{
+    unicodeHelperAllocator const    allocator= { unicodeHelperHeapResize, static_cast<void*>( 0)};
+    return  runAllocEach( in_src, allocator, in_ecDst, in_ecSrc);
+}
+
+//  一語ずつunicodeHelperConvertAlloc()とブロック一つで変換(io_dstをブロックに使う。戻り値は出力サイズの合計)
+static size_t   runAllocPool( std::vector<uint8_t>*const    io_dst,
+                              benchLines const&             in_src,
+                              unicodeHelperEncoding const   in_ecDst,
+                              unicodeHelperEncoding const   in_ecSrc)
+{
+    unicodeHelperPool           pool;
+    unicodeHelperPoolInit( &pool, io_dst->data(), io_dst->size(), 1);
+    unicodeHelperAllocator const    allocator= { unicodeHelperPoolResize, &pool};
+    return  runAllocEach( in_src, allocator, in_ecDst, in_ecSrc);
+}
+
+//  全部の語をunicodeHelperConvertAlloc()で前詰めの領域に変換して最後に一度に戻す
+//  (io_dstを領域に使い、出力は続けて並ぶ。戻り値は出力サイズの合計)
+static size_t   runAllocArena( std::vector<uint8_t>*const   io_dst,
+                               benchLines const&            in_src,
+                               unicodeHelperEncoding const  in_ecDst,
+                               unicodeHelperEncoding const  in_ecSrc)
+{
+    unicodeHelperArena          arena;
+    unicodeHelperArenaInit( &arena, io_dst->data(), io_dst->size());
+    unicodeHelperAllocator const    allocator= { unicodeHelperArenaResize, &arena};
+    size_t                      total( 0);
+    size_t                      begin( 0);
+    for( std::vector<size_t>::const_iterator it= in_src.ends.cbegin(); it!= in_src.ends.cend(); it++)
+    {
+        uint8_t*                    pDst( static_cast<uint8_t*>( 0));
+        size_t                      written( 0);
+        unicodeHelperConvertAlloc( &allocator, &pDst, &written,
+                                   in_src.data.data()+ begin, static_cast<size_t>( *it- begin),
+                                   in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+        total                           += written;
+        begin                           = *it;
+    }
+    unicodeHelperArenaReset( &arena);
+    return  total;
+}
+
+//  csvの見出し(bytesは入力のサイズ、charsは文字数、callsは呼び出し回数。ns/charとus/callは一回分の時間から求める)
+static char const               gBenchCSVHeader[]= "corpus,src,dst,api,bytes,chars,calls,MB/s,ns/char,us/call,ok";
+
+//  unicodeHelperConverterRunParallel()で変換するスレッド数
+static uint32_t                 gBenchThreads= 1UL;
+
+//  streamで流す入力のサイズ([GiB])
+static uint64_t                 gBenchStreamGiB= 5ULL;
+
+/// @class  benchRepeatStream
+/// @brief  メモリ上の入力を繰り返して大きな入力を作り、出力は数えるだけにする
+class   benchRepeatStream
+{
+public:
+    uint8_t const*              src;
+    size_t                      srcSize;
+    uint64_t                    total;      //  入力全体のサイズ([byte])
+    uint64_t                    pos;        //  読み込んだサイズ([byte])
+    uint64_t                    written;    //  書き出されたサイズ([byte])
+    uint64_t                    progressConsumed;
+    uint64_t                    progressWritten;
+    uint64_t                    numProgress;
+    uint64_t                    nextReport; //  次に途中経過を表示する入力のサイズ([byte])
+
+    benchRepeatStream( uint8_t const*const  in_src,
+                       size_t const         in_srcSize,
+                       uint64_t const       in_total)
+    : src(              in_src)
+    , srcSize(          in_srcSize)
+    , total(            in_total)
+    , pos(              0)
+    , written(          0)
+    , progressConsumed( 0)
+    , progressWritten(  0)
+    , numProgress(      0)
+    , nextReport(       0)
+    {
+    }
+};
+
+//  繰り返しの入力をまとめて読み込み
+static size_t   benchRepeatReadBlock( uint8_t*const out_dst, size_t const in_size, void*const io_arg)
+{
+    benchRepeatStream*const     pStream( static_cast<benchRepeatStream*>( io_arg));
+    size_t                      size( 0);
+    while( size< in_size&& pStream->pos< pStream->total)
+    {
+        size_t const                ofs( static_cast<size_t>( pStream->pos% pStream->srcSize));
+        size_t                      sz( std::min( static_cast<size_t>( in_size- size), static_cast<size_t>( pStream->srcSize- ofs)));
+        if( static_cast<uint64_t>( sz)> static_cast<uint64_t>( pStream->total- pStream->pos))
+        {
+            sz                              = static_cast<size_t>( pStream->total- pStream->pos);
+        }
+        memcpy( out_dst+ size, pStream->src+ ofs, sz);
+        size                            += sz;
+        pStream->pos                    += sz;
+    }
+    return  size;
+}
+
+//  繰り返しの入力を1[byte]読み込み
+static signed int   benchRepeatRead( uint8_t*const out_dst, void*const io_arg)
+{
+    benchRepeatStream*const     pStream( static_cast<benchRepeatStream*>( io_arg));
+    if( pStream->pos< pStream->total)
+    {
+        *out_dst                        = pStream->src[ static_cast<size_t>( pStream->pos% pStream->srcSize)];
+        pStream->pos++;
+        return  -1;
+    }
+    return  0;
+}
+
+//  出力は数えるだけ
+static signed int   benchRepeatWriteBlock( uint8_t const*const, size_t const in_size, void*const io_arg)
+{
+    static_cast<benchRepeatStream*>( io_arg)->written+= in_size;
+    return  -1;
+}
+
+//  途中経過を記録して、1[GiB]ごとに表示
+static signed int   benchRepeatProgress( uint64_t const in_consumed, uint64_t const in_written, void*const io_arg)
+{
+    benchRepeatStream*const     pStream( static_cast<benchRepeatStream*>( io_arg));
+    pStream->progressConsumed       = in_consumed;
+    pStream->progressWritten        = in_written;
+    pStream->numProgress++;
+    if( in_consumed>= pStream->nextReport)
+    {
+        fprintf( stderr, "  %6.2fGiB / %6.2fGiB\r",
+                 static_cast<double>( in_consumed)/ 1073741824.0,
+                 static_cast<double>( pStream->total)/ 1073741824.0);
+        pStream->nextReport             += 1ULL<< 30;
+    }
+    return  -1;
+}
+
+#if         defined(UNICODE_HELPER_BENCH_ICONV)
+//  iconv()で変換する時の変換記述子
+static iconv_t                  gBenchIconv= reinterpret_cast<iconv_t>( -1);
+//  iconv()が止まった位置(止まらなければ入力のサイズ)
+static size_t                   gBenchIconvConsumed= 0;
+
+//  iconv()でのエンコーディング名(無ければ0)
+static char const*  benchIconvName( unicodeHelperEncoding const in_encoding)
+{
+    uint16_t const              one( 1U);
+    bool const                  isLE( *reinterpret_cast<uint8_t const*>( &one)== 1U);
+    switch( in_encoding)
+    {
+    case    unicodeHelperEncoding_utf8:         return  "UTF-8";
+    case    unicodeHelperEncoding_utf16arch:    return  isLE? "UTF-16LE": "UTF-16BE";
+    case    unicodeHelperEncoding_utf16le:      return  "UTF-16LE";
+    case    unicodeHelperEncoding_utf16be:      return  "UTF-16BE";
+    case    unicodeHelperEncoding_cp932:        return  "CP932";
+    case    unicodeHelperEncoding_shiftJIS:     return  "SHIFT_JIS";
+    case    unicodeHelperEncoding_eucJP:        return  "EUC-JP";
+    case    unicodeHelperEncoding_gbk:          return  "GBK";
+    case    unicodeHelperEncoding_big5:         return  "BIG5";
+    case    unicodeHelperEncoding_cp949:        return  "CP949";
+    default:                                    return  static_cast<char const*>( 0);
+    }
+}
+
+//  iconv()で変換(戻り値は出力サイズ。変換記述子はgBenchIconv)
+static size_t   runIconv( std::vector<uint8_t>*const    io_dst,
+                          std::vector<uint8_t> const&   in_src,
+                          unicodeHelperEncoding const,
+                          unicodeHelperEncoding const)
+{
+    char*                       pIn( reinterpret_cast<char*>( const_cast<uint8_t*>( in_src.data())));
+    size_t                      szIn( in_src.size());
+    char*                       pOut( reinterpret_cast<char*>( io_dst->data()));
+    size_t                      szOut( io_dst->size());
+    iconv( gBenchIconv, static_cast<char**>( 0), static_cast<size_t*>( 0), static_cast<char**>( 0), static_cast<size_t*>( 0));
+    iconv( gBenchIconv, &pIn, &szIn, &pOut, &szOut);
+    gBenchIconvConsumed             = static_cast<size_t>( in_src.size()- szIn);
+    return  static_cast<size_t>( io_dst->size()- szOut);
+}
+#endif  //  defined(UNICODE_HELPER_BENCH_ICONV)
+
+//  std::codecvtで使うutf-16とutf-8の間の変換(C++11から標準にある)
+typedef std::codecvt<char16_t, char, std::mbstate_t>    benchCodecvt;
+
+//  std::codecvtで変換(utf8とutf16archの間だけ。戻り値は出力サイズ)
+static size_t   runCodecvt( std::vector<uint8_t>*const      io_dst,
+                            std::vector<uint8_t> const&     in_src,
+                            unicodeHelperEncoding const     in_ecDst,
+                            unicodeHelperEncoding const)
+{
+    benchCodecvt const&         facet( std::use_facet<benchCodecvt>( std::locale::classic()));
+    std::mbstate_t              state= std::mbstate_t();
+    if( in_ecDst== unicodeHelperEncoding_utf16arch)
+    {
+        char const*                 pFromNext;
+        char16_t*                   pToNext;
+        char const*const            pFrom( reinterpret_cast<char const*>( in_src.data()));
+        char16_t*const              pTo( reinterpret_cast<char16_t*>( io_dst->data()));
+        facet.in( state, pFrom, pFrom+ in_src.size(), pFromNext,
+                  pTo, pTo+ io_dst->size()/ sizeof(char16_t), pToNext);
+        return  static_cast<size_t>( pToNext- pTo)* sizeof(char16_t);
+    }
+
+    char16_t const*             pFromNext;
+    char*                       pToNext;
+    char16_t const*const        pFrom( reinterpret_cast<char16_t const*>( in_src.data()));
+    char*const                  pTo( reinterpret_cast<char*>( io_dst->data()));
+    facet.out( state, pFrom, pFrom+ in_src.size()/ sizeof(char16_t), pFromNext,
+               pTo, pTo+ io_dst->size(), pToNext);
+    return  static_cast<size_t>( pToNext- pTo);
+}
+
+/// @class  benchPushBack
+/// @brief  変換結果を1[byte]ずつstd::stringにpush_back()する(文字列のAPIが無い場合の呼び出し側の書き方)
+class   benchPushBack : public benchStream
+{
+public:
+    std::string                 out;
+
+    benchPushBack( void const*const in_src,
+                   size_t const     in_srcSize)
+    : benchStream( static_cast<uint8_t const*>( in_src), in_srcSize, static_cast<uint8_t*>( 0), 0)
+    , out()
+    {
+    }
+};
+
+//  1[byte]書き出し(std::stringに足す)
+static signed int   benchPushBackWrite( uint8_t const in_src, void*const io_arg)
+{
+    static_cast<benchPushBack*>( static_cast<benchStream*>( io_arg))->out.push_back( static_cast<char>( in_src));
+    return  -1;
+}
+
+//  unicodeHelperConvert()とpush_back()で文字列に変換(戻り値は出力サイズ)
+static size_t   runPushBack( void const*const               in_src,
+                             size_t const                   in_srcSize,
+                             unicodeHelperEncoding const    in_ecDst,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    benchPushBack               stream( in_src, in_srcSize);
+    unicodeHelperConvert( benchPushBackWrite, in_ecDst, 0, benchRead, in_ecSrc, static_cast<benchStream*>( &stream));
+    return  stream.out.size();
+}
+
+//  文字列の変換一つを、全体を一度に渡した場合と一行ずつ渡した場合で計測して一行表示
+//  (to:毎回新しい文字列を返す append:clear()した文字列に足して領域を使い回す
+//   push_back:unicodeHelperConvert()で1[byte]ずつ足す。in_ecDstがunknownなら計測しない。戻り値は出力が合ったか)
+template< typename in_String, typename in_To, typename in_Append>
+static bool benchStringRow( char const*const                in_name,
+                            in_String const&                in_whole,
+                            std::vector<in_String> const&   in_lines,
+                            std::string_view const          in_expect,
+                            in_To const&                    in_to,
+                            in_Append const&                in_append,
+                            unicodeHelperEncoding const     in_ecDst,
+                            unicodeHelperEncoding const     in_ecSrc)
+{
+    typedef typename in_String::value_type  charType;
+
+    //  一回の実行で変換した入力のサイズから速度([MB/s])を求める
+    auto const                  measureString= []( size_t const in_size, auto const& in_run)
+    {
+        static double const         minSec= 0.2;
+        uint32_t                    loop( 0UL);
+        std::chrono::steady_clock::time_point const begin( std::chrono::steady_clock::now());
+        double                      sec( 0.0);
+        size_t                      sum( 0);
+        do {
+            sum                             += in_run();
+            loop++;
+            sec                             = elapsedSec( begin);
+        } while( sec< minSec);
+        return  ( sum!= 0)? static_cast<double>( in_size)* static_cast<double>( loop)/ sec/ 1.0e6: 0.0;
+    };
+
+    size_t const                szWhole( in_whole.size()* sizeof(charType));
+    size_t                      szLines( 0);
+    for( in_String const& line : in_lines)  szLines+= line.size()* sizeof(charType);
+
+    decltype( in_to( in_whole)) reuse;
+    double const                mbs[ 6]= {
+        measureString( szWhole, [ &]{ return  in_to( in_whole).size(); }),
+        measureString( szLines, [ &]{ size_t n( 0); for( in_String const& line : in_lines) n+= in_to( line).size(); return  n; }),
+        measureString( szWhole, [ &]{ reuse.clear(); in_append( &reuse, in_whole); return  reuse.size(); }),
+        measureString( szLines, [ &]{ size_t n( 0); for( in_String const& line : in_lines) { reuse.clear(); in_append( &reuse, line); n+= reuse.size(); } return  n; }),
+        ( in_ecDst== unicodeHelperEncoding_unknown)? 0.0:
+        measureString( szWhole, [ &]{ return  runPushBack( in_whole.data(), szWhole, in_ecDst, in_ecSrc); }),
+        ( in_ecDst== unicodeHelperEncoding_unknown)? 0.0:
+        measureString( szLines, [ &]{ size_t n( 0); for( in_String const& line : in_lines) n+= runPushBack( line.data(), line.size()* sizeof(charType), in_ecDst, in_ecSrc); return  n; }),
+    };
+
+    //  toの結果と、同じ文字列に二回足した結果を比べる
+    signed int                  result( 0);
+    auto const                  dst( in_to( in_whole, &result));
+    std::string_view const      view( reinterpret_cast<char const*>( dst.data()), dst.size()* sizeof(dst[ 0]));
+    reuse.clear();
+    in_append( &reuse, in_whole);
+    in_append( &reuse, in_whole);
+    std::string_view const      viewReuse( reinterpret_cast<char const*>( reuse.data()), reuse.size()* sizeof(reuse[ 0]));
+    bool const                  isSame( result!= 0&& view== in_expect
+                                        && viewReuse.size()== in_expect.size()* 2
+                                        && viewReuse.substr( 0, in_expect.size())== in_expect
+                                        && viewReuse.substr( in_expect.size())== in_expect);
+
+    printf( "%-16s %9.1fMB/s %9.1fMB/s %9.1fMB/s %9.1fMB/s %9.1fMB/s %9.1fMB/s  %s\n",
+            in_name, mbs[ 0], mbs[ 2], mbs[ 4], mbs[ 1], mbs[ 3], mbs[ 5], isSame? "identical": "differs");
+    return  isSame;
+}
+
+//  unicodeHelper::convert()で変換(出力先の型を決めた後。戻り値は出力サイズ)
+template< typename in_Src, typename in_Dst>
+static size_t   runTemplateAs( std::vector<uint8_t>*const   io_dst,
+                               std::vector<uint8_t> const&  in_src)
+{
+    uint8_t*const               pDst( io_dst->data());
+    return  static_cast<size_t>( unicodeHelper::convert<in_Src, in_Dst>( in_src, pDst)._out- pDst);
+}
+
+//  unicodeHelper::convert()で変換(入力元の型を決めた後。対応していない出力先は0を返す)
+template< typename in_Src>
+static size_t   runTemplateFrom( std::vector<uint8_t>*const     io_dst,
+                                 std::vector<uint8_t> const&    in_src,
+                                 unicodeHelperEncoding const    in_ecDst)
+{
+    switch( in_ecDst)
+    {
+    case    unicodeHelperEncoding_utf8:     return  runTemplateAs<in_Src, unicodeHelper::utf8>( io_dst, in_src);
+    case    unicodeHelperEncoding_utf16arch:return  runTemplateAs<in_Src, unicodeHelper::utf16arch>( io_dst, in_src);
+    case    unicodeHelperEncoding_utf16le:  return  runTemplateAs<in_Src, unicodeHelper::utf16le>( io_dst, in_src);
+    case    unicodeHelperEncoding_utf16be:  return  runTemplateAs<in_Src, unicodeHelper::utf16be>( io_dst, in_src);
+    case    unicodeHelperEncoding_cp932:    return  runTemplateAs<in_Src, unicodeHelper::cp932>( io_dst, in_src);
+    default:                                break;
+    }
+    return  0;
+}
+
+//  unicodeHelper::convert()で変換(utf8/utf16arch/le/be/cp932の間だけ。戻り値は出力サイズ)
+static size_t   runTemplate( std::vector<uint8_t>*const     io_dst,
+                             std::vector<uint8_t> const&    in_src,
+                             unicodeHelperEncoding const    in_ecDst,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    switch( in_ecSrc)
+    {
+    case    unicodeHelperEncoding_utf8:     return  runTemplateFrom<unicodeHelper::utf8>( io_dst, in_src, in_ecDst);
+    case    unicodeHelperEncoding_utf16arch:return  runTemplateFrom<unicodeHelper::utf16arch>( io_dst, in_src, in_ecDst);
+    case    unicodeHelperEncoding_utf16le:  return  runTemplateFrom<unicodeHelper::utf16le>( io_dst, in_src, in_ecDst);
+    case    unicodeHelperEncoding_utf16be:  return  runTemplateFrom<unicodeHelper::utf16be>( io_dst, in_src, in_ecDst);
+    case    unicodeHelperEncoding_cp932:    return  runTemplateFrom<unicodeHelper::cp932>( io_dst, in_src, in_ecDst);
+    default:                                break;
+    }
+    return  0;
+}
+
+//  unicodeHelper::convert()が扱うエンコーディングか
+static bool isTemplateEncoding( unicodeHelperEncoding const in_encoding)
+{
+    return  in_encoding== unicodeHelperEncoding_utf8
+            || in_encoding== unicodeHelperEncoding_utf16arch
+            || in_encoding== unicodeHelperEncoding_utf16le
+            || in_encoding== unicodeHelperEncoding_utf16be
+            || in_encoding== unicodeHelperEncoding_cp932;
+}
+
+//  unicodeHelperConverterRunParallel()で変換(戻り値は出力サイズ)
+static size_t   runParallel( std::vector<uint8_t>*const     io_dst,
+                             std::vector<uint8_t> const&    in_src,
+                             unicodeHelperEncoding const    in_ecDst,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    unicodeHelperConverter const*const  pConverter( unicodeHelperConverterCreate( in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none));
+    size_t                      written( 0);
+    unicodeHelperConverterRunParallel( pConverter, io_dst->data(), io_dst->size(), &written,
+                                       in_src.data(), in_src.size(), static_cast<size_t*>( 0), gBenchThreads);
+    unicodeHelperConverterDestroy( pConverter);
+    return  written;
+}
+
+//  unicodeHelperMeasure()で出力サイズだけを数える(戻り値は出力サイズ)
+static size_t   runMeasure( std::vector<uint8_t>*const,
+                            std::vector<uint8_t> const&     in_src,
+                            unicodeHelperEncoding const     in_ecDst,
+                            unicodeHelperEncoding const     in_ecSrc)
+{
+    size_t                      size( 0);
+    unicodeHelperMeasure( &size, in_src.data(), in_src.size(), in_ecDst, in_ecSrc, unicodeHelperConvertFlag_none);
+    return  size;
+}
+
+//  unicodeHelperAnalyzeEncoding()で判定(戻り値は判定したエンコーディング)
+static size_t   runAnalyze( std::vector<uint8_t>*const,
+                            std::vector<uint8_t> const&     in_src,
+                            unicodeHelperEncoding const,
+                            unicodeHelperEncoding const)
+{
+    benchStream                 stream( in_src.data(), in_src.size(), static_cast<uint8_t*>( 0), 0);
+    return  static_cast<size_t>( unicodeHelperAnalyzeEncoding( benchRead, &stream));
+}
+
+//  unicodeHelperDetectEncoding()で判定(戻り値は一番確からしいエンコーディング)
+static size_t   runDetect( std::vector<uint8_t>*const,
+                           std::vector<uint8_t> const&      in_src,
+                           unicodeHelperEncoding const,
+                           unicodeHelperEncoding const)
+{
+    unicodeHelperDetectCandidate    candidate;
+    if( unicodeHelperDetectEncoding( &candidate, 1, static_cast<signed int*>( 0), in_src.data(), in_src.size())== 0)
+    {
+        return  static_cast<size_t>( unicodeHelperEncoding_unknown);
+    }
+    return  static_cast<size_t>( candidate._encoding);
+}
+
+//  unicodeHelperValidate()で検証(戻り値は正しく読めたサイズ)
+static size_t   runValidate( std::vector<uint8_t>*const,
+                             std::vector<uint8_t> const&    in_src,
+                             unicodeHelperEncoding const,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    size_t                      errorOffset( 0);
+    unicodeHelperValidate( in_ecSrc, in_src.data(), in_src.size(), &errorOffset);
+    return  errorOffset;
+}
+
+//  unicodeHelperConvertBlock()で変換して出力を捨てる(戻り値は正しく読めたサイズ)
+static size_t   runDiscard( std::vector<uint8_t>*const,
+                            std::vector<uint8_t> const&     in_src,
+                            unicodeHelperEncoding const,
+                            unicodeHelperEncoding const     in_ecSrc)
+{
+    benchStream                 stream( in_src.data(), in_src.size(), static_cast<uint8_t*>( 0), 0);
+    unicodeHelperConvertBlock( benchDiscardBlock, in_ecSrc, 0, benchReadBlock, in_ecSrc, &stream);
+    return  stream.srcIdx;
+}
+
+#if         defined(UNICODE_HELPER_USE_CP932)
+//  cp932のデータを一文字ずつのコードに分ける
+static std::vector<uint16_t>    splitCP932( std::vector<uint8_t> const& in_src)
+{
+    std::vector<uint16_t>       result;
+    for( size_t idx= 0; idx< in_src.size();)
+    {
+        uint8_t const               lead( in_src[ idx]);
+        if( ( ( 0x81U<= lead&& lead<= 0x9fU)|| ( 0xe0U<= lead&& lead<= 0xfcU))
+            && static_cast<size_t>( idx+ 1)< in_src.size())
+        {
+            result.push_back( static_cast<uint16_t>( ( static_cast<uint16_t>( lead)<< 8)| in_src[ idx+ 1]));
+            idx                             += 2;
+        } else {
+            result.push_back( lead);
+            idx                             += 1;
+        }
+    }
+    return  result;
+}
+
+//  utf-16(little endian)のデータを一文字ずつのコードに分ける(サロゲートは除く)
+static std::vector<uint16_t>    splitUTF16LE( std::vector<uint8_t> const& in_src)
+{
+    std::vector<uint16_t>       result;
+    for( size_t idx= 0; static_cast<size_t>( idx+ 1)< in_src.size(); idx+= 2)
+    {
+        uint16_t const              unicode( static_cast<uint16_t>( in_src[ idx]| ( static_cast<uint16_t>( in_src[ idx+ 1])<< 8)));
+        if( ( unicode& 0xf800U)!= 0xd800U)  result.push_back( unicode);
+    }
+    return  result;
+}
+
+//  cp932からunicode(対の二分探索)
+static uint16_t lookupC2ucPair( uint16_t const in_code)
+{
+    return  unicodeHelper_search( &cp932_c2uc[ 0], static_cast<uint32_t>( sizeof(cp932_c2uc)/ sizeof(cp932_c2uc[0])), in_code, 0U);
+}
+
+//  cp932からunicode(Speed: 二段の表)
+static uint16_t lookupC2ucDirect( uint16_t const in_code)
+{
+    return  unicodeHelper_lookupDirect( &cp932_c2ucRow[ 0], &cp932_c2ucTable[ 0], in_code);
+}
+
+//  cp932からunicode(Compact: 区間の二分探索)
+static uint16_t lookupC2ucRun( uint16_t const in_code)
+{
+    return  unicodeHelper_lookupRun( &cp932_c2ucRun[ 0], static_cast<uint32_t>( sizeof(cp932_c2ucRun)/ sizeof(cp932_c2ucRun[0])), &cp932_c2ucRunDest[ 0], in_code);
+}
+
+//  unicodeからcp932(対の二分探索)
+static uint16_t lookupUc2cPair( uint16_t const in_unicode)
+{
+    return  unicodeHelper_search( &cp932_uc2c[ 0], static_cast<uint32_t>( sizeof(cp932_uc2c)/ sizeof(cp932_uc2c[0])), in_unicode, 0U);
+}
+
+//  unicodeからcp932(Speed: 二段の表)
+static uint16_t lookupUc2cDirect( uint16_t const in_unicode)
+{
+    return  unicodeHelper_lookupDirect( &cp932_uc2cRow[ 0], &cp932_uc2cTable[ 0], in_unicode);
+}
+
+//  unicodeからcp932(Compact: 区間の二分探索)
+static uint16_t lookupUc2cRun( uint16_t const in_unicode)
+{
+    return  unicodeHelper_lookupRun( &cp932_uc2cRun[ 0], static_cast<uint32_t>( sizeof(cp932_uc2cRun)/ sizeof(cp932_uc2cRun[0])), &cp932_uc2cRunDest[ 0], in_unicode);
+}
+
+//  一文字ずつ表を引く速度([M文字/s])を計測(out_sumには結果の合計)
+static double   measureLookup( uint32_t*const                   out_sum,
+                               uint16_t(*const in_lookup)( uint16_t const),
+                               std::vector<uint16_t> const&     in_codes)
+{
+    static double const         minSec= 0.2;
+    uint32_t                    loop( 0UL);
+    std::chrono::steady_clock::time_point const begin( std::chrono::steady_clock::now());
+    double                      sec( 0.0);
+
+    do {
+        uint32_t                    sum( 0UL);
+        for( std::vector<uint16_t>::const_iterator it= in_codes.cbegin(); it!= in_codes.cend(); it++)
+        {
+            sum                             += in_lookup( *it);
+        }
+        *out_sum                        = sum;
+        loop++;
+        sec                             = elapsedSec( begin);
+    } while( sec< minSec);
+
+    return  static_cast<double>( in_codes.size())* static_cast<double>( loop)/ sec/ 1.0e6;
+}
+#endif  //  defined(UNICODE_HELPER_USE_CP932)
+
+//  指定の変換関数の速度([MB/s])を計測
+template< typename T, typename S>
+static double   measure( size_t*const                   out_size,
+                         T const&                       in_run,
+                         std::vector<uint8_t>*const     io_dst,
+                         S const&                       in_src,
+                         unicodeHelperEncoding const    in_ecDst,
+                         unicodeHelperEncoding const    in_ecSrc)
+{
+    static double const         minSec= 0.2;
+    uint32_t                    loop( 0UL);
+    std::chrono::steady_clock::time_point const begin( std::chrono::steady_clock::now());
+    double                      sec( 0.0);
+
+    do {
+        *out_size                       = in_run( io_dst, in_src, in_ecDst, in_ecSrc);
+        loop++;
+        sec                             = elapsedSec( begin);
+    } while( sec< minSec);
+
+    return  static_cast<double>( in_src.size())* static_cast<double>( loop)/ sec/ 1.0e6;
+}
+
+//  速度([MB/s])を表の一列(12桁)の文字列にする(0.0は計測できなかったのでunsupported)
+static std::string  benchSpeedText( double const in_mbs)
+{
+    if( in_mbs== 0.0)   return  "unsupported";
+
+    char                        text[ 32];
+    snprintf( text, sizeof(text), "%9.1fMB/s", in_mbs);
+    return  text;
+}
+
+//  速度の比を表の一列(10桁)の文字列にする(どちらかが計測できなければunsupported)
+static std::string  benchRatioText( double const in_mbs,
+                                    double const in_mbsBase)
+{
+    if( in_mbs== 0.0|| in_mbsBase== 0.0)    return  "unsupported";
+
+    char                        text[ 32];
+    snprintf( text, sizeof(text), "%9.2fx", in_mbs/ in_mbsBase);
+    return  text;
+}
+
+/// @class  benchContext
+/// @brief  計測の種類ごとの関数に渡すコーパス一つ分の入力(各エンコーディングに変換したもの)
+class   benchContext
+{
+public:
+    benchCorpus const&                  info;
+    std::string const&                  corpus;
+    char const*                         nameSrc;
+    char const*                         nameDst;
+    std::vector< std::vector<uint8_t> > sources;    //  gBenchEncodingsの並び(コーパスを表せないエンコーディングは空)
+
+    benchContext( benchCorpus const&    in_info,
+                  std::string const&    in_corpus,
+                  char const*const      in_nameSrc,
+                  char const*const      in_nameDst)
+    : info( in_info)
+    , corpus( in_corpus)
+    , nameSrc( in_nameSrc)
+    , nameDst( in_nameDst)
+    , sources( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]))
+    {
+        for( size_t i= 0; i< sources.size(); i++)
+        {
+            std::vector<uint8_t>&       src( sources[ i]);
+            src.resize( in_corpus.size()* 2+ 16);
+            size_t                      written( 0);
+            if( unicodeHelperConvertBuffer( src.data(), src.size(), &written,
+                                            reinterpret_cast<uint8_t const*>( in_corpus.data()), in_corpus.size(), static_cast<size_t*>( 0),
+                                            gBenchEncodings[ i].encoding, unicodeHelperEncoding_utf8, unicodeHelperConvertFlag_none)== 0)
+            {
+                fprintf( stderr, "%s: can't prepare the corpus (table empty?)\n", gBenchEncodings[ i].name);
+                written                         = 0;
+            }
+            src.resize( written);
+        }
+    }
+
+    //  入力エンコードの指定(allか名前)に当てはまるか
+    bool    isSourceSelected( size_t const in_idx) const
+    {
+        return  strcmp( nameSrc, "all")== 0
+                || strcmp( nameSrc, gBenchEncodings[ in_idx].name)== 0;
+    }
+};
+
+//  全エンコーディングの組み合わせの変換と判定を、比較しやすいようにCSVで出力
+//  (列はgBenchCSVHeaderのとおり。analyze/detectの行のdstは判定結果で、okは入力のエンコードと一致したか)
+static signed int   benchModeCSV( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    size_t const                numNewLines( static_cast<size_t>( std::count( in_context.corpus.cbegin(), in_context.corpus.cend(), '\n')));
+    size_t const                numChars( countChars( in_context.corpus)- ( ( in_context.info.lineMax!= 0)? numNewLines: 0));
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        benchLines const            lines( ( in_context.info.lineMax!= 0)? splitBenchLines( in_context.corpus, "\n", ecSrc): benchLines());
+        size_t const                numCalls( ( in_context.info.lineMax!= 0)? lines.ends.size(): 1);
+        size_t const                szSrc( ( in_context.info.lineMax!= 0)? lines.size(): src.size());
+        for( size_t idxDst= 0; idxDst< numEncodings; idxDst++)
+        {
+            //  コーパスを表せないエンコーディングへは変換できないので計測しない
+            if( sources[ idxDst].empty()!= false)   continue;
+
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxDst].encoding);
+            std::vector<uint8_t>        dsts[ 3];
+            size_t                      sizes[ 3]= { 0, 0, 0};
+            double                      mbs[ 3];
+            char const*                 apis[ 3];
+            for( size_t i= 0; i< 3; i++)    dsts[ i].resize( ( ( in_context.info.lineMax!= 0)? 256: src.size())* 3+ 16);
+            if( in_context.info.lineMax!= 0)
+            {
+                apis[ 0]                        = "callback";
+                apis[ 1]                        = "buffer";
+                apis[ 2]                        = "converter";
+                mbs[ 0]                         = measure( &sizes[ 0], runShortCallback,  &dsts[ 0], lines, ecDst, ecSrc);
+                mbs[ 1]                         = measure( &sizes[ 1], runShortBuffer,    &dsts[ 1], lines, ecDst, ecSrc);
+                mbs[ 2]                         = measure( &sizes[ 2], runShortConverter, &dsts[ 2], lines, ecDst, ecSrc);
+            } else {
+                apis[ 0]                        = "callback";
+                apis[ 1]                        = "block";
+                apis[ 2]                        = "buffer";
+                mbs[ 0]                         = measure( &sizes[ 0], runCallback, &dsts[ 0], src, ecDst, ecSrc);
+                mbs[ 1]                         = measure( &sizes[ 1], runBlock,    &dsts[ 1], src, ecDst, ecSrc);
+                mbs[ 2]                         = measure( &sizes[ 2], runBuffer,   &dsts[ 2], src, ecDst, ecSrc);
+            }
+
+            //  全体を一度に変換した場合は出力の中身も比べる(短い文字列は出力先を使い回すのでサイズだけ)
+            bool const                  isSame( sizes[ 0]== sizes[ 2]&& sizes[ 1]== sizes[ 2]
+                                                && ( in_context.info.lineMax!= 0
+                                                     || ( memcmp( dsts[ 0].data(), dsts[ 2].data(), sizes[ 2])== 0
+                                                          && memcmp( dsts[ 1].data(), dsts[ 2].data(), sizes[ 2])== 0)));
+            if( isSame== false) result= 0;
+            for( size_t i= 0; i< 3; i++)
+            {
+                printf( "%s,%s,%s,%s,%lu,%lu,%lu,%.1f,%.3f,%.3f,%d\n",
+                        in_context.info.name, gBenchEncodings[ idxSrc].name, gBenchEncodings[ idxDst].name, apis[ i],
+                        static_cast<unsigned long>( szSrc), static_cast<unsigned long>( numChars), static_cast<unsigned long>( numCalls),
+                        mbs[ i],
+                        static_cast<double>( szSrc)* 1.0e3/ ( mbs[ i]* static_cast<double>( numChars)),
+                        static_cast<double>( szSrc)/ ( mbs[ i]* static_cast<double>( numCalls)),
+                        isSame? 1: 0);
+            }
+        }
+
+        //  判定は全体を一度に渡した場合の時間(analyzeは候補が一つに絞れた所で読むのをやめる)
+        std::vector<uint8_t>        dummy;
+        size_t                      ecResults[ 2]= { 0, 0};
+        double const                mbsDetects[ 2]= { measure( &ecResults[ 0], runAnalyze, &dummy, src, ecSrc, ecSrc),
+                                                      measure( &ecResults[ 1], runDetect,  &dummy, src, ecSrc, ecSrc)};
+        char const*const            apisDetect[ 2]= { "analyze", "detect"};
+        for( size_t i= 0; i< 2; i++)
+        {
+            unicodeHelperEncoding const ecResult( static_cast<unicodeHelperEncoding>( ecResults[ i]));
+            printf( "%s,%s,%s,%s,%lu,%lu,%lu,%.1f,%.3f,%.3f,%d\n",
+                    in_context.info.name, gBenchEncodings[ idxSrc].name, benchEncodingName( ecResult), apisDetect[ i],
+                    static_cast<unsigned long>( src.size()), static_cast<unsigned long>( numChars), 1UL,
+                    mbsDetects[ i],
+                    static_cast<double>( src.size())* 1.0e3/ ( mbsDetects[ i]* static_cast<double>( numChars)),
+                    static_cast<double>( src.size())/ mbsDetects[ i],
+                    ( ecResult== ecSrc)? 1: 0);
+        }
+        fflush( stdout);
+    }
+    return  result;
+}
+
+//  iconv()とstd::codecvtとの速度と出力の比較(出力が違えば最初に違うunicodeHelperConvertBuffer()の出力の位置を表示)
+static signed int   benchModeIconv( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %12s %12s %10s %10s  %s\n",
+            "src", "dst", "callback", "buffer", "iconv", "codecvt", "buf/iconv", "buf/cvt", "result");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        for( size_t idxDst= 0; idxDst< numEncodings; idxDst++)
+        {
+            //  コーパスを表せないエンコーディングへは変換できないので計測しない
+            if( sources[ idxDst].empty()!= false)   continue;
+
+            unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxDst].encoding);
+            std::vector<uint8_t>        dstCallback( src.size()* 3+ 16);
+            std::vector<uint8_t>        dstBuffer(   src.size()* 3+ 16);
+            size_t                      szCallback( 0);
+            size_t                      szBuffer( 0);
+            double const                mbsCallback( measure( &szCallback, runCallback, &dstCallback, src, ecDst, ecSrc));
+            double const                mbsBuffer(   measure( &szBuffer,   runBuffer,   &dstBuffer,   src, ecDst, ecSrc));
+            bool const                  isSame( szCallback== szBuffer&& memcmp( dstCallback.data(), dstBuffer.data(), szBuffer)== 0);
+            std::string                 note( isSame? "": "callback differs ");
+            if( isSame== false) result= 0;
+
+            //  違う所を探す(同じならstd::string::nposを返す)
+            std::vector<uint8_t> const& expect( dstBuffer);
+            auto const                  findDiff= [ &expect, szBuffer]( std::vector<uint8_t> const& in_dst, size_t const in_size)
+            {
+                size_t const                num( std::min( in_size, szBuffer));
+                size_t const                idx( static_cast<size_t>( std::mismatch( expect.cbegin(), expect.cbegin()+ num, in_dst.cbegin()).first- expect.cbegin()));
+                return  ( idx== num&& in_size== szBuffer)? std::string::npos: idx;
+            };
+
+            double                      mbsIconv( 0.0);
+#if         defined(UNICODE_HELPER_BENCH_ICONV)
+            gBenchIconv                     = iconv_open( benchIconvName( ecDst), benchIconvName( ecSrc));
+            if( gBenchIconv!= reinterpret_cast<iconv_t>( -1))
+            {
+                std::vector<uint8_t>        dstIconv( src.size()* 3+ 16);
+                size_t                      szIconv( 0);
+                mbsIconv                        = measure( &szIconv, runIconv, &dstIconv, src, ecDst, ecSrc);
+                iconv_close( gBenchIconv);
+
+                size_t const                idxDiff( findDiff( dstIconv, szIconv));
+                if( gBenchIconvConsumed!= src.size())
+                {
+                    note                            += "iconv stopped at "+ std::to_string( gBenchIconvConsumed)+ " ";
+                } else if( idxDiff!= std::string::npos) {
+                    note                            += "iconv differs at "+ std::to_string( idxDiff)+ " ";
+                }
+            } else {
+                note                            += "iconv unsupported ";
+            }
+#endif  //  defined(UNICODE_HELPER_BENCH_ICONV)
+
+            double                      mbsCodecvt( 0.0);
+            if( ( ecSrc== unicodeHelperEncoding_utf8&& ecDst== unicodeHelperEncoding_utf16arch)
+                || ( ecSrc== unicodeHelperEncoding_utf16arch&& ecDst== unicodeHelperEncoding_utf8))
+            {
+                std::vector<uint8_t>        dstCodecvt( src.size()* 3+ 16);
+                size_t                      szCodecvt( 0);
+                mbsCodecvt                      = measure( &szCodecvt, runCodecvt, &dstCodecvt, src, ecDst, ecSrc);
+                if( findDiff( dstCodecvt, szCodecvt)!= std::string::npos)   note+= "codecvt differs ";
+            }
+
+            //  計測できない組み合わせは速度と比の代わりにunsupportedと表示する
+            printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %12s %12s %10s %10s  %s\n",
+                    gBenchEncodings[ idxSrc].name,
+                    gBenchEncodings[ idxDst].name,
+                    mbsCallback,
+                    mbsBuffer,
+                    benchSpeedText( mbsIconv).c_str(),
+                    benchSpeedText( mbsCodecvt).c_str(),
+                    benchRatioText( mbsBuffer, mbsIconv).c_str(),
+                    benchRatioText( mbsBuffer, mbsCodecvt).c_str(),
+                    note.empty()? "identical": note.c_str());
+        }
+    }
+    return  result;
+}
+
+//  unicodeHelper::convert()とunicodeHelperConvertBuffer()の速度と出力の比較
+//  (出力イテレータでも同じになるかをstd::back_inserterで一度だけ確かめる)
+static signed int   benchModeTemplate( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %10s  %s\n", "src", "dst", "buffer", "template", "tmpl/buf", "result");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        if( src.empty()!= false|| isTemplateEncoding( ecSrc)== false)  continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        for( size_t idxDst= 0; idxDst< numEncodings; idxDst++)
+        {
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxDst].encoding);
+            if( sources[ idxDst].empty()!= false|| isTemplateEncoding( ecDst)== false)  continue;
+
+            std::vector<uint8_t>        dstBuffer(   src.size()* 3+ 16);
+            std::vector<uint8_t>        dstTemplate( src.size()* 3+ 16);
+            size_t                      szBuffer( 0);
+            size_t                      szTemplate( 0);
+            double const                mbsBuffer(   measure( &szBuffer,   runBuffer,   &dstBuffer,   src, ecDst, ecSrc));
+            double const                mbsTemplate( measure( &szTemplate, runTemplate, &dstTemplate, src, ecDst, ecSrc));
+            bool const                  isSame( szBuffer== szTemplate&& memcmp( dstBuffer.data(), dstTemplate.data(), szBuffer)== 0);
+
+            std::vector<uint8_t>        dstInserter;
+            dstInserter.reserve( szBuffer);
+            if( ecSrc== unicodeHelperEncoding_utf8&& ecDst== unicodeHelperEncoding_utf16le)
+            {
+                unicodeHelper::convert<unicodeHelper::utf8, unicodeHelper::utf16le>( src, std::back_inserter( dstInserter));
+            } else {
+                dstInserter.assign( dstBuffer.cbegin(), dstBuffer.cbegin()+ szBuffer);
+            }
+            bool const                  isSameInserter( dstInserter.size()== szBuffer&& memcmp( dstBuffer.data(), dstInserter.data(), szBuffer)== 0);
+
+            printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %9.2fx  %s\n",
+                    gBenchEncodings[ idxSrc].name,
+                    gBenchEncodings[ idxDst].name,
+                    mbsBuffer,
+                    mbsTemplate,
+                    ( mbsBuffer!= 0.0)? mbsTemplate/ mbsBuffer: 0.0,
+                    ( isSame== false)? "template differs": ( isSameInserter== false)? "back_inserter differs": "identical");
+            if( isSame== false|| isSameInserter== false)    result= 0;
+        }
+    }
+    return  result;
+}
+
+//  std::string/std::u16string/std::u32stringのAPI(unicodeHelperString.h)とpush_back()で足す場合の比較
+static signed int   benchModeString( benchContext const& in_context)
+{
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    std::vector<uint8_t> const& srcUTF8(  sources[ findBenchEncoding( unicodeHelperEncoding_utf8)]);
+    std::vector<uint8_t> const& srcUTF16( sources[ findBenchEncoding( unicodeHelperEncoding_utf16arch)]);
+    std::vector<uint8_t> const& srcCP932( sources[ findBenchEncoding( unicodeHelperEncoding_cp932)]);
+    std::string const           strUTF8( srcUTF8.cbegin(), srcUTF8.cend());
+    std::u16string const        strUTF16( reinterpret_cast<char16_t const*>( srcUTF16.data()), srcUTF16.size()/ sizeof(char16_t));
+    std::string const           strCP932( srcCP932.cbegin(), srcCP932.cend());
+    std::u32string const        strUTF32( unicodeHelper::toUTF32( strUTF8));
+    std::string_view const      expectUTF8( strUTF8);
+    std::string_view const      expectUTF16( reinterpret_cast<char const*>( strUTF16.data()), strUTF16.size()* sizeof(char16_t));
+    std::string_view const      expectUTF32( reinterpret_cast<char const*>( strUTF32.data()), strUTF32.size()* sizeof(char32_t));
+
+    //  一行ずつの入力(改行で区切る)
+    std::vector<std::string>    linesUTF8;
+    std::vector<std::u16string> linesUTF16;
+    std::vector<std::string>    linesCP932;
+    std::vector<std::u32string> linesUTF32;
+    for( size_t begin( 0); begin< strUTF8.size(); )
+    {
+        size_t const                end( std::min( strUTF8.find( '\n', begin), strUTF8.size()));
+        linesUTF8.push_back( strUTF8.substr( begin, static_cast<size_t>( end- begin)));
+        linesUTF16.push_back( unicodeHelper::toUTF16( linesUTF8.back()));
+        linesUTF32.push_back( unicodeHelper::toUTF32( linesUTF8.back()));
+        if( strCP932.empty()== false)   linesCP932.push_back( unicodeHelper::toCP932( linesUTF8.back()));
+        begin                           = static_cast<size_t>( end+ 1);
+    }
+
+    printf( "%-16s %12s %12s %12s %12s %12s %12s  %s\n",
+            "", "to", "append", "push_back", "to/line", "append/line", "push/line", "result");
+    if( benchStringRow( "utf8->utf16", strUTF8, linesUTF8, expectUTF16,
+                        []( std::string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF16( in_src, unicodeHelperEncoding_utf8, out_result); },
+                        []( std::u16string*const io_dst, std::string_view const in_src) { return  unicodeHelper::appendUTF16( io_dst, in_src); },
+                        unicodeHelperEncoding_utf16arch, unicodeHelperEncoding_utf8)== false)
+    {
+        result                          = 0;
+    }
+    if( benchStringRow( "utf16->utf8", strUTF16, linesUTF16, expectUTF8,
+                        []( std::u16string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF8( in_src, out_result); },
+                        []( std::string*const io_dst, std::u16string_view const in_src) { return  unicodeHelper::appendUTF8( io_dst, in_src); },
+                        unicodeHelperEncoding_utf8, unicodeHelperEncoding_utf16arch)== false)
+    {
+        result                          = 0;
+    }
+    if( benchStringRow( "utf8->utf32", strUTF8, linesUTF8, expectUTF32,
+                        []( std::string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF32( in_src, out_result); },
+                        []( std::u32string*const io_dst, std::string_view const in_src) { return  unicodeHelper::appendUTF32( io_dst, in_src); },
+                        unicodeHelperEncoding_unknown, unicodeHelperEncoding_utf8)== false)
+    {
+        result                          = 0;
+    }
+    if( benchStringRow( "utf16->utf32", strUTF16, linesUTF16, expectUTF32,
+                        []( std::u16string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF32( in_src, out_result); },
+                        []( std::u32string*const io_dst, std::u16string_view const in_src) { return  unicodeHelper::appendUTF32( io_dst, in_src); },
+                        unicodeHelperEncoding_unknown, unicodeHelperEncoding_utf16arch)== false)
+    {
+        result                          = 0;
+    }
+    if( benchStringRow( "utf32->utf8", strUTF32, linesUTF32, expectUTF8,
+                        []( std::u32string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF8( in_src, out_result); },
+                        []( std::string*const io_dst, std::u32string_view const in_src) { return  unicodeHelper::appendUTF8( io_dst, in_src); },
+                        unicodeHelperEncoding_unknown, unicodeHelperEncoding_unknown)== false)
+    {
+        result                          = 0;
+    }
+    if( benchStringRow( "utf32->utf16", strUTF32, linesUTF32, expectUTF16,
+                        []( std::u32string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF16( in_src, out_result); },
+                        []( std::u16string*const io_dst, std::u32string_view const in_src) { return  unicodeHelper::appendUTF16( io_dst, in_src); },
+                        unicodeHelperEncoding_unknown, unicodeHelperEncoding_unknown)== false)
+    {
+        result                          = 0;
+    }
+
+    //  コーパスをcp932で表せる場合だけ
+    if( strCP932.empty()== false)
+    {
+        if( benchStringRow( "utf8->cp932", strUTF8, linesUTF8, std::string_view( strCP932),
+                            []( std::string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toCP932( in_src, unicodeHelperEncoding_utf8, out_result); },
+                            []( std::string*const io_dst, std::string_view const in_src) { return  unicodeHelper::appendCP932( io_dst, in_src); },
+                            unicodeHelperEncoding_cp932, unicodeHelperEncoding_utf8)== false)
+        {
+            result                          = 0;
+        }
+        if( benchStringRow( "utf16->cp932", strUTF16, linesUTF16, std::string_view( strCP932),
+                            []( std::u16string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toCP932( in_src, out_result); },
+                            []( std::string*const io_dst, std::u16string_view const in_src) { return  unicodeHelper::appendCP932( io_dst, in_src); },
+                            unicodeHelperEncoding_cp932, unicodeHelperEncoding_utf16arch)== false)
+        {
+            result                          = 0;
+        }
+        if( benchStringRow( "cp932->utf8", strCP932, linesCP932, expectUTF8,
+                            []( std::string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF8( in_src, unicodeHelperEncoding_cp932, out_result); },
+                            []( std::string*const io_dst, std::string_view const in_src) { return  unicodeHelper::appendUTF8( io_dst, in_src, unicodeHelperEncoding_cp932); },
+                            unicodeHelperEncoding_utf8, unicodeHelperEncoding_cp932)== false)
+        {
+            result                          = 0;
+        }
+        if( benchStringRow( "cp932->utf16", strCP932, linesCP932, expectUTF16,
+                            []( std::string_view const in_src, signed int*const out_result= 0) { return  unicodeHelper::toUTF16( in_src, unicodeHelperEncoding_cp932, out_result); },
+                            []( std::u16string*const io_dst, std::string_view const in_src) { return  unicodeHelper::appendUTF16( io_dst, in_src, unicodeHelperEncoding_cp932); },
+                            unicodeHelperEncoding_utf16arch, unicodeHelperEncoding_cp932)== false)
+        {
+            result                          = 0;
+        }
+    }
+    return  result;
+}
+
+//  unicodeHelper::codepoints()で文字を数える/改行を探す場合と、utf-32に変換してから数える場合の比較
+static signed int   benchModeCodepoints( benchContext const& in_context)
+{
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    size_t const                numChars( countChars( in_context.corpus));
+    size_t const                numLines( static_cast<size_t>( std::count( in_context.corpus.cbegin(), in_context.corpus.cend(), '\n')));
+    printf( "%-10s %12s %12s %12s %12s  %s\n", "src", "distance", "count('\\n')", "for", "toUTF32", "result");
+
+    //  エンコーディングの型ごとに計測
+    auto const                  run= [ &]( auto const in_tag, unicodeHelperEncoding const in_encoding)
+    {
+        typedef typename std::remove_const<decltype( in_tag)>::type encodingType;
+        std::vector<uint8_t> const& src( sources[ findBenchEncoding( in_encoding)]);
+        if( src.empty()!= false)    return;
+
+        std::vector<uint8_t>        dummy;
+        size_t                      sizes[ 4]= { 0, 0, 0, 0};
+        double const                mbs[ 4]= {
+            measure( &sizes[ 0], []( std::vector<uint8_t>*const, std::vector<uint8_t> const& in_src, unicodeHelperEncoding const, unicodeHelperEncoding const)
+                     {
+                         auto const                  range( unicodeHelper::codepoints<encodingType>( in_src));
+                         return  static_cast<size_t>( std::distance( range.begin(), range.end()));
+                     }, &dummy, src, in_encoding, in_encoding),
+            measure( &sizes[ 1], []( std::vector<uint8_t>*const, std::vector<uint8_t> const& in_src, unicodeHelperEncoding const, unicodeHelperEncoding const)
+                     {
+                         auto const                  range( unicodeHelper::codepoints<encodingType>( in_src));
+                         return  static_cast<size_t>( std::count( range.begin(), range.end(), U'\n'));
+                     }, &dummy, src, in_encoding, in_encoding),
+            measure( &sizes[ 2], []( std::vector<uint8_t>*const, std::vector<uint8_t> const& in_src, unicodeHelperEncoding const, unicodeHelperEncoding const)
+                     {
+                         size_t                      num( 0);
+                         for( char32_t const c : unicodeHelper::codepoints<encodingType>( in_src))  num+= ( c!= 0xfffdU)? 1: 0;
+                         return  num;
+                     }, &dummy, src, in_encoding, in_encoding),
+            measure( &sizes[ 3], []( std::vector<uint8_t>*const, std::vector<uint8_t> const& in_src, unicodeHelperEncoding const in_ecDst, unicodeHelperEncoding const)
+                     {
+                         //  utf-32はライブラリに無いので、utf-8とutf-16から変換する(それ以外はutf-16を経由する)
+                         if( in_ecDst== unicodeHelperEncoding_utf8)
+                         {
+                             return  unicodeHelper::toUTF32( std::string_view( reinterpret_cast<char const*>( in_src.data()), in_src.size())).size();
+                         }
+                         std::u16string const        utf16( ( in_ecDst== unicodeHelperEncoding_utf16arch)?
+                                                            std::u16string( reinterpret_cast<char16_t const*>( in_src.data()), in_src.size()/ sizeof(char16_t)):
+                                                            unicodeHelper::toUTF16( std::string_view( reinterpret_cast<char const*>( in_src.data()), in_src.size()), in_ecDst));
+                         return  unicodeHelper::toUTF32( utf16).size();
+                     }, &dummy, src, in_encoding, in_encoding),
+        };
+
+        bool const                  isSame( sizes[ 0]== numChars&& sizes[ 1]== numLines&& sizes[ 2]== numChars&& sizes[ 3]== numChars);
+        printf( "%-10s %9.1fMB/s %9.1fMB/s %9.1fMB/s %9.1fMB/s  %s\n",
+                benchEncodingName( in_encoding), mbs[ 0], mbs[ 1], mbs[ 2], mbs[ 3], isSame? "identical": "differs");
+        if( isSame== false) result= 0;
+    };
+    run( unicodeHelper::utf8(),      unicodeHelperEncoding_utf8);
+    run( unicodeHelper::utf16arch(), unicodeHelperEncoding_utf16arch);
+    run( unicodeHelper::utf16le(),   unicodeHelperEncoding_utf16le);
+    run( unicodeHelper::utf16be(),   unicodeHelperEncoding_utf16be);
+    run( unicodeHelper::cp932(),     unicodeHelperEncoding_cp932);
+    return  result;
+}
+
+//  cp932の表の引き方を比較
+static signed int   benchModeLookup( benchContext const& in_context)
+{
+    signed int                  result( -1);
+
+#if         defined(UNICODE_HELPER_USE_CP932)
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    std::vector<uint16_t> const codes( splitCP932( sources[ findBenchEncoding( unicodeHelperEncoding_cp932)]));
+    std::vector<uint16_t> const unicodes( splitUTF16LE( sources[ findBenchEncoding( unicodeHelperEncoding_utf16le)]));
+
+    printf( "%-10s %-10s %12s %12s %12s %12s\n", "table", "", "pair", "Speed", "Compact", "library");
+    printf( "%-10s %-10s %11luB %11luB %11luB\n", "cp932", "bytes",
+            static_cast<unsigned long>( sizeof(cp932_c2uc)+ sizeof(cp932_uc2c)),
+            static_cast<unsigned long>( sizeof(cp932_c2ucRow)+ sizeof(cp932_c2ucTable)+ sizeof(cp932_uc2cRow)+ sizeof(cp932_uc2cTable)),
+            static_cast<unsigned long>( sizeof(cp932_c2ucRun)+ sizeof(cp932_c2ucRunDest)+ sizeof(cp932_uc2cRun)+ sizeof(cp932_uc2cRunDest)));
+
+    //  表の持ち方ごとに計測(libraryはビルドで選んだ持ち方での公開関数)
+    typedef uint16_t(*lookupFunc)( uint16_t const);
+    lookupFunc const            decodes[]= { lookupC2ucPair, lookupC2ucDirect, lookupC2ucRun, unicodeHelper_cp932ToUnicode};
+    lookupFunc const            encodes[]= { lookupUc2cPair, lookupUc2cDirect, lookupUc2cRun, unicodeHelper_unicodeToCP932};
+    for( uint32_t direction= 0UL; direction< 2UL; direction++)
+    {
+        std::vector<uint16_t> const&    input( ( direction== 0UL)? codes: unicodes);
+        lookupFunc const*const          funcs( ( direction== 0UL)? decodes: encodes);
+        if( input.empty()!= false)  continue;
+
+        double                      mcs[ 4];
+        uint32_t                    sums[ 4];
+        for( size_t i= 0; i< 4; i++)
+        {
+            mcs[ i]                         = measureLookup( &sums[ i], funcs[ i], input);
+        }
+        printf( "%-10s %-10s %10.1fM/s %10.1fM/s %10.1fM/s %10.1fM/s%s\n",
+                "cp932", ( direction== 0UL)? "decode": "encode",
+                mcs[ 0], mcs[ 1], mcs[ 2], mcs[ 3],
+                ( sums[ 0]== sums[ 1]&& sums[ 1]== sums[ 2]&& sums[ 2]== sums[ 3])? "": "  (output mismatch)");
+        if( sums[ 0]!= sums[ 1]|| sums[ 1]!= sums[ 2]|| sums[ 2]!= sums[ 3])   result= 0;
+    }
+#else   //  defined(UNICODE_HELPER_USE_CP932)
+    (void)in_context;
+    printf( "cp932 is disabled.\n");
+#endif  //  defined(UNICODE_HELPER_USE_CP932)
+    return  result;
+}
+
+//  一語ずつの短い文字列の変換を計測(出力はutf-8。入力がutf-8ならutf-16le)
+static signed int   benchModeShort( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %12s %8s %8s\n", "src", "dst", "buffer", "converter", "batch", "ratio", "batch");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        if( sources[ idxSrc].empty()!= false)   continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        unicodeHelperEncoding const ecDst( ( ecSrc== unicodeHelperEncoding_utf8)? unicodeHelperEncoding_utf16le: unicodeHelperEncoding_utf8);
+
+        //  コーパスを語ごとに入力のエンコードへ変換
+        benchLines const            lines( splitBenchLines( in_context.corpus, " \n", ecSrc));
+
+        std::vector<uint8_t>        dstBuffer( 4096);
+        std::vector<uint8_t>        dstConverter( 4096);
+        std::vector<uint8_t>        dstBatch( lines.size()* 3+ 16);
+        size_t                      szBuffer( 0);
+        size_t                      szConverter( 0);
+        size_t                      szBatch( 0);
+
+        double const                mbsBuffer(    measure( &szBuffer,    runShortBuffer,    &dstBuffer,    lines, ecDst, ecSrc));
+        double const                mbsConverter( measure( &szConverter, runShortConverter, &dstConverter, lines, ecDst, ecSrc));
+        benchBatch const            batch( lines);
+        double const                mbsBatch(     measure( &szBatch,     runShortBatch,     &dstBatch,     batch, ecDst, ecSrc));
+
+        //  一つの出力先にまとめた結果は、語ごとに変換してつなげたものと比べる
+        std::vector<uint8_t>        expect( dstBatch.size());
+        size_t                      szExpect( 0);
+        for( size_t i= 0, begin= 0; i< lines.ends.size(); begin= lines.ends[ i], i++)
+        {
+            size_t                      written( 0);
+            unicodeHelperConvertBuffer( expect.data()+ szExpect, static_cast<size_t>( expect.size()- szExpect), &written,
+                                        lines.data.data()+ begin, static_cast<size_t>( lines.ends[ i]- begin), static_cast<size_t*>( 0),
+                                        ecDst, ecSrc, unicodeHelperConvertFlag_none);
+            szExpect                        += written;
+        }
+        bool const                  isSame( szBuffer== szConverter&& szBatch== szExpect
+                                            && memcmp( dstBatch.data(), expect.data(), szExpect)== 0);
+
+        printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %9.1fMB/s %7.2fx %7.2fx (%lu words)%s\n",
+                gBenchEncodings[ idxSrc].name,
+                ( ecDst== unicodeHelperEncoding_utf8)? "utf8": "utf16le",
+                mbsBuffer,
+                mbsConverter,
+                mbsBatch,
+                mbsConverter/ mbsBuffer,
+                mbsBatch/ mbsBuffer,
+                static_cast<unsigned long>( lines.ends.size()),
+                isSame? "": "  (output mismatch)");
+        if( isSame== false) result= 0;
+    }
+    return  result;
+}
+
+//  出力先の確保方法ごとに一語ずつの変換を計測(出力はutf-8。入力がutf-8ならutf-16le)
+static signed int   benchModeAlloc( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %12s %12s %8s %8s\n", "src", "dst", "measure", "heap", "pool", "arena", "heap", "arena");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        if( sources[ idxSrc].empty()!= false)   continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        unicodeHelperEncoding const ecDst( ( ecSrc== unicodeHelperEncoding_utf8)? unicodeHelperEncoding_utf16le: unicodeHelperEncoding_utf8);
+
+        //  コーパスを語ごとに入力のエンコードへ変換
+        benchLines const            lines( splitBenchLines( in_context.corpus, " \n", ecSrc));
+
+        //  前詰めの領域は全部の出力と語ごとの境界の調整、最初に欲しがるサイズが収まる大きさ
+        std::vector<uint8_t>        dstPool( 4096);
+        std::vector<uint8_t>        dstArena( lines.size()* 3+ lines.ends.size()* 16+ 4096);
+        size_t                      szMeasure( 0);
+        size_t                      szHeap( 0);
+        size_t                      szPool( 0);
+        size_t                      szArena( 0);
+
+        double const                mbsMeasure( measure( &szMeasure, runAllocMeasure, &dstPool,  lines, ecDst, ecSrc));
+        double const                mbsHeap(    measure( &szHeap,    runAllocHeap,    &dstPool,  lines, ecDst, ecSrc));
+        double const                mbsPool(    measure( &szPool,    runAllocPool,    &dstPool,  lines, ecDst, ecSrc));
+        double const                mbsArena(   measure( &szArena,   runAllocArena,   &dstArena, lines, ecDst, ecSrc));
+
+        //  前詰めの領域の最後の結果を、語ごとに変換したものと比べる
+        unicodeHelperArena          arena;
+        unicodeHelperArenaInit( &arena, dstArena.data(), dstArena.size());
+        unicodeHelperAllocator const    allocator= { unicodeHelperArenaResize, &arena};
+        bool                        isSame( szMeasure== szHeap&& szMeasure== szPool&& szMeasure== szArena);
+        std::vector<uint8_t>        expect( 4096);
+        for( size_t i= 0, begin= 0; i< lines.ends.size()&& isSame!= false; begin= lines.ends[ i], i++)
+        {
+            uint8_t const*const         pSrc( lines.data.data()+ begin);
+            size_t const                szSrc( static_cast<size_t>( lines.ends[ i]- begin));
+            size_t                      szExpect( 0);
+            unicodeHelperConvertBuffer( expect.data(), expect.size(), &szExpect, pSrc, szSrc, static_cast<size_t*>( 0),
+                                        ecDst, ecSrc, unicodeHelperConvertFlag_none);
+            uint8_t*                    pDst( static_cast<uint8_t*>( 0));
+            size_t                      written( 0);
+            unicodeHelperConvertAlloc( &allocator, &pDst, &written, pSrc, szSrc, ecDst, ecSrc, unicodeHelperConvertFlag_none);
+            isSame                          = ( written== szExpect&& ( written== 0|| memcmp( pDst, expect.data(), written)== 0));
+        }
+
+        printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %9.1fMB/s %9.1fMB/s %7.2fx %7.2fx (%lu words)%s\n",
+                gBenchEncodings[ idxSrc].name,
+                ( ecDst== unicodeHelperEncoding_utf8)? "utf8": "utf16le",
+                mbsMeasure,
+                mbsHeap,
+                mbsPool,
+                mbsArena,
+                mbsHeap/ mbsMeasure,
+                mbsArena/ mbsMeasure,
+                static_cast<unsigned long>( lines.ends.size()),
+                isSame? "": "  (output mismatch)");
+        if( isSame== false) result= 0;
+    }
+    return  result;
+}
+
+//  スレッド数を1からコア数まで倍にしながら並列の変換を計測(出力はutf-8。入力がutf-8ならutf-16le)
+static signed int   benchModeParallel( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    //  コアが一つでも、スレッドに分ける経路の出力は確かめる
+    uint32_t const              numCores( std::max( 2U, std::thread::hardware_concurrency()));
+    std::vector<uint32_t>       threads;
+    for( uint32_t num= 1UL; num< numCores; num*= 2UL)   threads.push_back( num);
+    threads.push_back( numCores);
+
+    printf( "%-10s %-10s", "src", "dst");
+    for( std::vector<uint32_t>::const_iterator it= threads.cbegin(); it!= threads.cend(); it++)
+    {
+        printf( " %9lu thr", static_cast<unsigned long>( *it));
+    }
+    printf( " %8s\n", "scale");
+
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        unicodeHelperEncoding const ecDst( ( ecSrc== unicodeHelperEncoding_utf8)? unicodeHelperEncoding_utf16le: unicodeHelperEncoding_utf8);
+        std::vector<uint8_t>        dstSingle( src.size()* 3+ 16);
+        std::vector<uint8_t>        dst( src.size()* 3+ 16);
+        size_t                      szSingle( 0);
+        bool                        isSame( true);
+        double                      mbsFirst( 0.0);
+        double                      mbsLast( 0.0);
+
+        printf( "%-10s %-10s", gBenchEncodings[ idxSrc].name, ( ecDst== unicodeHelperEncoding_utf8)? "utf8": "utf16le");
+        for( std::vector<uint32_t>::const_iterator it= threads.cbegin(); it!= threads.cend(); it++)
+        {
+            size_t                      sz( 0);
+            gBenchThreads                   = *it;
+            mbsLast                         = measure( &sz, runParallel, ( it== threads.cbegin())? &dstSingle: &dst, src, ecDst, ecSrc);
+            if( it== threads.cbegin())
+            {
+                mbsFirst                        = mbsLast;
+                szSingle                        = sz;
+            } else if( sz!= szSingle|| memcmp( dst.data(), dstSingle.data(), sz)!= 0) {
+                isSame                          = false;
+            }
+            printf( " %8.1fMB/s", mbsLast);
+        }
+        printf( " %7.2fx%s\n", mbsLast/ mbsFirst, isSame? "": "  (output mismatch)");
+        if( isSame== false) result= 0;
+    }
+    return  result;
+}
+
+//  4[GiB]を超える入力を流す(出力はutf-8。入力がutf-8ならutf-16le)
+static signed int   benchModeStream( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %14s %14s %10s %s\n", "src", "dst", "block", "consumed", "written", "progress", "analyzed");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        unicodeHelperEncoding const ecDst( ( ecSrc== unicodeHelperEncoding_utf8)? unicodeHelperEncoding_utf16le: unicodeHelperEncoding_utf8);
+
+        //  一回分の出力サイズから、全体の出力サイズが分かるように入力は繰り返しの切れ目で終える
+        std::vector<uint8_t>        dst( src.size()* 3+ 16);
+        size_t const                szUnit( runBuffer( &dst, src, ecDst, ecSrc));
+        uint64_t const              numRepeat( ( ( gBenchStreamGiB<< 30)+ src.size()- 1)/ src.size());
+        uint64_t const              total( numRepeat* src.size());
+
+        benchRepeatStream           stream( src.data(), src.size(), total);
+        std::chrono::steady_clock::time_point const begin( std::chrono::steady_clock::now());
+        signed int const            converted( unicodeHelperConvertBlockProgress( benchRepeatWriteBlock, ecDst, 0, benchRepeatReadBlock, ecSrc, benchRepeatProgress, &stream));
+        double const                sec( elapsedSec( begin));
+        bool const                  isSame( converted!= 0
+                                            && stream.progressConsumed== total
+                                            && stream.progressWritten== numRepeat* szUnit
+                                            && stream.written== stream.progressWritten);
+
+        //  一文字ずつの判定も最後まで読める(4[GiB]を過ぎても候補が外れない)か
+        benchRepeatStream           streamAnalyze( src.data(), src.size(), total);
+        unicodeHelperEncoding const ecAnalyze( unicodeHelperAnalyzeEncoding( benchRepeatRead, &streamAnalyze));
+
+        printf( "%-10s %-10s %9.1fMB/s %14llu %14llu %10llu %s%s\n",
+                gBenchEncodings[ idxSrc].name,
+                benchEncodingName( ecDst),
+                static_cast<double>( total)/ sec/ 1.0e6,
+                static_cast<unsigned long long>( stream.progressConsumed),
+                static_cast<unsigned long long>( stream.progressWritten),
+                static_cast<unsigned long long>( stream.numProgress),
+                benchEncodingName( ecAnalyze),
+                isSame? "": "  (size mismatch)");
+        if( isSame== false) result= 0;
+    }
+    return  result;
+}
+
+//  出力サイズの計測と実際の変換を比較
+static signed int   benchModeMeasure( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %8s\n", "src", "dst", "measure", "buffer", "ratio");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        for( size_t idxDst= 0; idxDst< numEncodings; idxDst++)
+        {
+            //  コーパスを表せないエンコーディングへは変換できないので計測しない
+            if( sources[ idxDst].empty()!= false)   continue;
+
+            unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxDst].encoding);
+            std::vector<uint8_t>        dummy;
+            std::vector<uint8_t>        dstBuffer( src.size()* 3+ 16);
+            size_t                      szMeasure( 0);
+            size_t                      szBuffer( 0);
+
+            double const                mbsMeasure( measure( &szMeasure, runMeasure, &dummy,     src, ecDst, ecSrc));
+            double const                mbsBuffer(  measure( &szBuffer,  runBuffer,  &dstBuffer, src, ecDst, ecSrc));
+
+            printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %7.2fx%s\n",
+                    gBenchEncodings[ idxSrc].name,
+                    gBenchEncodings[ idxDst].name,
+                    mbsMeasure,
+                    mbsBuffer,
+                    mbsMeasure/ mbsBuffer,
+                    ( szMeasure== szBuffer)? "": "  (size mismatch)");
+            if( szMeasure!= szBuffer)   result= 0;
+        }
+    }
+    return  result;
+}
+
+//  エンコーディングの判定を計測(比較用にutf-8への変換も。入力がutf-8ならutf-16le)
+static signed int   benchModeDetect( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %12s %8s  %-10s %s\n", "src", "", "analyze", "detect", "buffer", "ratio", "analyzed", "detected");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        unicodeHelperEncoding const ecDst( ( ecSrc== unicodeHelperEncoding_utf8)? unicodeHelperEncoding_utf16le: unicodeHelperEncoding_utf8);
+        std::vector<uint8_t>        dummy;
+        std::vector<uint8_t>        dstBuffer( src.size()* 3+ 16);
+        size_t                      ecAnalyze( 0);
+        size_t                      ecDetect( 0);
+        size_t                      szBuffer( 0);
+
+        double const                mbsAnalyze( measure( &ecAnalyze, runAnalyze, &dummy,     src, ecSrc, ecSrc));
+        double const                mbsDetect(  measure( &ecDetect,  runDetect,  &dummy,     src, ecSrc, ecSrc));
+        double const                mbsBuffer(  measure( &szBuffer,  runBuffer,  &dstBuffer, src, ecDst, ecSrc));
+
+        unicodeHelperDetectCandidate    candidate;
+        candidate._encoding             = unicodeHelperEncoding_unknown;
+        candidate._confidence           = 0;
+        unicodeHelperDetectEncoding( &candidate, 1, static_cast<signed int*>( 0), src.data(), src.size());
+
+        printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %9.1fMB/s %7.2fx  %-10s %s(%lu)\n",
+                gBenchEncodings[ idxSrc].name,
+                "detect",
+                mbsAnalyze,
+                mbsDetect,
+                mbsBuffer,
+                mbsDetect/ mbsAnalyze,
+                benchEncodingName( static_cast<unicodeHelperEncoding>( ecAnalyze)),
+                benchEncodingName( candidate._encoding),
+                static_cast<unsigned long>( candidate._confidence));
+    }
+    return  result;
+}
+
+//  検証だけを計測
+static signed int   benchModeValidate( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %8s\n", "src", "", "validate", "discard", "ratio");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+        std::vector<uint8_t>        dummy;
+        size_t                      szValidate( 0);
+        size_t                      szDiscard( 0);
+
+        double const                mbsValidate( measure( &szValidate, runValidate, &dummy, src, ecSrc, ecSrc));
+        double const                mbsDiscard(  measure( &szDiscard,  runDiscard,  &dummy, src, ecSrc, ecSrc));
+
+        printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %7.2fx%s\n",
+                gBenchEncodings[ idxSrc].name,
+                "validate",
+                mbsValidate,
+                mbsDiscard,
+                mbsValidate/ mbsDiscard,
+                ( szValidate== src.size())? "": "  (invalid?)");
+        if( szValidate!= src.size())    result= 0;
+    }
+    return  result;
+}
+
+//  指定の出力エンコード(allなら全部)への変換をコールバック/ブロック/メモリ上で計測
+static signed int   benchModeConvert( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    std::vector< std::vector<uint8_t> > const&  sources( in_context.sources);
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %12s %12s %12s %8s\n", "src", "dst", "callback", "block", "buffer", "ratio");
+    for( size_t idxSrc= 0; idxSrc< numEncodings; idxSrc++)
+    {
+        std::vector<uint8_t> const& src( sources[ idxSrc]);
+        if( src.empty()!= false)    continue;
+        if( in_context.isSourceSelected( idxSrc)== false)  continue;
+
+        for( size_t idxDst= 0; idxDst< numEncodings; idxDst++)
+        {
+            if( strcmp( in_context.nameDst, "all")!= 0
+                && strcmp( in_context.nameDst, gBenchEncodings[ idxDst].name)!= 0)
+            {
+                continue;
+            }
+            //  コーパスを表せないエンコーディングへは変換できないので計測しない
+            if( sources[ idxDst].empty()!= false)   continue;
+
+            unicodeHelperEncoding const ecSrc( gBenchEncodings[ idxSrc].encoding);
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxDst].encoding);
+            std::vector<uint8_t>        dstCallback( src.size()* 3+ 16);
+            std::vector<uint8_t>        dstBlock(    src.size()* 3+ 16);
+            std::vector<uint8_t>        dstBuffer(   src.size()* 3+ 16);
+            size_t                      szCallback( 0);
+            size_t                      szBlock( 0);
+            size_t                      szBuffer( 0);
+
+            double const                mbsCallback( measure( &szCallback, runCallback, &dstCallback, src, ecDst, ecSrc));
+            double const                mbsBlock(    measure( &szBlock,    runBlock,    &dstBlock,    src, ecDst, ecSrc));
+            double const                mbsBuffer(   measure( &szBuffer,   runBuffer,   &dstBuffer,   src, ecDst, ecSrc));
+
+            bool const                  isSame( szCallback== szBuffer
+                                                && szBlock== szBuffer
+                                                && memcmp( dstCallback.data(), dstBuffer.data(), szBuffer)== 0
+                                                && memcmp( dstBlock.data(), dstBuffer.data(), szBuffer)== 0);
+            printf( "%-10s %-10s %9.1fMB/s %9.1fMB/s %9.1fMB/s %7.2fx%s\n",
+                    gBenchEncodings[ idxSrc].name,
+                    gBenchEncodings[ idxDst].name,
+                    mbsCallback,
+                    mbsBlock,
+                    mbsBuffer,
+                    mbsBuffer/ mbsCallback,
+                    isSame? "": "  (output mismatch)");
+            if( isSame== false) result= 0;
+        }
+    }
+    return  result;
+}
+
+//  カレントディレクトリの表のファイル(<エンコード名>.uht)を、表で引く全部のエンコードに結び付けてみる
+//  (名前が同じエンコードにだけ結び付き、変換結果が組み込みの表と同じこと)
+static signed int   benchModeBind( benchContext const& in_context)
+{
+    size_t const                numEncodings( sizeof(gBenchEncodings)/ sizeof(gBenchEncodings[0]));
+    size_t const                idxFirst( findBenchEncoding( unicodeHelperEncoding_cp932));
+    signed int                  result( -1);
+
+    printf( "%-10s %-10s %-10s %s\n", "table", "encoding", "bind", "output");
+    for( size_t idxTable= idxFirst; idxTable< numEncodings; idxTable++)
+    {
+        std::string const           path( std::string( gBenchEncodings[ idxTable].name)+ ".uht");
+        unicodeHelperTable const*const  pTable( unicodeHelperLoadTable( path.c_str()));
+        if( pTable== static_cast<unicodeHelperTable const*>( 0))
+        {
+            printf( "%-10s can't load %s\n", gBenchEncodings[ idxTable].name, path.c_str());
+            continue;
+        }
+        for( size_t idxEnc= idxFirst; idxEnc< numEncodings; idxEnc++)
+        {
+            unicodeHelperEncoding const ecDst( gBenchEncodings[ idxEnc].encoding);
+            bool const                  isExpected( idxEnc== idxTable);
+            bool const                  isBound( unicodeHelperBindTable( ecDst, pTable)!= 0);
+
+            //  結び付いたら、組み込みの表で作った入力(sources)と同じ結果になること
+            char const*                 output( "-");
+            if( isBound!= false&& in_context.sources[ idxEnc].empty()== false)
+            {
+                std::vector<uint8_t> const& expect( in_context.sources[ idxEnc]);
+                std::vector<uint8_t>        dst( expect.size()+ 16);
+                size_t                      written( 0);
+                bool const                  isSame( unicodeHelperConvertBuffer( dst.data(), dst.size(), &written,
+                                                                                reinterpret_cast<uint8_t const*>( in_context.corpus.data()), in_context.corpus.size(), static_cast<size_t*>( 0),
+                                                                                ecDst, unicodeHelperEncoding_utf8, unicodeHelperConvertFlag_none)!= 0
+                                                    && written== expect.size()
+                                                    && memcmp( dst.data(), expect.data(), written)== 0);
+                output                          = isSame? "identical": "mismatch";
+                if( isSame== false) result= 0;
+            }
+            unicodeHelperBindTable( ecDst, static_cast<unicodeHelperTable const*>( 0));
+
+            printf( "%-10s %-10s %-10s %s%s\n",
+                    gBenchEncodings[ idxTable].name,
+                    gBenchEncodings[ idxEnc].name,
+                    isBound? "bound": "rejected",
+                    output,
+                    ( isBound== isExpected)? "": "  (unexpected)");
+            if( isBound!= isExpected)   result= 0;
+        }
+        unicodeHelperUnloadTable( pTable);
+    }
+    return  result;
+}
+
+//  計測の種類(出力エンコード名の代わりに指定する名前と計測する関数。戻り値は0なら出力が合わないものがあった)
+typedef signed int(*benchModeFunc)( benchContext const& in_context);
+
+/// @class  benchMode
+/// @brief  計測の種類の名前と関数の組
+class   benchMode
+{
+public:
+    char const*                 name;
+    benchModeFunc               run;
+};
+
+static benchMode const          gBenchModes[]= {
+    { "csv",        benchModeCSV},
+    { "iconv",      benchModeIconv},
+    { "template",   benchModeTemplate},
+    { "string",     benchModeString},
+    { "codepoints", benchModeCodepoints},
+    { "lookup",     benchModeLookup},
+    { "short",      benchModeShort},
+    { "alloc",      benchModeAlloc},
+    { "parallel",   benchModeParallel},
+    { "stream",     benchModeStream},
+    { "measure",    benchModeMeasure},
+    { "detect",     benchModeDetect},
+    { "validate",   benchModeValidate},
+    { "bind",       benchModeBind},
+};
+
+//  コーパス一つについて指定の種類を計測(出力エンコード名が種類の名前でなければ変換を計測。戻り値は0なら出力が合わないものがあった)
+static signed int   benchCorpusRun( benchCorpus const&  in_info,
+                                    std::string const&  in_corpus,
+                                    char const*const    in_nameSrc,
+                                    char const*const    in_nameDst)
+{
+    benchContext const          context( in_info, in_corpus, in_nameSrc, in_nameDst);
+    for( size_t i= 0; i< sizeof(gBenchModes)/ sizeof(gBenchModes[0]); i++)
+    {
+        if( strcmp( in_nameDst, gBenchModes[ i].name)== 0)  return  gBenchModes[ i].run( context);
+    }
+    return  benchModeConvert( context);
+}
+
+int main( int in_argC, char** in_argV)
+{
+    size_t                      sizeCorpus( 4UL* 1024UL* 1024UL);
+    if( in_argC>= 2)
+    {
+        sizeCorpus                      = static_cast<size_t>( strtoul( *static_cast<char**>( in_argV+ 1), static_cast<char**>( 0), 10))* 1024UL;
+    }
+    char const*const            nameCorpus( ( in_argC>= 3)? *static_cast<char**>( in_argV+ 2): "all");
+    char const*const            nameSrc(    ( in_argC>= 4)? *static_cast<char**>( in_argV+ 3): "all");
+    char const*const            nameDst(    ( in_argC>= 5)? *static_cast<char**>( in_argV+ 4): "all");
+    if( in_argC>= 6)
+    {
+        gBenchStreamGiB                 = static_cast<uint64_t>( strtoull( *static_cast<char**>( in_argV+ 5), static_cast<char**>( 0), 10));
+    }
+
+    bool const                  isCSV( strcmp( nameDst, "csv")== 0);
+    if( isCSV!= false)  printf( "%s\n", gBenchCSVHeader);
+
+    signed int                  result( -1);
+    for( size_t i= 0; i< sizeof(gBenchCorpora)/ sizeof(gBenchCorpora[0]); i++)
+    {
+        benchCorpus const&          corpus( gBenchCorpora[ i]);
+        if( strcmp( nameCorpus, "all")!= 0
+            && strcmp( nameCorpus, corpus.name)!= 0)
+        {
+            continue;
+        }
+
+        if( isCSV== false)  printf( "# corpus: %s (%luKiB)\n", corpus.name, static_cast<unsigned long>( sizeCorpus/ 1024UL));
+        if( benchCorpusRun( corpus, makeCorpus( corpus, sizeCorpus), nameSrc, nameDst)== 0) result= 0;
+        if( isCSV== false)  printf( "\n");
+    }
+
+    //  出力が合わないものがあればスクリプトから分かるように失敗で終える
+    return  ( result!= 0)? 0: 1;
+}
+
+//  End of Source [unicodeHelperBench.cpp]
@@ -0,0 +1,399 @@
+/// @file   unicodeHelperScan.cpp
+/// @brief  ディレクトリの下のファイルのエンコードを複数のスレッドで判定し、JSON Linesで出力する
+/// @note   unicodeHelperScan (-j スレッド数) (-n 判定に読むサイズ(KiB)) [ディレクトリ|ファイル]...
+/// 一行に一ファイルで{"path":..,"encoding":..,"confidence":..,"bom":..,"ascii":..,"size":..}を出力する(順番は不定)
+/// 判定はファイルの先頭だけをunicodeHelperDetectEncoding()に渡し、読めないファイルは"error"を出力する
+/// パスのutf-8として不正なbyteは、そのbyteの値を\u00XXとして出力する(U+0080..U+00FFの文字と区別は付かない)
+/// -j 0(既定)は実行中のcpuのコア数。シンボリックリンクはたどらない
+/// 終了コードは、全部判定できれば0、開けなかったパスか判定できなかったファイルがあれば1、指定が不正なら2
+/// 仕事(ディレクトリの一覧とファイルの判定)はスレッドごとの両端キューに積み、
+/// 自分のキューは後ろから取り、空になったら他のスレッドのキューの前から盗む(どこにも無ければ積まれるまで眠る)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "text/unicodeHelper.h"
+
+//  判定に読むファイルの先頭のサイズの既定値([byte])
+static size_t const             gScanPrefixDefault= 64UL* 1024UL;
+//  スレッドごとにためてから出力する行のサイズ([byte])
+static size_t const             gScanFlushSize= 64UL* 1024UL;
+
+//  表示名
+static char const*  scanEncodingName( unicodeHelperEncoding const in_encoding)
+{
+    switch( in_encoding)
+    {
+    case    unicodeHelperEncoding_utf8:     return  "utf8";
+    case    unicodeHelperEncoding_utf16le:  return  "utf16le";
+    case    unicodeHelperEncoding_utf16be:  return  "utf16be";
+    case    unicodeHelperEncoding_cp932:    return  "cp932";
+    default:                                return  "unknown";
+    }
+}
+
+/// @class  scanQueue
+/// @brief  スレッドごとの仕事(パス)の両端キュー
+class   scanQueue
+{
+public:
+    std::mutex                  lock;
+    std::deque<std::string>     paths;
+};
+
+/// @class  scanPool
+/// @brief  全スレッドで共有する状態
+class   scanPool
+{
+public:
+    std::vector<scanQueue>      queues;
+    //  積んだがまだ終わっていない仕事の数(0になったら全部終わり)
+    std::atomic<size_t>         pending;
+    //  これまでに積んだ仕事の数(増やすのはlockWaitの中。仕事の無いスレッドはこれが増えるか全部終わるまで眠る)
+    std::atomic<uint64_t>       numPushed;
+    std::mutex                  lockWait;
+    std::condition_variable     wake;
+    //  開けなかったパスと判定できなかったファイルの数(0でなければ終了コードを1にする)
+    std::atomic<size_t>         numErrors;
+    std::mutex                  lockOut;
+    size_t                      szPrefix;
+
+    scanPool( size_t const  in_numThreads,
+              size_t const  in_szPrefix)
+    : queues(    in_numThreads)
+    , pending(   0)
+    , numPushed( 0)
+    , lockWait()
+    , wake()
+    , numErrors( 0)
+    , lockOut()
+    , szPrefix(  in_szPrefix)
+    {
+    }
+};
+
+/// @class  scanWorker
+/// @brief  スレッドごとに使い回す判定の作業領域(ファイルごとに確保しない)
+class   scanWorker
+{
+public:
+    scanPool*                   pPool;
+    size_t                      idxQueue;
+    std::vector<uint8_t>        prefix;
+    std::string                 lines;
+
+    scanWorker( scanPool*const  in_pool,
+                size_t const    in_idxQueue)
+    : pPool(    in_pool)
+    , idxQueue( in_idxQueue)
+    , prefix(   in_pool->szPrefix)
+    , lines()
+    {
+        lines.reserve( gScanFlushSize* 2UL);
+    }
+};
+
+//  仕事を自分のキューの後ろに積み、眠っているスレッドを一つ起こす
+static void pushScanPath( scanWorker*const      io_worker,
+                          std::string const&    in_path)
+{
+    scanPool&                   pool( *io_worker->pPool);
+    scanQueue&                  queue( pool.queues[ io_worker->idxQueue]);
+    pool.pending.fetch_add( 1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard( queue.lock);
+        queue.paths.push_back( in_path);
+    }
+    {
+        std::lock_guard<std::mutex> guard( pool.lockWait);
+        pool.numPushed.fetch_add( 1, std::memory_order_release);
+    }
+    pool.wake.notify_one();
+}
+
+//  仕事を取る(自分のキューは後ろから、他のスレッドのキューは前から)
+static bool popScanPath( scanWorker*const   io_worker,
+                         std::string*const  out_path)
+{
+    std::vector<scanQueue>&     queues( io_worker->pPool->queues);
+    for( size_t idx= 0; idx< queues.size(); idx++)
+    {
+        size_t const                idxQueue( ( io_worker->idxQueue+ idx)% queues.size());
+        scanQueue&                  queue( queues[ idxQueue]);
+        std::lock_guard<std::mutex> guard( queue.lock);
+        if( queue.paths.empty()!= false)    continue;
+
+        if( idx== 0)
+        {
+            out_path->swap( queue.paths.back());
+            queue.paths.pop_back();
+        } else {
+            out_path->swap( queue.paths.front());
+            queue.paths.pop_front();
+        }
+        return  true;
+    }
+    return  false;
+}
+
+//  JSONの文字列として追加
+//  utf-8として正しい所はそのまま、不正なbyte(utf-8でないファイル名など)はそのbyteの値を\u00XXにする
+static void appendScanString( std::string*const io_dst,
+                              char const*const  in_src)
+{
+    static char const           hex[]= "0123456789abcdef";
+    uint8_t const*const         pSrc( reinterpret_cast<uint8_t const*>( in_src));
+    size_t const                len( strlen( in_src));
+    size_t                      idx( 0);
+    io_dst->push_back( '"');
+    while( idx< len)
+    {
+        size_t                      szValid( 0);
+        unicodeHelperValidate( unicodeHelperEncoding_utf8, pSrc+ idx, len- idx, &szValid);
+        for( size_t const end( idx+ szValid); idx< end; idx++)
+        {
+            unsigned char const         c( pSrc[ idx]);
+            if( c== '"'|| c== '\\')
+            {
+                io_dst->push_back( '\\');
+                io_dst->push_back( static_cast<char>( c));
+            } else if( c< 0x20U)
+            {
+                io_dst->append( "\\u00");
+                io_dst->push_back( hex[ c>> 4]);
+                io_dst->push_back( hex[ c& 0x0fU]);
+            } else {
+                io_dst->push_back( static_cast<char>( c));
+            }
+        }
+        if( idx< len)
+        {
+            unsigned char const         c( pSrc[ idx]);
+            io_dst->append( "\\u00");
+            io_dst->push_back( hex[ c>> 4]);
+            io_dst->push_back( hex[ c& 0x0fU]);
+            idx++;
+        }
+    }
+    io_dst->push_back( '"');
+}
+
+//  開けなかったパスを一行ためる
+static void appendScanError( scanWorker*const   io_worker,
+                             std::string const& in_path,
+                             int const          in_error)
+{
+    io_worker->lines.append( "{\"path\":");
+    appendScanString( &io_worker->lines, in_path.c_str());
+    io_worker->lines.append( ",\"error\":");
+    appendScanString( &io_worker->lines, strerror( in_error));
+    io_worker->lines.append( "}\n");
+    io_worker->pPool->numErrors.fetch_add( 1, std::memory_order_relaxed);
+}
+
+//  ためた行を出力
+static void flushScanLines( scanWorker*const    io_worker)
+{
+    if( io_worker->lines.empty()!= false)   return;
+
+    std::lock_guard<std::mutex> guard( io_worker->pPool->lockOut);
+    fwrite( io_worker->lines.data(), 1, io_worker->lines.size(), stdout);
+    io_worker->lines.clear();
+}
+
+//  ファイルの先頭を読んで判定し、一行ためる
+static void scanFile( scanWorker*const      io_worker,
+                      std::string const&    in_path,
+                      uint64_t const        in_size)
+{
+    int const                   fd( open( in_path.c_str(), O_RDONLY));
+    size_t                      szRead( 0);
+    bool                        isOk( fd>= 0);
+    int                         error( errno);
+    while( isOk!= false&& szRead< io_worker->prefix.size())
+    {
+        ssize_t const               sz( read( fd, io_worker->prefix.data()+ szRead, io_worker->prefix.size()- szRead));
+        if( sz< 0&& errno== EINTR)  continue;
+        if( sz<= 0)
+        {
+            isOk                            = ( sz== 0);
+            error                           = errno;
+            break;
+        }
+        szRead                          += static_cast<size_t>( sz);
+    }
+    if( fd>= 0) close( fd);
+
+    if( isOk== false)
+    {
+        appendScanError( io_worker, in_path, error);
+        return;
+    }
+
+    uint8_t const*const         pPrefix( io_worker->prefix.data());
+    unicodeHelperDetectCandidate    candidate= { unicodeHelperEncoding_unknown, 0UL};
+    signed int                  isASCII( 0);
+    if( szRead!= 0
+        && unicodeHelperDetectEncoding( &candidate, 1, &isASCII, pPrefix, szRead)== 0)
+    {
+        candidate._encoding             = unicodeHelperEncoding_unknown;
+        candidate._confidence           = 0UL;
+        io_worker->pPool->numErrors.fetch_add( 1, std::memory_order_relaxed);
+    }
+    bool const                  hasBOM( ( szRead>= 3&& pPrefix[ 0]== 0xefU&& pPrefix[ 1]== 0xbbU&& pPrefix[ 2]== 0xbfU)
+                                        || ( szRead>= 2&& pPrefix[ 0]== 0xffU&& pPrefix[ 1]== 0xfeU)
+                                        || ( szRead>= 2&& pPrefix[ 0]== 0xfeU&& pPrefix[ 1]== 0xffU));
+
+    std::string&                line( io_worker->lines);
+    line.append( "{\"path\":");
+    appendScanString( &line, in_path.c_str());
+
+    char                        buf[ 128];
+    snprintf( buf, sizeof(buf), ",\"encoding\":\"%s\",\"confidence\":%u,\"bom\":%s,\"ascii\":%s,\"size\":%llu}\n",
+              scanEncodingName( candidate._encoding), static_cast<unsigned int>( candidate._confidence),
+              hasBOM? "true": "false", ( isASCII!= 0)? "true": "false", static_cast<unsigned long long>( in_size));
+    line.append( buf);
+}
+
+//  ディレクトリの中身を仕事として積む
+static void scanDirectory( scanWorker*const     io_worker,
+                           std::string const&   in_path)
+{
+    DIR*const                   pDir( opendir( in_path.c_str()));
+    if( pDir== static_cast<DIR*>( 0))
+    {
+        appendScanError( io_worker, in_path, errno);
+        return;
+    }
+
+    std::string const           prefix( ( in_path.empty()== false&& in_path[ in_path.size()- 1]== '/')? in_path: in_path+ "/");
+    for( struct dirent* pEnt= readdir( pDir); pEnt!= static_cast<struct dirent*>( 0); pEnt= readdir( pDir))
+    {
+        if( strcmp( pEnt->d_name, ".")== 0|| strcmp( pEnt->d_name, "..")== 0)  continue;
+        pushScanPath( io_worker, prefix+ pEnt->d_name);
+    }
+    closedir( pDir);
+}
+
+//  一つの仕事(パスがディレクトリなら中身を積み、通常のファイルなら判定)
+static void scanPath( scanWorker*const      io_worker,
+                      std::string const&    in_path)
+{
+    struct stat                 st;
+    if( lstat( in_path.c_str(), &st)!= 0)
+    {
+        appendScanError( io_worker, in_path, errno);
+    } else if( S_ISDIR( st.st_mode))
+    {
+        scanDirectory( io_worker, in_path);
+    } else if( S_ISREG( st.st_mode))
+    {
+        scanFile( io_worker, in_path, static_cast<uint64_t>( st.st_size));
+    }
+    if( io_worker->lines.size()>= gScanFlushSize)   flushScanLines( io_worker);
+}
+
+//  スレッドの本体(全部の仕事が終わるまで取っては実行する)
+static void runScanWorker( scanWorker*const io_worker)
+{
+    scanPool&                   pool( *io_worker->pPool);
+    std::string                 path;
+    while( true)
+    {
+        //  取る前の数を覚えておき、取れなければそれより後に積まれるまで眠る
+        uint64_t const              numPushed( pool.numPushed.load( std::memory_order_acquire));
+        if( popScanPath( io_worker, &path)!= false)
+        {
+            scanPath( io_worker, path);
+            if( pool.pending.fetch_sub( 1, std::memory_order_acq_rel)== 1)
+            {
+                //  最後の仕事なら眠っているスレッドを全部起こして終わらせる
+                std::lock_guard<std::mutex> guard( pool.lockWait);
+                pool.wake.notify_all();
+            }
+            continue;
+        }
+
+        //  他のスレッドがディレクトリを読んでいる間は眠って待つ
+        flushScanLines( io_worker);
+        std::unique_lock<std::mutex>    lock( pool.lockWait);
+        while( pool.pending.load( std::memory_order_acquire)!= 0
+               && pool.numPushed.load( std::memory_order_relaxed)== numPushed)
+        {
+            pool.wake.wait( lock);
+        }
+        if( pool.pending.load( std::memory_order_acquire)== 0)  break;
+    }
+    flushScanLines( io_worker);
+}
+
+
+int main( int in_argC, char** in_argV)
+{
+    uint32_t                    numThreads( 0);
+    size_t                      szPrefix( gScanPrefixDefault);
+    int                         idxArg( 1);
+    while( idxArg+ 1< in_argC&& in_argV[ idxArg][ 0]== '-')
+    {
+        char const*const            value( *static_cast<char**>( in_argV+ idxArg+ 1));
+        if( strcmp( in_argV[ idxArg], "-j")== 0)
+        {
+            numThreads                      = static_cast<uint32_t>( strtoul( value, static_cast<char**>( 0), 10));
+        } else if( strcmp( in_argV[ idxArg], "-n")== 0)
+        {
+            szPrefix                        = static_cast<size_t>( strtoul( value, static_cast<char**>( 0), 10))* 1024UL;
+        } else {
+            break;
+        }
+        idxArg                          += 2;
+    }
+    if( idxArg>= in_argC|| in_argV[ idxArg][ 0]== '-'|| szPrefix== 0)
+    {
+        fprintf( stderr, "%s (-j THREADS) (-n PREFIX_KIB) [DIRECTORY|FILE]...\n", *in_argV);
+        return  2;
+    }
+
+    if( numThreads== 0UL)   numThreads= static_cast<uint32_t>( std::thread::hardware_concurrency());
+    if( numThreads== 0UL)   numThreads= 1UL;
+
+    scanPool                    pool( numThreads, szPrefix);
+    std::vector<scanWorker>     workers;
+    workers.reserve( numThreads);
+    for( uint32_t idx= 0UL; idx< numThreads; idx++)
+    {
+        workers.push_back( scanWorker( &pool, idx));
+    }
+
+    //  指定されたパスは最初のスレッドのキューに積み、残りのスレッドはそこから盗む
+    for( ; idxArg< in_argC; idxArg++)
+    {
+        pushScanPath( &workers[ 0], *static_cast<char**>( in_argV+ idxArg));
+    }
+
+    std::vector<std::thread>    threads;
+    for( uint32_t idx= 1UL; idx< numThreads; idx++)
+    {
+        threads.push_back( std::thread( runScanWorker, &workers[ idx]));
+    }
+    runScanWorker( &workers[ 0]);
+    for( std::vector<std::thread>::iterator it= threads.begin(); it!= threads.end(); it++)
+    {
+        it->join();
+    }
+    fflush( stdout);
+    return  ( pool.numErrors.load( std::memory_order_relaxed)!= 0)? 1: 0;
+}
+
+//  End of Source [unicodeHelperScan.cpp]
@@ -0,0 +1,503 @@
+/// @file   unicodehelper.cpp
+/// @brief  unicodeHelperでファイルや標準入力のエンコードを変換するコマンド
+/// @note   unicodehelper (-f 入力エンコード名|auto) (-t 出力エンコード名) (-b|-B) (-j スレッド数) (-o 出力ファイル) [入力ファイル|-]...
+/// 入力エンコードの既定はauto(ファイルごとにunicodeHelperDetectEncoding()で判定)、出力エンコードの既定はutf8
+/// -bで出力の先頭にBOMを付け、-B(既定)で付けない。入力の先頭のBOMはどちらの場合も出力しない
+/// -j 0は実行中のcpuのコア数
+/// 通常のファイルはmmap()して先頭から順に読むことをmadvise()で伝え、
+/// パイプや標準入力は大きなブロックでread()して、どちらもunicodeHelperConverterRunParallel()に窓ごとに渡す
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "text/unicodeHelper.h"
+
+//  一つのスレッドが一度に変換する入力のサイズ([byte])
+static size_t const             gCliWindowPerThread= 8UL* 1024UL* 1024UL;
+//  入力元のエンコードの判定に使う先頭のサイズ([byte])
+static size_t const             gCliDetectLookahead= 16UL* 1024UL;
+//  入力の1[byte]から出力される最大のサイズ([byte])
+//  (cp932などの1[byte]文字からutf-8の3[byte]文字が最大。サロゲートペアはutf-8でもutf-16でも4[byte])
+static size_t const             gCliExpandMax= 3UL;
+//  切れた文字として次の窓に持ち越す最大のサイズ([byte])
+static size_t const             gCliCarryMax= 3UL;
+
+/// @class  cliEncoding
+/// @brief  コマンドラインで指定するエンコーディング名
+class   cliEncoding
+{
+public:
+    unicodeHelperEncoding       encoding;
+    char const*                 name;
+};
+
+//  指定できるエンコーディング
+static cliEncoding const        gCliEncodings[]= {
+    { unicodeHelperEncoding_utf8,       "utf8"},
+    { unicodeHelperEncoding_utf16arch,  "utf16"},
+    { unicodeHelperEncoding_utf16le,    "utf16le"},
+    { unicodeHelperEncoding_utf16be,    "utf16be"},
+    { unicodeHelperEncoding_cp932,      "cp932"},
+    { unicodeHelperEncoding_shiftJIS,   "shiftjis"},
+    { unicodeHelperEncoding_eucJP,      "eucjp"},
+    { unicodeHelperEncoding_gbk,        "gbk"},
+    { unicodeHelperEncoding_big5,       "big5"},
+    { unicodeHelperEncoding_cp949,      "cp949"},
+};
+
+//  名前からエンコーディング(無ければunknown)
+static unicodeHelperEncoding    findCliEncoding( char const*const in_name)
+{
+    for( size_t idx= 0; idx< sizeof(gCliEncodings)/ sizeof(gCliEncodings[0]); idx++)
+    {
+        if( strcmp( gCliEncodings[ idx].name, in_name)== 0) return  gCliEncodings[ idx].encoding;
+    }
+    return  unicodeHelperEncoding_unknown;
+}
+
+//  エンコーディングの表示名
+static char const*  cliEncodingName( unicodeHelperEncoding const in_encoding)
+{
+    for( size_t idx= 0; idx< sizeof(gCliEncodings)/ sizeof(gCliEncodings[0]); idx++)
+    {
+        if( gCliEncodings[ idx].encoding== in_encoding) return  gCliEncodings[ idx].name;
+    }
+    return  "unknown";
+}
+
+//  in_encodingでのU+FEFFを書き込み、サイズ([byte])を返す(BOMの無いエンコーディングは0)
+static size_t   encodeCliBOM( uint8_t*const                 out_dst,
+                              size_t const                  in_dstCap,
+                              unicodeHelperEncoding const   in_encoding)
+{
+    //  空の入力をBOM付きで変換すると、BOMだけが出力される
+    unicodeHelperConverter const*const  pConverter( unicodeHelperConverterCreate( in_encoding, unicodeHelperEncoding_utf8, unicodeHelperConvertFlag_withBOM));
+    if( pConverter== static_cast<unicodeHelperConverter const*>( 0))    return  0;
+
+    size_t                      written( 0);
+    if( unicodeHelperConverterRun( pConverter, out_dst, in_dstCap, &written, out_dst, 0, static_cast<size_t*>( 0))== 0)
+    {
+        written                         = 0;
+    }
+    unicodeHelperConverterDestroy( pConverter);
+    return  written;
+}
+
+/// @class  cliOption
+/// @brief  コマンドラインの指定
+class   cliOption
+{
+public:
+    unicodeHelperEncoding       ecSrc;
+    unicodeHelperEncoding       ecDst;
+    bool                        withBOM;
+    uint32_t                    numThreads;
+    char const*                 pathOut;
+    std::vector<char const*>    pathsIn;
+
+    cliOption()
+    : ecSrc(      unicodeHelperEncoding_unknown)
+    , ecDst(      unicodeHelperEncoding_utf8)
+    , withBOM(    false)
+    , numThreads( 1UL)
+    , pathOut(    0)
+    , pathsIn()
+    {
+    }
+};
+
+/// @class  cliConverter
+/// @brief  一つの出力に、入力を窓ごとに変換して書き出す
+class   cliConverter
+{
+public:
+    int                         fdOut;
+    unicodeHelperEncoding       ecDst;
+    uint32_t                    numThreads;
+    size_t                      window;
+    //  窓を変換した出力(convertCliWindow()で必要な分だけ広げる)
+    std::vector<uint8_t>        out;
+    //  出力先エンコードでのU+FEFF
+    uint8_t                     bomDst[ 4];
+    size_t                      szBOMDst;
+    //  出力の先頭にBOMを付けるならtrue(付けたらfalse)
+    bool                        isBOMPending;
+
+    //  入力ごとの状態
+    char const*                 pathIn;
+    unicodeHelperEncoding       ecSrc;
+    unicodeHelperConverter const*   pConverter;
+    uint8_t                     bomSrc[ 4];
+    size_t                      szBOMSrc;
+    bool                        isTop;
+    uint64_t                    offset;
+
+    cliConverter( int const             in_fdOut,
+                  cliOption const&      in_option)
+    : fdOut(        in_fdOut)
+    , ecDst(        in_option.ecDst)
+    , numThreads(   in_option.numThreads)
+    , window(       0)
+    , out()
+    , szBOMDst(     encodeCliBOM( bomDst, sizeof(bomDst), in_option.ecDst))
+    , isBOMPending( in_option.withBOM)
+    , pathIn(       0)
+    , ecSrc(        unicodeHelperEncoding_unknown)
+    , pConverter(   0)
+    , szBOMSrc(     0)
+    , isTop(        true)
+    , offset(       0)
+    {
+        uint32_t const              numCores( ( numThreads!= 0UL)? numThreads: static_cast<uint32_t>( std::thread::hardware_concurrency()));
+        window                          = gCliWindowPerThread* static_cast<size_t>( ( numCores!= 0UL)? numCores: 1UL);
+    }
+
+    ~cliConverter()
+    {
+        unicodeHelperConverterDestroy( pConverter);
+    }
+};
+
+//  全部書き出す(書けなければfalse)
+static bool writeCliAll( int const              in_fd,
+                         uint8_t const*const    in_src,
+                         size_t const           in_size)
+{
+    size_t                      idx( 0);
+    while( idx< in_size)
+    {
+        ssize_t const               szWrite( write( in_fd, in_src+ idx, in_size- idx));
+        if( szWrite< 0)
+        {
+            if( errno== EINTR)  continue;
+            perror( "write");
+            return  false;
+        }
+        idx                             += static_cast<size_t>( szWrite);
+    }
+    return  true;
+}
+
+//  入力を一つ始める(判定は入力の先頭in_head[byte]で行う)
+static bool beginCliInput( cliConverter*const           io_cli,
+                           char const*const             in_pathIn,
+                           unicodeHelperEncoding const  in_ecSrc,
+                           uint8_t const*const          in_head,
+                           size_t const                 in_szHead)
+{
+    unicodeHelperEncoding       ecSrc( in_ecSrc);
+    if( ecSrc== unicodeHelperEncoding_unknown)
+    {
+        //  空の入力は何として読んでも空
+        ecSrc                           = unicodeHelperEncoding_utf8;
+        if( in_szHead!= 0)
+        {
+            unicodeHelperDetectCandidate    candidate;
+            if( unicodeHelperDetectEncoding( &candidate, 1, static_cast<signed int*>( 0),
+                                             in_head, std::min( in_szHead, gCliDetectLookahead))== 0)
+            {
+                fprintf( stderr, "%s: can't detect the encoding.\n", in_pathIn);
+                return  false;
+            }
+            ecSrc                           = candidate._encoding;
+        }
+    }
+
+    if( ecSrc!= io_cli->ecSrc|| io_cli->pConverter== static_cast<unicodeHelperConverter const*>( 0))
+    {
+        //  入力元のエンコードが前の入力と同じなら変換器を使い回す
+        unicodeHelperConverterDestroy( io_cli->pConverter);
+        io_cli->pConverter              = unicodeHelperConverterCreate( io_cli->ecDst, ecSrc, unicodeHelperConvertFlag_none);
+        io_cli->ecSrc                   = ecSrc;
+        io_cli->szBOMSrc                = encodeCliBOM( io_cli->bomSrc, sizeof(io_cli->bomSrc), ecSrc);
+        if( io_cli->pConverter== static_cast<unicodeHelperConverter const*>( 0))
+        {
+            fprintf( stderr, "%s: can't convert from %s to %s.\n", in_pathIn, cliEncodingName( ecSrc), cliEncodingName( io_cli->ecDst));
+            return  false;
+        }
+    }
+    io_cli->pathIn                  = in_pathIn;
+    io_cli->isTop                   = true;
+    io_cli->offset                  = 0;
+    return  true;
+}
+
+//  窓を一つ変換して書き出し、読み込んだサイズ([byte])を*out_consumedに返す(失敗すればfalse)
+//  in_isEndでなければ、最後で切れている文字は読まずに残す
+static bool convertCliWindow( cliConverter*const    io_cli,
+                              size_t*const          out_consumed,
+                              uint8_t const*const   in_src,
+                              size_t const          in_srcLen,
+                              bool const            in_isEnd)
+{
+    //  出力先は窓の大きさではなく、実際に来た入力に合わせて広げる(小さなファイルに窓分を確保しない)
+    size_t const                szNeed( in_srcLen* gCliExpandMax+ 16UL);
+    if( io_cli->out.size()< szNeed) io_cli->out.resize( szNeed);
+
+    uint8_t*const               pOut( io_cli->out.data());
+    size_t                      written( 0);
+    size_t                      consumed( 0);
+    if( io_cli->isBOMPending!= false)
+    {
+        memcpy( pOut, io_cli->bomDst, io_cli->szBOMDst);
+        written                         = io_cli->szBOMDst;
+        io_cli->isBOMPending            = false;
+    }
+
+    //  変換器は入力の先頭のU+FEFFをBOMとして読み飛ばすので、窓の先頭に来たU+FEFFはここで変換する
+    //  (出力先のエンコードにU+FEFFが無ければ変換できない文字として止める)
+    signed int                  result( -1);
+    while( io_cli->isTop== false
+           && io_cli->szBOMSrc!= 0
+           && io_cli->szBOMSrc<= static_cast<size_t>( in_srcLen- consumed)
+           && memcmp( in_src+ consumed, io_cli->bomSrc, io_cli->szBOMSrc)== 0)
+    {
+        if( io_cli->szBOMDst== 0)
+        {
+            result                          = 0;
+            break;
+        }
+        memcpy( pOut+ written, io_cli->bomDst, io_cli->szBOMDst);
+        written                         += io_cli->szBOMDst;
+        consumed                        += io_cli->szBOMSrc;
+    }
+
+    if( result!= 0)
+    {
+        size_t                      szRun( 0);
+        size_t                      szUsed( 0);
+        result                          = unicodeHelperConverterRunParallel( io_cli->pConverter, pOut+ written, io_cli->out.size()- written, &szRun,
+                                                                             in_src+ consumed, in_srcLen- consumed, &szUsed, io_cli->numThreads);
+        written                         += szRun;
+        consumed                        += szUsed;
+    }
+    io_cli->isTop                   = false;
+
+    if( writeCliAll( io_cli->fdOut, pOut, written)== false) return  false;
+    if( result== 0&& ( in_isEnd!= false|| static_cast<size_t>( in_srcLen- consumed)> gCliCarryMax))
+    {
+        fprintf( stderr, "%s: can't convert from %s to %s at %llu.\n",
+                 io_cli->pathIn, cliEncodingName( io_cli->ecSrc), cliEncodingName( io_cli->ecDst),
+                 static_cast<unsigned long long>( io_cli->offset+ consumed));
+        return  false;
+    }
+    io_cli->offset                  += consumed;
+    *out_consumed                   = consumed;
+    return  true;
+}
+
+//  mmap()したファイルを窓ごとに変換
+static bool convertCliMapped( cliConverter*const            io_cli,
+                              char const*const              in_pathIn,
+                              unicodeHelperEncoding const   in_ecSrc,
+                              int const                     in_fd,
+                              size_t const                  in_size)
+{
+    void*const                  pMap( mmap( 0, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0));
+    if( pMap== MAP_FAILED)
+    {
+        perror( in_pathIn);
+        return  false;
+    }
+    //  先頭から一度だけ読むので、先読みを増やし読み終えたページは早めに手放してもらう
+    madvise( pMap, in_size, MADV_SEQUENTIAL);
+
+    uint8_t const*const         pSrc( static_cast<uint8_t const*>( pMap));
+    bool                        result( beginCliInput( io_cli, in_pathIn, in_ecSrc, pSrc, in_size));
+    size_t                      idx( 0);
+    while( result!= false&& ( idx< in_size|| io_cli->isTop!= false))
+    {
+        size_t const                szWindow( std::min( io_cli->window, in_size- idx));
+        bool const                  isEnd( szWindow== static_cast<size_t>( in_size- idx));
+        if( isEnd== false)
+        {
+            size_t const                idxNext( idx+ szWindow);
+            madvise( const_cast<uint8_t*>( pSrc)+ ( idxNext& ~static_cast<size_t>( 4095)),
+                     std::min( io_cli->window, in_size- idxNext), MADV_WILLNEED);
+        }
+
+        size_t                      consumed( 0);
+        result                          = convertCliWindow( io_cli, &consumed, pSrc+ idx, szWindow, isEnd);
+        idx                             += consumed;
+    }
+
+    munmap( pMap, in_size);
+    return  result;
+}
+
+//  パイプなどを大きなブロックで読みながら変換
+static bool convertCliStream( cliConverter*const            io_cli,
+                              char const*const              in_pathIn,
+                              unicodeHelperEncoding const   in_ecSrc,
+                              int const                     in_fd)
+{
+    std::vector<uint8_t>        buffer( io_cli->window);
+    size_t                      szBuffered( 0);
+    bool                        isEOS( false);
+    bool                        isBegun( false);
+    while( true)
+    {
+        //  窓がいっぱいになるか入力が終わるまで読む
+        while( isEOS== false&& szBuffered< buffer.size())
+        {
+            ssize_t const               szRead( read( in_fd, buffer.data()+ szBuffered, buffer.size()- szBuffered));
+            if( szRead< 0)
+            {
+                if( errno== EINTR)  continue;
+                perror( in_pathIn);
+                return  false;
+            }
+            if( szRead== 0) isEOS= true;
+            szBuffered                      += static_cast<size_t>( szRead);
+        }
+
+        if( isBegun== false)
+        {
+            if( beginCliInput( io_cli, in_pathIn, in_ecSrc, buffer.data(), szBuffered)== false)    return  false;
+            isBegun                         = true;
+        }
+
+        size_t                      consumed( 0);
+        if( convertCliWindow( io_cli, &consumed, buffer.data(), szBuffered, isEOS)== false)    return  false;
+        if( isEOS!= false)  return  true;
+
+        //  切れた文字を先頭に移して続きを読む
+        memmove( buffer.data(), buffer.data()+ consumed, szBuffered- consumed);
+        szBuffered                      -= consumed;
+    }
+}
+
+//  一つの入力を変換(in_pathInが-なら標準入力)
+static bool convertCliInput( cliConverter*const             io_cli,
+                             char const*const               in_pathIn,
+                             unicodeHelperEncoding const    in_ecSrc)
+{
+    bool const                  isStdin( strcmp( in_pathIn, "-")== 0);
+    int const                   fd( isStdin? STDIN_FILENO: open( in_pathIn, O_RDONLY));
+    if( fd< 0)
+    {
+        perror( in_pathIn);
+        return  false;
+    }
+
+    struct stat                 st;
+    bool                        result;
+    if( fstat( fd, &st)== 0&& S_ISREG( st.st_mode)&& st.st_size> 0)
+    {
+        result                          = convertCliMapped( io_cli, in_pathIn, in_ecSrc, fd, static_cast<size_t>( st.st_size));
+    } else {
+        result                          = convertCliStream( io_cli, in_pathIn, in_ecSrc, fd);
+    }
+
+    if( isStdin== false)    close( fd);
+    return  result;
+}
+
+//  -で始まる指定を読む(読めない指定があればfalse)
+static bool parseCliOptions( cliOption*const    out_option,
+                             int const          in_argC,
+                             char**             in_argV)
+{
+    int                         idxArg( 1);
+    while( idxArg< in_argC)
+    {
+        char const*const            arg( *static_cast<char**>( in_argV+ idxArg));
+        if( arg[ 0]!= '-'|| arg[ 1]== '\0')
+        {
+            out_option->pathsIn.push_back( arg);
+            idxArg++;
+            continue;
+        }
+        if( strcmp( arg, "-b")== 0|| strcmp( arg, "-B")== 0)
+        {
+            out_option->withBOM             = ( arg[ 1]== 'b');
+            idxArg++;
+            continue;
+        }
+
+        if( static_cast<int>( idxArg+ 1)>= in_argC)    return  false;
+        char const*const            value( *static_cast<char**>( in_argV+ idxArg+ 1));
+        if( strcmp( arg, "-f")== 0)
+        {
+            out_option->ecSrc               = findCliEncoding( value);
+            if( out_option->ecSrc== unicodeHelperEncoding_unknown&& strcmp( value, "auto")!= 0)
+            {
+                fprintf( stderr, "unknown encoding %s\n", value);
+                return  false;
+            }
+        } else if( strcmp( arg, "-t")== 0)
+        {
+            out_option->ecDst               = findCliEncoding( value);
+            if( out_option->ecDst== unicodeHelperEncoding_unknown)
+            {
+                fprintf( stderr, "unknown encoding %s\n", value);
+                return  false;
+            }
+        } else if( strcmp( arg, "-j")== 0)
+        {
+            char*                       pEnd;
+            out_option->numThreads          = static_cast<uint32_t>( strtoul( value, &pEnd, 10));
+            if( pEnd== value|| *pEnd!= '\0')    return  false;
+        } else if( strcmp( arg, "-o")== 0)
+        {
+            out_option->pathOut             = value;
+        } else {
+            fprintf( stderr, "bad option %s\n", arg);
+            return  false;
+        }
+        idxArg                          += 2;
+    }
+
+    if( out_option->pathsIn.empty()!= false)    out_option->pathsIn.push_back( "-");
+    return  true;
+}
+
+
+int main( int in_argC, char** in_argV)
+{
+    cliOption                   option;
+    if( parseCliOptions( &option, in_argC, in_argV)== false)
+    {
+        fprintf( stderr, "%s (-f utf8|utf16|utf16le|utf16be|cp932|shiftjis|eucjp|gbk|big5|cp949|auto) (-t ENCODING) (-b|-B) (-j THREADS) (-o OUTPUT) [INPUT|-]...\n", *in_argV);
+        return  2;
+    }
+
+    cliConverter                cli( -1, option);
+    if( option.withBOM!= false&& cli.szBOMDst== 0)
+    {
+        fprintf( stderr, "%s has no BOM.\n", cliEncodingName( option.ecDst));
+        return  2;
+    }
+
+    int const                   fdOut( ( option.pathOut!= static_cast<char const*>( 0))? open( option.pathOut, O_WRONLY| O_CREAT| O_TRUNC, 0666)
+                                                                                       : STDOUT_FILENO);
+    if( fdOut< 0)
+    {
+        perror( option.pathOut);
+        return  1;
+    }
+
+    cli.fdOut                       = fdOut;
+    bool                        result( true);
+    for( std::vector<char const*>::const_iterator it= option.pathsIn.cbegin(); result!= false&& it!= option.pathsIn.cend(); it++)
+    {
+        result                          = convertCliInput( &cli, *it, option.ecSrc);
+    }
+
+    if( option.pathOut!= static_cast<char const*>( 0)&& close( fdOut)!= 0)
+    {
+        perror( option.pathOut);
+        result                          = false;
+    }
+    return  ( result!= false)? 0: 1;
+}
+
+//  End of Source [unicodehelper.cpp]